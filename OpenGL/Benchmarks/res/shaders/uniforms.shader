@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// Plain default block uniforms, for the uniform lookup benchmarks.
+uniform mat4  model;
+uniform mat4  view;
+uniform mat4  projection;
+uniform vec3  offsets[8];
+uniform float time;
+
+out vec3 position;
+
+void main()
+{
+    vec3 moved = aPos + offsets[gl_VertexID % 8] * time;
+    position = (model * vec4(moved, 1.0)).xyz;
+    gl_Position = projection * view * vec4(position, 1.0);
+}
+
+#shader fragment
+#version 330 core
+in vec3 position;
+out vec4 FragColor;
+
+uniform vec4  tint;
+uniform vec3  lightDirection;
+uniform float exposure;
+uniform int   mode;
+
+void main()
+{
+    float light = max(dot(normalize(position), lightDirection), 0.0);
+    vec3 color = tint.rgb * light * exposure;
+    FragColor = vec4(mode == 1 ? color.bgr : color, tint.a);
+}
@@ -0,0 +1,215 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Renderer/BlockCompression.hpp"
+#include "Renderer/TextureCache.hpp"
+#include "Renderer/ThreadPool.hpp"
+
+// Settings.
+// ---------
+const GLsizei IMAGE_SIZE = 2048;
+const char*   CACHE_DIR  = "BlockCompressionBenchmarkCache";
+
+// Smooth gradients, a few hard edged shapes and some noise; alpha is a soft radial falloff.
+// --------------------------------------------------------------------------------------
+Image makeImage(GLsizei size)
+{
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> noise(-6, 6);
+
+    Image image(size, size);
+    for(GLsizei y = 0; y < size; ++y)
+    {
+        for(GLsizei x = 0; x < size; ++x)
+        {
+            float u = (float)x / size, v = (float)y / size;
+            bool stripe = ((x / 64) + (y / 96)) % 5 == 0;
+            glm::vec3 color(u * 255.0f, v * 255.0f, (0.5f + 0.5f * std::sin(u * 20.0f) * std::cos(v * 13.0f)) * 255.0f);
+            if(stripe)
+                color = glm::vec3(255.0f) - color;
+            float alpha = glm::clamp(1.5f - 2.0f * glm::length(glm::vec2(u, v) - 0.5f), 0.0f, 1.0f) * 255.0f;
+
+            unsigned char* p = &image.pixels[((std::size_t)y * size + x) * 4];
+            for(int c = 0; c < 3; ++c)
+                p[c] = (unsigned char)glm::clamp((int)color[c] + noise(random), 0, 255);
+            p[3] = (unsigned char)alpha;
+        }
+    }
+    return image;
+}
+
+// Reference decoders, only used to measure the error.
+// --------------------------------------------------
+glm::vec3 unpack565(unsigned int color)
+{
+    unsigned int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    return glm::vec3((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+}
+
+void decodeColor(const unsigned char* block, bool forceFourColors, float* texels)
+{
+    unsigned int c0 = block[0] | (block[1] << 8);
+    unsigned int c1 = block[2] | (block[3] << 8);
+
+    glm::vec4 palette[4];
+    palette[0] = glm::vec4(unpack565(c0), 255.0f);
+    palette[1] = glm::vec4(unpack565(c1), 255.0f);
+    if(c0 > c1 || forceFourColors)
+    {
+        palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+    }
+    else
+    {
+        palette[2] = (palette[0] + palette[1]) * 0.5f;
+        palette[3] = glm::vec4(0.0f);
+    }
+
+    for(int i = 0; i < 16; ++i)
+    {
+        glm::vec4 texel = palette[(block[4 + i / 4] >> ((i % 4) * 2)) & 3];
+        for(int c = 0; c < 4; ++c)
+            texels[i * 4 + c] = texel[c];
+    }
+}
+
+void decodeAlpha(const unsigned char* block, float* texels)
+{
+    float a0 = block[0], a1 = block[1];
+    float palette[8] = { a0, a1 };
+    if(a0 > a1)
+        for(int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * a0 + i * a1) / 7.0f;
+    else
+    {
+        for(int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * a0 + i * a1) / 5.0f;
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+
+    unsigned long long bits = 0;
+    for(int i = 0; i < 6; ++i)
+        bits |= (unsigned long long)block[2 + i] << (i * 8);
+    for(int i = 0; i < 16; ++i)
+        texels[i * 4 + 3] = palette[(bits >> (i * 3)) & 7];
+}
+
+// PSNR of the color channels and, for BC3, of alpha.
+void measure(const Image &image, const CompressedImage &compressed, BlockFormat format, double &colorPsnr, double &alphaPsnr)
+{
+    const GLsizei blocksWide = (image.width + 3) / 4;
+    double colorError = 0.0, alphaError = 0.0;
+
+    float texels[16 * 4];
+    for(GLsizei by = 0; by < (image.height + 3) / 4; ++by)
+    {
+        for(GLsizei bx = 0; bx < blocksWide; ++bx)
+        {
+            const unsigned char* block = &compressed.data[((std::size_t)by * blocksWide + bx) * blockSize(format)];
+            if(format == BlockFormat::BC1)
+                decodeColor(block, false, texels);
+            else
+            {
+                decodeColor(block + 8, true, texels);
+                decodeAlpha(block, texels);
+            }
+
+            for(int i = 0; i < 16; ++i)
+            {
+                GLsizei x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if(x >= image.width || y >= image.height)
+                    continue;
+                const unsigned char* p = &image.pixels[((std::size_t)y * image.width + x) * 4];
+                for(int c = 0; c < 3; ++c)
+                    colorError += (p[c] - texels[i * 4 + c]) * (p[c] - texels[i * 4 + c]);
+                alphaError += (p[3] - texels[i * 4 + 3]) * (p[3] - texels[i * 4 + 3]);
+            }
+        }
+    }
+
+    const double pixels = (double)image.width * image.height;
+    colorPsnr = 10.0 * std::log10(255.0 * 255.0 / std::max(colorError / (pixels * 3.0), 1e-10));
+    alphaPsnr = 10.0 * std::log10(255.0 * 255.0 / std::max(alphaError / pixels, 1e-10));
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+int main()
+{
+    Image image = makeImage(IMAGE_SIZE);
+    Image opaque = image;
+    for(std::size_t i = 3; i < opaque.pixels.size(); i += 4)
+        opaque.pixels[i] = 255;
+
+    ThreadPool pool;
+    std::cout << IMAGE_SIZE << "x" << IMAGE_SIZE << " RGBA8, " << pool.size() << " worker threads" << std::endl;
+
+    const BlockFormat formats[] = { BlockFormat::BC1, BlockFormat::BC3 };
+    for(BlockFormat format : formats)
+    {
+        const Image &source = format == BlockFormat::BC1 ? opaque : image;
+        if(chooseBlockFormat(source) != format)
+        {
+            std::cout << "ERROR::BLOCK_COMPRESSION_BENCHMARK::WRONG_FORMAT_CHOSEN" << std::endl;
+            return -1;
+        }
+
+        CompressedImage single, threaded;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        compressImage(source, format, single);
+        double singleTime = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        compressImage(source, format, threaded, &pool);
+        double threadedTime = millisecondsSince(start);
+
+        if(single.data != threaded.data)
+        {
+            std::cout << "ERROR::BLOCK_COMPRESSION_BENCHMARK::THREADED_MISMATCH" << std::endl;
+            return -1;
+        }
+
+        double colorPsnr, alphaPsnr;
+        measure(source, single, format, colorPsnr, alphaPsnr);
+
+        const double megapixels = (double)IMAGE_SIZE * IMAGE_SIZE / 1e6;
+        std::cout << "  " << (format == BlockFormat::BC1 ? "BC1" : "BC3") << ": "
+                  << source.size() / single.data.size() << ":1, color PSNR " << colorPsnr << " dB";
+        if(format == BlockFormat::BC3)
+            std::cout << ", alpha PSNR " << alphaPsnr << " dB";
+        std::cout << "\n       1 thread " << singleTime << " ms (" << megapixels / singleTime * 1000.0 << " Mpixel/s), "
+                  << pool.size() << " threads " << threadedTime << " ms (" << megapixels / threadedTime * 1000.0 << " Mpixel/s)" << std::endl;
+
+        // A cache round trip, which is what a second run pays instead of encoding.
+        TextureCache cache(CACHE_DIR);
+        std::vector<CompressedImage> levels(1, single), loaded;
+        std::uint64_t key = hashBytes(source.pixels.data(), source.size());
+
+        start = std::chrono::steady_clock::now();
+        bool written = cache.write(key, format, levels);
+        double writeTime = millisecondsSince(start);
+
+        BlockFormat loadedFormat;
+        start = std::chrono::steady_clock::now();
+        bool read = cache.read(key, loadedFormat, loaded);
+        double readTime = millisecondsSince(start);
+
+        if(!written || !read || loadedFormat != format || loaded.size() != 1 || loaded[0].data != single.data)
+        {
+            std::cout << "ERROR::BLOCK_COMPRESSION_BENCHMARK::CACHE_ROUND_TRIP" << std::endl;
+            return -1;
+        }
+        std::cout << "       cache write " << writeTime << " ms, read " << readTime << " ms" << std::endl;
+        std::remove(cache.path(key).c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "Renderer/ImageProcessing.hpp"
+#include "Renderer/Mipmaps.hpp"
+
+// Settings.
+// ---------
+const GLsizei IMAGE_SIZE = 2048;
+const int     REPEATS    = 5;
+
+// Noise over smooth gradients: the noise exercises clamping of the Kaiser ringing, the gradients
+// the sRGB curve.
+// ---------------------------------------------------------------------------------------------
+Image makeImage(GLsizei width, GLsizei height)
+{
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> noise(-24, 24);
+
+    Image image(width, height);
+    for(GLsizei y = 0; y < height; ++y)
+    {
+        for(GLsizei x = 0; x < width; ++x)
+        {
+            unsigned char* p = &image.pixels[((std::size_t)y * width + x) * 4];
+            int base[4] = { x * 255 / width, y * 255 / height, (x + y) * 127 / (width + height), 255 - x * 255 / width };
+            for(int c = 0; c < 4; ++c)
+                p[c] = (unsigned char)glm::clamp(base[c] + noise(random), 0, 255);
+        }
+    }
+    return image;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+struct Results
+{
+    std::vector<Image>         box;
+    std::vector<Image>         kaiser;
+    std::vector<std::uint16_t> rgb565;
+    std::vector<std::uint16_t> rgba4;
+};
+
+// Best of REPEATS runs of every operation at the current SIMD level.
+Results run(const Image &image, bool print)
+{
+    Results results;
+    double best[4] = { 1e30, 1e30, 1e30, 1e30 };
+
+    for(int repeat = 0; repeat < REPEATS; ++repeat)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        results.box.assign(1, image);
+        buildMipChain(results.box, MipOptions(MipFilter::Box, true));
+        best[0] = std::min(best[0], millisecondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        results.kaiser.assign(1, image);
+        buildMipChain(results.kaiser, MipOptions(MipFilter::Kaiser, true));
+        best[1] = std::min(best[1], millisecondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        packRGB565(image, results.rgb565);
+        best[2] = std::min(best[2], millisecondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        packRGBA4(image, results.rgba4);
+        best[3] = std::min(best[3], millisecondsSince(start));
+    }
+
+    if(print)
+    {
+        std::cout << "  " << simdLevelName(simdLevel()) << ":\tbox chain " << best[0] << " ms, kaiser chain " << best[1]
+                  << " ms, rgb565 " << best[2] << " ms, rgba4 " << best[3] << " ms" << std::endl;
+    }
+    return results;
+}
+
+bool sameChain(const std::vector<Image> &a, const std::vector<Image> &b)
+{
+    if(a.size() != b.size())
+        return false;
+    for(std::size_t i = 0; i < a.size(); ++i)
+    {
+        if(a[i].width != b[i].width || a[i].height != b[i].height || a[i].pixels != b[i].pixels)
+            return false;
+    }
+    return true;
+}
+
+// Every SIMD level against the scalar path, bit for bit.
+bool validate(const Image &image, bool print)
+{
+    setSimdLevel(SimdLevel::Scalar);
+    Results reference = run(image, print);
+
+    const SimdLevel levels[] = { SimdLevel::SSE2, SimdLevel::AVX2 };
+    for(SimdLevel level : levels)
+    {
+        if(level > supportedSimdLevel())
+            continue;
+
+        setSimdLevel(level);
+        Results results = run(image, print);
+
+        if(!sameChain(results.box, reference.box) || !sameChain(results.kaiser, reference.kaiser) ||
+           results.rgb565 != reference.rgb565 || results.rgba4 != reference.rgba4)
+        {
+            std::cout << "ERROR::IMAGE_PROCESSING_BENCHMARK::" << simdLevelName(level) << "_MISMATCH " << image.width << "x" << image.height << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The packing kernels against glm for every value of every channel.
+bool validatePacking()
+{
+    Image ramp(256, 4);
+    for(int c = 0; c < 4; ++c)
+        for(int v = 0; v < 256; ++v)
+            ramp.pixels[((std::size_t)c * 256 + v) * 4 + c] = (unsigned char)v;
+
+    for(int level = (int)SimdLevel::Scalar; level <= (int)supportedSimdLevel(); ++level)
+    {
+        setSimdLevel((SimdLevel)level);
+
+        std::vector<std::uint16_t> rgb565, rgba4;
+        packRGB565(ramp, rgb565);
+        packRGBA4(ramp, rgba4);
+
+        for(std::size_t i = 0; i < rgb565.size(); ++i)
+        {
+            const unsigned char* p = &ramp.pixels[i * 4];
+            if(rgb565[i] != glm::packUnorm1x5_1x6_1x5(glm::vec3(p[2], p[1], p[0]) / 255.0f) ||
+               rgba4[i]  != glm::packUnorm4x4(glm::vec4(p[3], p[2], p[1], p[0]) / 255.0f))
+            {
+                std::cout << "ERROR::IMAGE_PROCESSING_BENCHMARK::PACKING_MISMATCH " << simdLevelName((SimdLevel)level) << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    std::cout << "supported: " << simdLevelName(supportedSimdLevel()) << std::endl;
+
+    if(!validatePacking())
+        return -1;
+
+    // Odd sizes first to cover the scalar tails and clamped edges; only the full size is timed.
+    const GLsizei sizes[][2] = { { 1, 1 }, { 7, 3 }, { 33, 17 }, { 257, 129 } };
+    for(const GLsizei* size : sizes)
+    {
+        if(!validate(makeImage(size[0], size[1]), false))
+            return -1;
+    }
+
+    std::cout << IMAGE_SIZE << "x" << IMAGE_SIZE << " RGBA8, best of " << REPEATS << ":" << std::endl;
+    if(!validate(makeImage(IMAGE_SIZE, IMAGE_SIZE), true))
+        return -1;
+
+    std::cout << "all levels bit exact" << std::endl;
+    return 0;
+}
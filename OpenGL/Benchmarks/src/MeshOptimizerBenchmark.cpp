@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Renderer/Mesh.hpp"
+#include "Renderer/MeshOptimizer.hpp"
+
+// Settings.
+// ---------
+const GLuint GRID_SIZE = 708;  // 708 x 708 quads, just over a million triangles.
+
+// A height field grid written out as a triangle soup in random triangle order: every triangle has
+// its own three vertices, like an exporter that doesn't index, and no two neighbours are adjacent.
+// ------------------------------------------------------------------------------------------------
+Mesh makeSoup(const VertexLayout &layout)
+{
+    std::mt19937 random(1234);
+
+    std::vector<glm::vec3> corners;
+    corners.reserve((std::size_t)GRID_SIZE * GRID_SIZE * 6);
+    for(GLuint y = 0; y < GRID_SIZE; ++y)
+    {
+        for(GLuint x = 0; x < GRID_SIZE; ++x)
+        {
+            glm::vec3 p00((float)x,       std::sin(x * 0.1f) * std::cos(y * 0.1f), (float)y);
+            glm::vec3 p10((float)x + 1.0f, std::sin((x + 1) * 0.1f) * std::cos(y * 0.1f), (float)y);
+            glm::vec3 p01((float)x,       std::sin(x * 0.1f) * std::cos((y + 1) * 0.1f), (float)y + 1.0f);
+            glm::vec3 p11((float)x + 1.0f, std::sin((x + 1) * 0.1f) * std::cos((y + 1) * 0.1f), (float)y + 1.0f);
+
+            corners.push_back(p00); corners.push_back(p01); corners.push_back(p10);
+            corners.push_back(p10); corners.push_back(p01); corners.push_back(p11);
+        }
+    }
+
+    std::vector<GLuint> triangles(corners.size() / 3);
+    for(std::size_t i = 0; i < triangles.size(); ++i)
+        triangles[i] = (GLuint)i;
+    std::shuffle(triangles.begin(), triangles.end(), random);
+
+    Mesh mesh(layout, (GLuint)corners.size());
+    std::vector<GLuint> indices(corners.size());
+    for(std::size_t i = 0; i < triangles.size(); ++i)
+    {
+        for(GLuint corner = 0; corner < 3; ++corner)
+        {
+            GLuint vertex = (GLuint)(i * 3 + corner);
+            mesh.set(0, vertex, corners[triangles[i] * 3 + corner]);
+            indices[vertex] = vertex;
+        }
+    }
+    mesh.setIndices(indices.data(), (GLuint)indices.size());
+    return mesh;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    return time.count();
+}
+
+void printStats(const char* name, const Mesh &mesh)
+{
+    VertexCacheStats stats = analyzeVertexCache(mesh.indices().data(), mesh.indices().size(), mesh.vertexCount());
+    std::cout << "  " << name << ": " << mesh.vertexCount() << " vertices, ACMR " << stats.acmr << ", ATVR " << stats.atvr << std::endl;
+}
+
+int main()
+{
+    VertexLayout layout;
+    layout.add(0, VertexFormat::Float3);
+
+    Mesh mesh = makeSoup(layout);
+    const std::size_t indexCount = mesh.indices().size();
+    std::cout << indexCount / 3 << " triangles, " << DEFAULT_VERTEX_CACHE_SIZE << " entry FIFO cache" << std::endl;
+    printStats("input soup       ", mesh);
+
+    // Each pass timed on its own, in the order optimizeMesh() runs them.
+    // ------------------------------------------------------------------
+    std::vector<GLuint> remap;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GLuint unique = weldVerticesRemap(remap, mesh.vertices(), mesh.vertexCount(), layout.stride());
+    mesh.remapVertices(remap, unique);
+    double weld = millisecondsSince(start);
+    printStats("welded           ", mesh);
+
+    std::vector<GLuint> cacheOrder(indexCount);
+    std::vector<GLuint> clusters;
+    start = std::chrono::steady_clock::now();
+    optimizeVertexCache(cacheOrder.data(), mesh.indices().data(), indexCount, mesh.vertexCount(), DEFAULT_VERTEX_CACHE_SIZE, &clusters);
+    double cache = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    optimizeOverdraw(mesh.indices().data(), cacheOrder.data(), indexCount, (const float*)mesh.vertices(), layout.stride(), mesh.vertexCount(), clusters);
+    double overdraw = millisecondsSince(start);
+    printStats("cache + overdraw ", mesh);
+
+    start = std::chrono::steady_clock::now();
+    GLuint used = optimizeVertexFetchRemap(remap, mesh.indices().data(), indexCount, mesh.vertexCount());
+    mesh.remapVertices(remap, used);
+    double fetch = millisecondsSince(start);
+    printStats("fetch ordered    ", mesh);
+
+    std::cout << "  weld:     " << weld << " ms" << std::endl;
+    std::cout << "  cache:    " << cache << " ms (" << clusters.size() << " clusters)" << std::endl;
+    std::cout << "  overdraw: " << overdraw << " ms" << std::endl;
+    std::cout << "  fetch:    " << fetch << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,518 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <thread>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+namespace
+{
+    const std::uint64_t MAX_ITERATIONS = 1000000000;
+
+    // CPU time of the calling thread only: GL drivers and thread pools burn theirs elsewhere.
+    double threadCpuSeconds()
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+        ULARGE_INTEGER k, u;
+        k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+        u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+        return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+    }
+
+    double unitScale(BenchmarkUnit unit)
+    {
+        switch(unit)
+        {
+        case BenchmarkUnit::Nanoseconds:  return 1e9;
+        case BenchmarkUnit::Microseconds: return 1e6;
+        case BenchmarkUnit::Milliseconds: return 1e3;
+        }
+        return 1e9;
+    }
+
+    const char* unitName(BenchmarkUnit unit)
+    {
+        switch(unit)
+        {
+        case BenchmarkUnit::Nanoseconds:  return "ns";
+        case BenchmarkUnit::Microseconds: return "us";
+        case BenchmarkUnit::Milliseconds: return "ms";
+        }
+        return "ns";
+    }
+
+    void writeEscaped(std::ofstream &out, const std::string &text)
+    {
+        for(std::size_t i = 0; i < text.size(); ++i)
+        {
+            if(text[i] == '"' || text[i] == '\\')
+                out << '\\';
+            if((unsigned char)text[i] >= 0x20)
+                out << text[i];
+        }
+    }
+
+    // 1234567 -> "1.23457M", the way the table shows rates.
+    std::string humanReadable(double value)
+    {
+        const char* suffixes[] = { "", "k", "M", "G", "T" };
+        int suffix = 0;
+        while(value >= 1000.0 && suffix < 4)
+        {
+            value /= 1000.0;
+            ++suffix;
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.4g%s", value, suffixes[suffix]);
+        return text;
+    }
+
+    BenchmarkResult emptyResult(const std::string &name, BenchmarkUnit unit)
+    {
+        BenchmarkResult result;
+        result.name           = name;
+        result.runName        = name;
+        result.repetition     = 0;
+        result.iterations     = 0;
+        result.realTime       = 0.0;
+        result.cpuTime        = 0.0;
+        result.unit           = unit;
+        result.itemsPerSecond = 0.0;
+        result.bytesPerSecond = 0.0;
+        return result;
+    }
+
+    BenchmarkResult aggregate(const std::vector<BenchmarkResult> &runs, const char* name)
+    {
+        BenchmarkResult result = runs.front();
+        result.aggregate  = name;
+        result.name       = result.runName + "_" + name;
+        result.repetition = 0;
+        result.label.clear();
+
+        std::vector<double> real, cpu, items, bytes;
+        for(std::size_t i = 0; i < runs.size(); ++i)
+        {
+            real.push_back(runs[i].realTime);
+            cpu.push_back(runs[i].cpuTime);
+            items.push_back(runs[i].itemsPerSecond);
+            bytes.push_back(runs[i].bytesPerSecond);
+        }
+
+        double (*reduce)(std::vector<double>&) = nullptr;
+        if(std::strcmp(name, "mean") == 0)
+            reduce = [](std::vector<double> &values) { double sum = 0.0; for(double v : values) sum += v; return sum / values.size(); };
+        else if(std::strcmp(name, "median") == 0)
+            reduce = [](std::vector<double> &values)
+            {
+                std::sort(values.begin(), values.end());
+                std::size_t middle = values.size() / 2;
+                return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) * 0.5;
+            };
+        else
+            reduce = [](std::vector<double> &values)
+            {
+                double mean = 0.0, variance = 0.0;
+                for(double v : values) mean += v;
+                mean /= values.size();
+                for(double v : values) variance += (v - mean) * (v - mean);
+                return values.size() > 1 ? std::sqrt(variance / (values.size() - 1)) : 0.0;
+            };
+
+        result.realTime       = reduce(real);
+        result.cpuTime        = reduce(cpu);
+        result.itemsPerSecond = reduce(items);
+        result.bytesPerSecond = reduce(bytes);
+        return result;
+    }
+
+    void printResult(const BenchmarkResult &result)
+    {
+        std::cout << std::left << std::setw(48) << result.name << std::right;
+        if(!result.error.empty())
+        {
+            std::cout << " SKIPPED: " << result.error << std::endl;
+            return;
+        }
+
+        std::cout << std::fixed << std::setprecision(result.realTime < 10.0 ? 3 : 1)
+                  << std::setw(12) << result.realTime << " " << unitName(result.unit)
+                  << std::setw(12) << result.cpuTime  << " " << unitName(result.unit)
+                  << std::setw(12) << result.iterations;
+        std::cout.unsetf(std::ios::fixed);
+        if(result.itemsPerSecond > 0.0)
+            std::cout << "  items/s=" << humanReadable(result.itemsPerSecond);
+        if(result.bytesPerSecond > 0.0)
+            std::cout << "  bytes/s=" << humanReadable(result.bytesPerSecond);
+        if(!result.label.empty())
+            std::cout << "  " << result.label;
+        std::cout << std::endl;
+    }
+
+    void printUsage(const char* program)
+    {
+        std::cout << "Usage: " << program << " [--filter REGEX] [--min-time SECONDS] [--repetitions N]\n"
+                  << "       [--out FILE.json] [--no-gl] [--list] [--help]\n"
+                  << "Values may also follow an '=', as in --filter=DrawSubmission." << std::endl;
+    }
+}
+
+// ------------------------------------------------------------------------
+BenchmarkState::BenchmarkState(std::uint64_t iterations, std::int64_t argument)
+    : total(iterations), remaining(iterations), value(argument), running(false), finished(false),
+      cpuStart(0.0), realSeconds(0.0), cpuSeconds(0.0), itemCount(0), byteCount(0)
+{
+
+}
+
+bool BenchmarkState::startOrFinish()
+{
+    if(!running && !finished && error.empty())
+    {
+        running = true;
+        start    = Clock::now();
+        cpuStart = threadCpuSeconds();
+        --remaining;
+        return true;
+    }
+
+    if(running)
+        pauseTiming();
+    finished = true;
+    return false;
+}
+
+void BenchmarkState::pauseTiming()
+{
+    if(!running)
+        return;
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    realSeconds += elapsed.count();
+    cpuSeconds  += threadCpuSeconds() - cpuStart;
+    running = false;
+}
+
+void BenchmarkState::resumeTiming()
+{
+    if(running || finished)
+        return;
+    running  = true;
+    start    = Clock::now();
+    cpuStart = threadCpuSeconds();
+}
+
+// ------------------------------------------------------------------------
+Benchmark::Benchmark(const std::string &name, BenchmarkFunction function)
+    : benchmarkName(name), function(function), reportUnit(BenchmarkUnit::Nanoseconds), gl(false)
+{
+
+}
+
+std::vector<Benchmark*>& registeredBenchmarks()
+{
+    // Built on first use: registration runs from static initializers in any order.
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+Benchmark* registerBenchmark(const std::string &name, BenchmarkFunction function)
+{
+    Benchmark* benchmark = new Benchmark(name, function);
+    registeredBenchmarks().push_back(benchmark);
+    return benchmark;
+}
+
+// ------------------------------------------------------------------------
+bool parseBenchmarkSettings(int argc, char** argv, BenchmarkSettings &settings)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        // Values come as the next argument or after '=' ("--filter=Draw"), as Google Benchmark takes them.
+        std::string argument = argv[i];
+        std::string inlineValue;
+        const bool  inlined = argument.find('=') != std::string::npos;
+        if(inlined)
+        {
+            inlineValue = argument.substr(argument.find('=') + 1);
+            argument.resize(argument.find('='));
+        }
+        const char* value = inlined ? inlineValue.c_str() : i + 1 < argc ? argv[i + 1] : nullptr;
+        bool valid = true;
+
+        if(argument == "--help" || argument == "-h")
+        {
+            printUsage(argv[0]);
+            settings.help = true;
+            return true;
+        }
+        if(argument == "--no-gl" && !inlined)
+        {
+            settings.gl = false;
+            continue;
+        }
+        if(argument == "--list" && !inlined)
+        {
+            settings.list = true;
+            continue;
+        }
+
+        char* end = nullptr;
+        if(!value)
+            valid = false;
+        else if(argument == "--filter")
+            settings.filter = value;
+        else if(argument == "--min-time")
+        {
+            settings.minTime = std::strtod(value, &end);
+            valid = end != value && *end == '\0' && settings.minTime > 0.0;
+        }
+        else if(argument == "--repetitions")
+        {
+            long repetitions = std::strtol(value, &end, 10);
+            valid = end != value && *end == '\0' && repetitions > 0;
+            settings.repetitions = (unsigned int)repetitions;
+        }
+        else if(argument == "--out")
+            settings.outPath = value;
+        else
+            valid = false;
+
+        if(!valid)
+        {
+            std::cout << "ERROR::BENCHMARK::INVALID_ARGUMENT " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        if(!inlined)
+            ++i;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+std::vector<std::pair<Benchmark*, std::int64_t>> BenchmarkRunner::selected() const
+{
+    std::unique_ptr<std::regex> filter;
+    if(!settings.filter.empty())
+        filter.reset(new std::regex(settings.filter));
+
+    std::vector<std::pair<Benchmark*, std::int64_t>> runs;
+    const std::vector<Benchmark*> &benchmarks = registeredBenchmarks();
+    for(std::size_t i = 0; i < benchmarks.size(); ++i)
+    {
+        std::vector<std::int64_t> arguments = benchmarks[i]->arguments;
+        bool named = !arguments.empty();
+        if(!named)
+            arguments.push_back(0);
+
+        for(std::size_t a = 0; a < arguments.size(); ++a)
+        {
+            std::string name = benchmarks[i]->name() + (named ? "/" + std::to_string(arguments[a]) : std::string());
+            if(!filter || std::regex_search(name, *filter))
+                runs.push_back(std::make_pair(benchmarks[i], named ? arguments[a] : (std::int64_t)0));
+        }
+    }
+    return runs;
+}
+
+bool BenchmarkRunner::needsGL() const
+{
+    std::vector<std::pair<Benchmark*, std::int64_t>> runs = selected();
+    for(std::size_t i = 0; i < runs.size(); ++i)
+    {
+        if(runs[i].first->gl)
+            return true;
+    }
+    return false;
+}
+
+BenchmarkResult BenchmarkRunner::runOnce(const Benchmark &benchmark, std::int64_t argument, const std::string &name) const
+{
+    BenchmarkResult result = emptyResult(name, benchmark.reportUnit);
+
+    // Grow the iteration count until one run lasts minTime, the way Google Benchmark does:
+    // aim 40% past it from the last measurement, but never more than 10x at once.
+    std::uint64_t iterations = 1;
+    for(;;)
+    {
+        BenchmarkState state(iterations, argument);
+        benchmark.function(state);
+
+        if(!state.error.empty())
+        {
+            result.error = state.error;
+            return result;
+        }
+
+        if(state.realSeconds >= settings.minTime || iterations >= MAX_ITERATIONS)
+        {
+            result.iterations     = iterations;
+            result.realTime       = state.realSeconds / iterations * unitScale(result.unit);
+            result.cpuTime        = state.cpuSeconds / iterations * unitScale(result.unit);
+            result.itemsPerSecond = state.itemCount && state.realSeconds > 0.0 ? state.itemCount / state.realSeconds : 0.0;
+            result.bytesPerSecond = state.byteCount && state.realSeconds > 0.0 ? state.byteCount / state.realSeconds : 0.0;
+            result.label          = state.label;
+            return result;
+        }
+
+        double multiplier = state.realSeconds / settings.minTime > 0.1
+            ? settings.minTime * 1.4 / std::max(state.realSeconds, 1e-9)
+            : 10.0;
+        std::uint64_t next = (std::uint64_t)(iterations * std::min(multiplier, 10.0));
+        iterations = std::min(std::max(next, iterations + 1), MAX_ITERATIONS);
+    }
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(bool glAvailable)
+{
+    std::vector<std::pair<Benchmark*, std::int64_t>> runs = selected();
+
+    if(settings.list)
+    {
+        for(std::size_t i = 0; i < runs.size(); ++i)
+            std::cout << runs[i].first->name() << (runs[i].first->arguments.empty() ? std::string() : "/" + std::to_string(runs[i].second))
+                      << (runs[i].first->gl ? "  (GL)" : "") << std::endl;
+        return std::vector<BenchmarkResult>();
+    }
+
+    std::cout << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(15) << "Time"
+              << std::setw(15) << "CPU" << std::setw(12) << "Iterations" << "\n"
+              << std::string(90, '-') << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for(std::size_t i = 0; i < runs.size(); ++i)
+    {
+        const Benchmark &benchmark = *runs[i].first;
+        std::string name = benchmark.name() + (benchmark.arguments.empty() ? std::string() : "/" + std::to_string(runs[i].second));
+
+        if(benchmark.gl && !glAvailable)
+        {
+            BenchmarkResult skipped = emptyResult(name, benchmark.reportUnit);
+            skipped.error = "needs a GL context";
+            printResult(skipped);
+            results.push_back(skipped);
+            continue;
+        }
+
+        std::vector<BenchmarkResult> repetitions;
+        for(unsigned int r = 0; r < settings.repetitions; ++r)
+        {
+            BenchmarkResult result = runOnce(benchmark, runs[i].second, name);
+            result.repetition = r;
+            printResult(result);
+            results.push_back(result);
+            if(!result.error.empty())
+                break;
+            repetitions.push_back(result);
+        }
+
+        if(repetitions.size() > 1)
+        {
+            const char* aggregates[] = { "mean", "median", "stddev" };
+            for(const char* which : aggregates)
+            {
+                results.push_back(aggregate(repetitions, which));
+                printResult(results.back());
+            }
+        }
+    }
+    return results;
+}
+
+// ------------------------------------------------------------------------
+bool BenchmarkRunner::writeJson(const std::string &path, const std::vector<BenchmarkResult> &results,
+                                const std::vector<std::pair<std::string, std::string>> &context) const
+{
+    std::ofstream out(path.c_str(), std::ios::trunc);
+
+    char date[64] = "";
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\",\n"
+#else
+        << "    \"library_build_type\": \"debug\",\n"
+#endif
+        << "    \"min_time\": " << settings.minTime << ",\n"
+        << "    \"repetitions\": " << settings.repetitions;
+    for(std::size_t i = 0; i < context.size(); ++i)
+    {
+        out << ",\n    \"";
+        writeEscaped(out, context[i].first);
+        out << "\": \"";
+        writeEscaped(out, context[i].second);
+        out << "\"";
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+
+    out.precision(10);
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult &result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\n      \"name\": \"";
+        writeEscaped(out, result.name);
+        out << "\",\n      \"run_name\": \"";
+        writeEscaped(out, result.runName);
+        out << "\",\n      \"run_type\": \"" << (result.aggregate.empty() ? "iteration" : "aggregate") << "\",\n"
+            << "      \"repetitions\": " << settings.repetitions << ",\n"
+            << "      \"repetition_index\": " << result.repetition << ",\n"
+            << "      \"threads\": 1,\n";
+        if(!result.aggregate.empty())
+            out << "      \"aggregate_name\": \"" << result.aggregate << "\",\n";
+        if(!result.error.empty())
+        {
+            out << "      \"error_occurred\": true,\n      \"error_message\": \"";
+            writeEscaped(out, result.error);
+            out << "\",\n";
+        }
+        out << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"real_time\": " << result.realTime << ",\n"
+            << "      \"cpu_time\": " << result.cpuTime << ",\n"
+            << "      \"time_unit\": \"" << unitName(result.unit) << "\"";
+        if(result.itemsPerSecond > 0.0)
+            out << ",\n      \"items_per_second\": " << result.itemsPerSecond;
+        if(result.bytesPerSecond > 0.0)
+            out << ",\n      \"bytes_per_second\": " << result.bytesPerSecond;
+        if(!result.label.empty())
+        {
+            out << ",\n      \"label\": \"";
+            writeEscaped(out, result.label);
+            out << "\"";
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+    if(!out)
+    {
+        std::cout << "ERROR::BENCHMARK::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
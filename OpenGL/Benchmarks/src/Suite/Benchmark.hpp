@@ -0,0 +1,172 @@
+#ifndef __BENCHMARK_HPP_INCLUDED__
+#define __BENCHMARK_HPP_INCLUDED__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A small benchmark runner in the shape of Google Benchmark: functions register under a name,
+// loop on keepRunning() and the runner picks the iteration count so each run lasts at least
+// the minimum time. Results print as a table and write as Google Benchmark's JSON, so its
+// compare tooling works on two runs of LearnGP_bench.
+//
+//   void glmMultiply(BenchmarkState &state)
+//   {
+//       ... setup, not timed ...
+//       while(state.keepRunning())
+//           ... the work ...
+//       state.setItemsProcessed(state.iterations() * state.argument());
+//   }
+//   LEARNGP_BENCHMARK("Glm/Multiply", glmMultiply)->argument(1024)->argument(16384);
+// ---------------------------------------------------------------------------------------
+enum class BenchmarkUnit
+{
+    Nanoseconds,
+    Microseconds,
+    Milliseconds
+};
+
+class BenchmarkState
+{
+public:
+    BenchmarkState(std::uint64_t iterations, std::int64_t argument);
+
+    bool keepRunning()
+    {
+        if(remaining != 0 && running)
+        {
+            --remaining;
+            return true;
+        }
+        return startOrFinish();
+    }
+
+    std::uint64_t iterations() const { return total; }
+    std::int64_t argument() const { return value; }
+
+    // Excludes per iteration setup from the time.
+    void pauseTiming();
+    void resumeTiming();
+
+    void setItemsProcessed(std::int64_t items) { itemCount = items > 0 ? items : 0; }
+    void setBytesProcessed(std::int64_t bytes) { byteCount = bytes > 0 ? bytes : 0; }
+    void setLabel(const std::string &text) { label = text; }
+    // Call before the loop; the benchmark is reported as skipped with the reason.
+    void skip(const std::string &reason) { error = reason; remaining = 0; }
+
+private:
+    friend class BenchmarkRunner;
+    typedef std::chrono::steady_clock Clock;
+
+    bool startOrFinish();
+
+private:
+    std::uint64_t total;
+    std::uint64_t remaining;
+    std::int64_t  value;
+    bool          running;
+    bool          finished;
+
+    Clock::time_point start;
+    double            cpuStart;     // Seconds of this thread's CPU time.
+    double            realSeconds;
+    double            cpuSeconds;
+
+    std::int64_t itemCount;
+    std::int64_t byteCount;
+    std::string  label;
+    std::string  error;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState &state);
+
+class Benchmark
+{
+public:
+    Benchmark(const std::string &name, BenchmarkFunction function);
+
+    // One run per argument, named "name/argument"; without any the function runs once with 0.
+    Benchmark* argument(std::int64_t value) { arguments.push_back(value); return this; }
+    Benchmark* unit(BenchmarkUnit timeUnit) { reportUnit = timeUnit; return this; }
+    // Only runs with a GL context current (not with --no-gl, nor when none could be made).
+    Benchmark* requiresGL() { gl = true; return this; }
+
+    const std::string& name() const { return benchmarkName; }
+
+private:
+    friend class BenchmarkRunner;
+
+    std::string               benchmarkName;
+    BenchmarkFunction         function;
+    std::vector<std::int64_t> arguments;
+    BenchmarkUnit             reportUnit;
+    bool                      gl;
+};
+
+// Keeps the benchmark alive for the whole program; the pointer is for the chained setters.
+Benchmark* registerBenchmark(const std::string &name, BenchmarkFunction function);
+std::vector<Benchmark*>& registeredBenchmarks();
+
+#define LEARNGP_BENCHMARK_CONCAT_(a, b) a##b
+#define LEARNGP_BENCHMARK_CONCAT(a, b) LEARNGP_BENCHMARK_CONCAT_(a, b)
+#define LEARNGP_BENCHMARK(name, function) \
+    static Benchmark* const LEARNGP_BENCHMARK_CONCAT(registeredBenchmark, __LINE__) = registerBenchmark(name, function)
+
+struct BenchmarkResult
+{
+    std::string   name;
+    std::string   runName;        // Without the aggregate suffix.
+    std::string   aggregate;      // "mean", "median", "stddev"; empty for single runs.
+    unsigned int  repetition;
+    std::uint64_t iterations;
+    double        realTime;       // Per iteration, in 'unit'.
+    double        cpuTime;
+    BenchmarkUnit unit;
+    double        itemsPerSecond; // 0 when the benchmark didn't report any.
+    double        bytesPerSecond;
+    std::string   label;
+    std::string   error;
+};
+
+struct BenchmarkSettings
+{
+    std::string  filter;          // ECMAScript regex searched in the full name, empty runs everything.
+    double       minTime;         // Seconds per run.
+    unsigned int repetitions;     // With more than one, mean / median / stddev rows are added.
+    bool         gl;
+    bool         list;            // Print the names and exit.
+    bool         help;            // The usage was printed, exit.
+    std::string  outPath;         // JSON results.
+
+    BenchmarkSettings() : minTime(0.5), repetitions(1), gl(true), list(false), help(false) {}
+};
+
+// False on an unknown or malformed argument, after printing the usage. Values follow their option
+// as the next argument or after '='.
+bool parseBenchmarkSettings(int argc, char** argv, BenchmarkSettings &settings);
+
+class BenchmarkRunner
+{
+public:
+    explicit BenchmarkRunner(const BenchmarkSettings &settings) : settings(settings) {}
+
+    // Whether any benchmark passing the filter wants GL, so a context is only made when needed.
+    bool needsGL() const;
+
+    // Runs and prints every registered benchmark passing the filter; GL ones only with 'glAvailable'.
+    std::vector<BenchmarkResult> run(bool glAvailable);
+
+    // 'context' is extra key / value pairs for the "context" object (GL renderer, backend, ...).
+    bool writeJson(const std::string &path, const std::vector<BenchmarkResult> &results,
+                   const std::vector<std::pair<std::string, std::string>> &context) const;
+
+private:
+    std::vector<std::pair<Benchmark*, std::int64_t>> selected() const;
+    BenchmarkResult runOnce(const Benchmark &benchmark, std::int64_t argument, const std::string &name) const;
+
+private:
+    BenchmarkSettings settings;
+};
+
+#endif // !__BENCHMARK_HPP_INCLUDED__
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+
+#include "Shaders/Shader.hpp"
+
+#include "Renderer/DrawQueue.hpp"
+#include "Renderer/GeometryArena.hpp"
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/InstanceBatcher.hpp"
+#include "Renderer/Mesh.hpp"
+#include "Renderer/RenderTarget.hpp"
+#include "Renderer/UniformBlocks.hpp"
+#include "Renderer/UniformRingBuffer.hpp"
+
+// A whole frame of 'argument' small triangles: record, sort, upload the blocks, draw, and wait
+// for the GPU. Tiny triangles keep the fill rate out of it, so this is the submission path.
+// ---------------------------------------------------------------------------------------
+namespace
+{
+    const GLsizei    TARGET_SIZE    = 256;
+    const GLsizeiptr MAX_BLOCK_SIZE = 256;    // Ring space per draw: a DrawBlock, its indirect command and its share of the alignment, with room to spare.
+
+    // Everything the draws need, made before timing and torn down before the context goes.
+    struct Scene
+    {
+        std::unique_ptr<RenderTarget>      target;
+        std::unique_ptr<Shader>            shader;
+        std::unique_ptr<Shader>            instancedShader;
+        std::unique_ptr<GeometryArena>     geometry;
+        std::unique_ptr<UniformRingBuffer> uniforms;
+        std::unique_ptr<DrawQueue>         queue;
+        std::unique_ptr<InstanceBatcher>   instances;
+        MeshRange                          triangle;
+        std::vector<glm::mat4>             models;
+    };
+
+    bool makeScene(BenchmarkState &state, Scene &scene)
+    {
+        GLStateCache &glState = *GLStateCache::current();
+        const std::size_t draws = (std::size_t)state.argument();
+
+        scene.target.reset(new RenderTarget(glState, TARGET_SIZE, TARGET_SIZE));
+        scene.shader.reset(new Shader(SHADERS_RES_DIR "shaders/basic.shader"));
+        scene.instancedShader.reset(new Shader(SHADERS_RES_DIR "shaders/instanced.shader"));
+        if(!scene.target->isComplete() || !scene.shader->isValid() || !scene.instancedShader->isValid())
+        {
+            state.skip("could not set up the scene");
+            return false;
+        }
+
+        Shader* shaders[] = { scene.shader.get(), scene.instancedShader.get() };
+        for(Shader* shader : shaders)
+        {
+            shader->bindUniformBlock("Draws", DRAW_BLOCK_BINDING);
+        }
+
+        const float vertices[] = {
+             0.5f, -0.5f, 0.0f,  1.0f, 0.0f, 0.0f,
+            -0.5f, -0.5f, 0.0f,  0.0f, 1.0f, 0.0f,
+             0.0f,  0.5f, 0.0f,  0.0f, 0.0f, 1.0f
+        };
+        const unsigned int indices[] = { 0, 1, 2 };
+
+        VertexLayout layout;
+        layout.add(0, VertexFormat::Half4);
+        layout.add(1, VertexFormat::Unorm8x4);
+
+        Mesh triangle(layout, 3);
+        triangle.set(0, vertices,     3, 6 * sizeof(float));
+        triangle.set(1, vertices + 3, 3, 6 * sizeof(float));
+        triangle.setIndices(indices, 3);
+
+        scene.geometry.reset(new GeometryArena(glState, layout));
+        scene.triangle = triangle.upload(*scene.geometry);
+
+        scene.uniforms.reset(new UniformRingBuffer((GLsizeiptr)(draws + 2) * MAX_BLOCK_SIZE));
+        scene.queue.reset(new DrawQueue(draws));
+        scene.instances.reset(new InstanceBatcher(draws));
+        scene.instances->attach(glState, scene.geometry->vertexArray());
+        glState.bindVertexArray(0);
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+        for(std::size_t i = 0; i < draws; ++i)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(coordinate(random), coordinate(random), 0.0f));
+            scene.models.push_back(glm::scale(model, glm::vec3(0.01f)));
+        }
+
+        scene.target->bind();
+        return true;
+    }
+
+    void finishScene(BenchmarkState &state, Scene &scene)
+    {
+        state.setItemsProcessed((std::int64_t)(state.iterations() * scene.models.size()));
+        state.setLabel(std::to_string(scene.queue->stats().drawCalls) + " draw calls");
+        RenderTarget::unbind();
+    }
+
+    // One packet per triangle, each with its own model matrix in its DrawBlock.
+    void submitQueue(BenchmarkState &state, bool multiDraw)
+    {
+        Scene scene;
+        if(!makeScene(state, scene))
+            return;
+
+        GLStateCache &glState = *GLStateCache::current();
+        scene.queue->setMultiDrawIndirect(multiDraw && scene.queue->isMultiDrawIndirect());
+
+        while(state.keepRunning())
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            scene.uniforms->beginFrame();
+
+            DrawPacket packet = scene.geometry->packet(scene.triangle);
+            packet.program    = scene.shader->getID();
+            for(std::size_t i = 0; i < scene.models.size(); ++i)
+            {
+                packet.block.object.model = scene.models[i];
+                packet.depth              = (float)i / scene.models.size();
+                scene.queue->push(packet);
+            }
+
+            scene.queue->submit(glState, scene.uniforms.get());
+            scene.queue->clear();
+            scene.uniforms->endFrame();
+            glFinish();
+        }
+
+        // All packets share their state, so multi drawing needs one call per Draws array.
+        const std::size_t draws    = scene.models.size();
+        const std::size_t expected = scene.queue->isMultiDrawIndirect() ? (draws + DRAW_BLOCK_CAPACITY - 1) / DRAW_BLOCK_CAPACITY : draws;
+        if(scene.queue->stats().drawCalls != expected)
+        {
+            state.skip(std::to_string(scene.queue->stats().drawCalls) + " draw calls, expected " + std::to_string(expected));
+            RenderTarget::unbind();
+            return;
+        }
+        finishScene(state, scene);
+    }
+
+    void drawSubmissionQueue(BenchmarkState &state)    { submitQueue(state, true); }
+    void drawSubmissionSeparate(BenchmarkState &state) { submitQueue(state, false); }
+
+    // The same triangles merged by InstanceBatcher into instanced draws.
+    void drawSubmissionInstanced(BenchmarkState &state)
+    {
+        Scene scene;
+        if(!makeScene(state, scene))
+            return;
+
+        GLStateCache &glState = *GLStateCache::current();
+
+        while(state.keepRunning())
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            scene.uniforms->beginFrame();
+
+            // The default DrawBlock: identity model, white.
+            DrawPacket packet = scene.geometry->packet(scene.triangle);
+            packet.program    = scene.instancedShader->getID();
+
+            for(std::size_t i = 0; i < scene.models.size(); ++i)
+            {
+                InstanceData instance;
+                instance.model = scene.models[i];
+                instance.color = glm::vec4(1.0f);
+                scene.instances->add(packet, instance);
+            }
+            scene.instances->flush(glState, *scene.queue);
+
+            scene.queue->submit(glState, scene.uniforms.get());
+            scene.queue->clear();
+            scene.uniforms->endFrame();
+            glFinish();
+        }
+        finishScene(state, scene);
+    }
+
+    // Keys spread over typical numbers of programs, meshes and textures.
+    std::vector<DrawSortEntry> makeSortEntries(std::size_t count)
+    {
+        std::mt19937 random(1234);
+        std::uniform_int_distribution<GLuint> program(1, 64), vertexArray(1, 512), texture(1, 1024);
+        std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+        std::uniform_int_distribution<int>    blended(0, 9);
+
+        std::vector<DrawSortEntry> entries(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            DrawPacket packet;
+            packet.program     = program(random);
+            packet.vertexArray = vertexArray(random);
+            packet.texture     = texture(random);
+            packet.depth       = depth(random);
+            packet.blended     = blended(random) == 0;
+
+            entries[i].key    = DrawQueue::makeKey(packet);
+            entries[i].packet = (std::uint32_t)i;
+        }
+        return entries;
+    }
+
+    // The sort inside DrawQueue::submit().
+    void drawQueueRadixSort(BenchmarkState &state)
+    {
+        const std::size_t count = (std::size_t)state.argument();
+        std::vector<DrawSortEntry> input = makeSortEntries(count), entries, scratch(count);
+
+        while(state.keepRunning())
+        {
+            state.pauseTiming();
+            entries = input;
+            state.resumeTiming();
+            radixSort(entries.data(), scratch.data(), count);
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * count));
+    }
+
+    // Comparison sort on the same keys, the baseline the radix sort has to beat.
+    void drawQueueStdSort(BenchmarkState &state)
+    {
+        const std::size_t count = (std::size_t)state.argument();
+        std::vector<DrawSortEntry> input = makeSortEntries(count), entries;
+
+        while(state.keepRunning())
+        {
+            state.pauseTiming();
+            entries = input;
+            state.resumeTiming();
+            std::sort(entries.begin(), entries.end(), [](const DrawSortEntry &a, const DrawSortEntry &b) { return a.key < b.key; });
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * count));
+    }
+}
+
+LEARNGP_BENCHMARK("DrawSubmission/Queue", drawSubmissionQueue)->argument(1000)->argument(10000)->argument(100000)->unit(BenchmarkUnit::Milliseconds)->requiresGL();
+LEARNGP_BENCHMARK("DrawSubmission/Separate", drawSubmissionSeparate)->argument(1000)->argument(10000)->argument(100000)->unit(BenchmarkUnit::Milliseconds)->requiresGL();
+LEARNGP_BENCHMARK("DrawSubmission/Instanced", drawSubmissionInstanced)->argument(1000)->argument(10000)->argument(100000)->unit(BenchmarkUnit::Milliseconds)->requiresGL();
+LEARNGP_BENCHMARK("DrawQueue/RadixSort", drawQueueRadixSort)->argument(1000)->argument(10000)->argument(100000)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("DrawQueue/StdSort", drawQueueStdSort)->argument(1000)->argument(10000)->argument(100000)->unit(BenchmarkUnit::Microseconds);
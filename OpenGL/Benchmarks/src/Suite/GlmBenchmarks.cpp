@@ -0,0 +1,104 @@
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.hpp"
+
+// The per object matrix work a frame does on the CPU, in batches of 'argument' objects.
+// -------------------------------------------------------------------------------------
+namespace
+{
+    struct Transforms
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> axes;
+        std::vector<float>     angles;
+        std::vector<glm::mat4> models;
+    };
+
+    Transforms makeTransforms(std::size_t count)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+        Transforms transforms;
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            transforms.positions.push_back(glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+            transforms.axes.push_back(glm::normalize(glm::vec3(coordinate(random), coordinate(random), coordinate(random)) + glm::vec3(0.01f)));
+            transforms.angles.push_back(angle(random));
+
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), transforms.positions.back());
+            transforms.models.push_back(glm::rotate(model, transforms.angles.back(), transforms.axes.back()));
+        }
+        return transforms;
+    }
+
+    const glm::mat4 VIEW_PROJECTION = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f)
+                                    * glm::lookAt(glm::vec3(0.0f, 50.0f, 200.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    void glmModelMatrices(BenchmarkState &state)
+    {
+        Transforms transforms = makeTransforms((std::size_t)state.argument());
+        std::vector<glm::mat4> models(transforms.positions.size());
+
+        while(state.keepRunning())
+        {
+            for(std::size_t i = 0; i < models.size(); ++i)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), transforms.positions[i]);
+                model = glm::rotate(model, transforms.angles[i], transforms.axes[i]);
+                models[i] = glm::scale(model, glm::vec3(1.5f));
+            }
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * models.size()));
+    }
+
+    void glmMultiply(BenchmarkState &state)
+    {
+        Transforms transforms = makeTransforms((std::size_t)state.argument());
+        std::vector<glm::mat4> modelViewProjections(transforms.models.size());
+
+        while(state.keepRunning())
+        {
+            for(std::size_t i = 0; i < transforms.models.size(); ++i)
+                modelViewProjections[i] = VIEW_PROJECTION * transforms.models[i];
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * transforms.models.size()));
+    }
+
+    void glmInverseTranspose(BenchmarkState &state)
+    {
+        Transforms transforms = makeTransforms((std::size_t)state.argument());
+        std::vector<glm::mat4> normalMatrices(transforms.models.size());
+
+        while(state.keepRunning())
+        {
+            for(std::size_t i = 0; i < transforms.models.size(); ++i)
+                normalMatrices[i] = glm::transpose(glm::inverse(transforms.models[i]));
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * transforms.models.size()));
+    }
+
+    // Clip space bounding sphere centers, what a CPU frustum test starts from.
+    void glmTransformPoints(BenchmarkState &state)
+    {
+        Transforms transforms = makeTransforms((std::size_t)state.argument());
+        std::vector<glm::vec4> clip(transforms.positions.size());
+
+        while(state.keepRunning())
+        {
+            for(std::size_t i = 0; i < transforms.positions.size(); ++i)
+                clip[i] = VIEW_PROJECTION * glm::vec4(transforms.positions[i], 1.0f);
+        }
+        state.setItemsProcessed((std::int64_t)(state.iterations() * clip.size()));
+    }
+}
+
+LEARNGP_BENCHMARK("Glm/ModelMatrices", glmModelMatrices)->argument(1024)->argument(16384)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("Glm/Multiply", glmMultiply)->argument(1024)->argument(16384)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("Glm/InverseTranspose", glmInverseTranspose)->argument(1024)->argument(16384)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("Glm/TransformPoints", glmTransformPoints)->argument(1024)->argument(16384)->unit(BenchmarkUnit::Microseconds);
@@ -0,0 +1,92 @@
+#include <string>
+
+#include <imgui.h>
+
+#include "Benchmark.hpp"
+
+// Building ImGui's draw lists, NewFrame() to Render(), without a renderer: what the GUI app pays
+// on the CPU every frame before anything reaches GL.
+// ------------------------------------------------------------------------------------------
+namespace
+{
+    // A context with a built font atlas, nothing else is needed to build draw lists.
+    class ImGuiFixture
+    {
+    public:
+        ImGuiFixture()
+        {
+            context = ImGui::CreateContext();
+            ImGuiIO &io = ImGui::GetIO();
+            io.IniFilename = nullptr;
+            io.DisplaySize = ImVec2(1280.0f, 720.0f);
+            io.DeltaTime   = 1.0f / 60.0f;
+
+            unsigned char* pixels;
+            int width, height;
+            io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        }
+
+        ~ImGuiFixture() { ImGui::DestroyContext(context); }
+
+        ImGuiFixture(const ImGuiFixture&) = delete;
+        ImGuiFixture& operator=(const ImGuiFixture&) = delete;
+
+    private:
+        ImGuiContext* context;
+    };
+
+    std::string drawDataLabel()
+    {
+        ImDrawData* drawData = ImGui::GetDrawData();
+        return std::to_string(drawData->TotalVtxCount) + " vertices, " + std::to_string(drawData->CmdListsCount) + " lists";
+    }
+
+    void imguiDemoWindow(BenchmarkState &state)
+    {
+        ImGuiFixture fixture;
+        while(state.keepRunning())
+        {
+            ImGui::NewFrame();
+            ImGui::ShowDemoWindow();
+            ImGui::Render();
+        }
+        state.setLabel(drawDataLabel());
+    }
+
+    // 'argument' rows of the widgets tool windows are made of, spread over a few windows.
+    void imguiWidgets(BenchmarkState &state)
+    {
+        ImGuiFixture fixture;
+        const int rows    = (int)state.argument();
+        const int windows = 4;
+        float values[windows] = { 0.25f, 0.5f, 0.75f, 1.0f };
+        bool  checks[windows] = { true, false, true, false };
+
+        while(state.keepRunning())
+        {
+            ImGui::NewFrame();
+            for(int w = 0; w < windows; ++w)
+            {
+                ImGui::SetNextWindowPos(ImVec2(w * 320.0f, 0.0f));
+                ImGui::SetNextWindowSize(ImVec2(320.0f, 720.0f));
+                ImGui::Begin(("Window " + std::to_string(w)).c_str());
+                for(int row = w; row < rows; row += windows)
+                {
+                    ImGui::PushID(row);
+                    ImGui::Text("Row %d: %.3f", row, values[w] * row);
+                    ImGui::SameLine();
+                    ImGui::Checkbox("##check", &checks[w]);
+                    ImGui::SliderFloat("##value", &values[w], 0.0f, 1.0f);
+                    ImGui::PopID();
+                }
+                ImGui::End();
+            }
+            ImGui::Render();
+        }
+        state.setItemsProcessed((std::int64_t)state.iterations() * rows);
+        state.setLabel(drawDataLabel());
+    }
+}
+
+LEARNGP_BENCHMARK("ImGui/DemoWindow", imguiDemoWindow)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("ImGui/Widgets", imguiWidgets)->argument(100)->argument(1000)->unit(BenchmarkUnit::Microseconds);
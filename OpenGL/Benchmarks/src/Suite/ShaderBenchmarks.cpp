@@ -0,0 +1,157 @@
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "Benchmark.hpp"
+
+#include "Shaders/Shader.hpp"
+#include "Shaders/ShaderSource.hpp"
+
+// Loading shader sources, building programs and setting uniforms through Shader.
+// ----------------------------------------------------------------------------
+namespace
+{
+    const char* COMBINED_SHADER = SHADERS_RES_DIR "shaders/basic.shader";
+    const char* UNIFORM_SHADER  = BENCHMARKS_RES_DIR "shaders/uniforms.shader";
+    const char* BINARY_CACHE    = "LearnGP_bench_shader_cache";
+
+    // Mapping the file and its #include, then splitting it into stage chunks.
+    void shaderSourceLoad(BenchmarkState &state)
+    {
+        while(state.keepRunning())
+        {
+            ShaderSourceCache cache;
+            ShaderSource source;
+            if(!source.loadCombined(COMBINED_SHADER, cache))
+            {
+                state.skip("could not load " + std::string(COMBINED_SHADER));
+                return;
+            }
+        }
+    }
+
+    // The same with every file already mapped, as when several shaders share an include.
+    void shaderSourceLoadCached(BenchmarkState &state)
+    {
+        ShaderSourceCache cache;
+        while(state.keepRunning())
+        {
+            ShaderSource source;
+            if(!source.loadCombined(COMBINED_SHADER, cache))
+            {
+                state.skip("could not load " + std::string(COMBINED_SHADER));
+                return;
+            }
+        }
+    }
+
+    // Compile + link, waiting for the driver; argument 1 goes through a warm binary cache instead.
+    void shaderBuild(BenchmarkState &state)
+    {
+        ProgramBinaryCache binaryCache(BINARY_CACHE);
+        ProgramBinaryCache* cache = state.argument() ? &binaryCache : nullptr;
+        if(cache)
+        {
+            Shader warm(COMBINED_SHADER, cache);
+            if(!binaryCache.isEnabled() || !warm.isValid())
+            {
+                state.skip("no program binary support");
+                return;
+            }
+        }
+
+        while(state.keepRunning())
+        {
+            Shader shader(COMBINED_SHADER, cache);
+            if(!shader.isValid())
+            {
+                state.skip("could not build " + std::string(COMBINED_SHADER));
+                return;
+            }
+        }
+        state.setLabel(state.argument() ? "binary cache" : "compile + link");
+    }
+
+    // Uniform benchmarks share one program, loaded and made current before timing.
+    bool useUniformShader(BenchmarkState &state, Shader &shader)
+    {
+        if(!shader.isValid())
+        {
+            state.skip("could not build " + std::string(UNIFORM_SHADER));
+            return false;
+        }
+        shader.use();
+        return true;
+    }
+
+    void shaderGetUniform(BenchmarkState &state)
+    {
+        Shader shader(UNIFORM_SHADER);
+        if(!useUniformShader(state, shader))
+            return;
+
+        const std::string names[] = { "model", "view", "projection", "offsets[3]", "time", "tint", "lightDirection", "missing" };
+        unsigned int found = 0;
+        for(int i = 0; i < 8; ++i)
+            found += shader.getUniform(names[i]).isValid() ? 1 : 0;
+
+        unsigned int next = 0;
+        while(state.keepRunning())
+        {
+            shader.getUniform(names[next]);
+            next = (next + 1) & 7;
+        }
+        state.setItemsProcessed((std::int64_t)state.iterations());
+        state.setLabel(std::to_string(found) + " of 8 names found");
+    }
+
+    // The string API as most call sites use it: a literal turned into a std::string every call.
+    void shaderSetByName(BenchmarkState &state)
+    {
+        Shader shader(UNIFORM_SHADER);
+        if(!useUniformShader(state, shader))
+            return;
+
+        float time = 0.0f;
+        while(state.keepRunning())
+            shader.setFloat("time", time += 1.0f);
+        state.setItemsProcessed((std::int64_t)state.iterations());
+    }
+
+    void shaderSetByHandle(BenchmarkState &state)
+    {
+        Shader shader(UNIFORM_SHADER);
+        if(!useUniformShader(state, shader))
+            return;
+
+        UniformHandle handle = shader.getUniform("time");
+        float time = 0.0f;
+        while(state.keepRunning())
+            shader.setFloat(handle, time += 1.0f);
+        state.setItemsProcessed((std::int64_t)state.iterations());
+    }
+
+    // The value doesn't change, so the shadow copy drops every call before it reaches GL.
+    void shaderSetRedundant(BenchmarkState &state)
+    {
+        Shader shader(UNIFORM_SHADER);
+        if(!useUniformShader(state, shader))
+            return;
+
+        UniformHandle handle = shader.getUniform("model");
+        glm::mat4 model(2.0f);
+        shader.resetUniformStats();
+        while(state.keepRunning())
+            shader.setMat4(handle, model);
+        state.setItemsProcessed((std::int64_t)state.iterations());
+        state.setLabel(std::to_string(shader.uniformStats().uploadsSkipped) + " skipped");
+    }
+}
+
+LEARNGP_BENCHMARK("ShaderSource/Load", shaderSourceLoad)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("ShaderSource/LoadCached", shaderSourceLoadCached)->unit(BenchmarkUnit::Microseconds);
+LEARNGP_BENCHMARK("Shader/Build", shaderBuild)->argument(0)->argument(1)->unit(BenchmarkUnit::Milliseconds)->requiresGL();
+LEARNGP_BENCHMARK("Shader/GetUniform", shaderGetUniform)->requiresGL();
+LEARNGP_BENCHMARK("Shader/SetByName", shaderSetByName)->requiresGL();
+LEARNGP_BENCHMARK("Shader/SetByHandle", shaderSetByHandle)->requiresGL();
+LEARNGP_BENCHMARK("Shader/SetRedundant", shaderSetRedundant)->requiresGL();
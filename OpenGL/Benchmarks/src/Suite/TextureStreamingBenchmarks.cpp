@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/Image.hpp"
+#include "Renderer/TextureManager.hpp"
+
+// Streaming 'argument' textures through TextureManager, from load() until every one is resident.
+// Each update() is a frame; one that uploads more than the budget fails the benchmark.
+// ---------------------------------------------------------------------------------------
+namespace
+{
+    const GLsizei     TEXTURE_SIZE       = 512;
+    const std::size_t UPLOAD_BUFFER_SIZE = 1 << 20;
+    const std::size_t UPLOAD_BUDGET      = 2 << 20;    // Not a multiple of a level, so partial levels are exercised.
+    const char*       TEXTURE_PREFIX     = "LearnGP_bench_texture_";
+
+    // Gradients that differ per texture, written as TGA files for the workers to decode.
+    bool writeTextures(std::size_t count, std::vector<std::string> &paths)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            Image image(TEXTURE_SIZE, TEXTURE_SIZE);
+            for(GLsizei y = 0; y < TEXTURE_SIZE; ++y)
+            {
+                for(GLsizei x = 0; x < TEXTURE_SIZE; ++x)
+                {
+                    unsigned char* p = &image.pixels[((std::size_t)y * TEXTURE_SIZE + x) * 4];
+                    p[0] = (unsigned char)(x * 255 / TEXTURE_SIZE);
+                    p[1] = (unsigned char)(y * 255 / TEXTURE_SIZE);
+                    p[2] = (unsigned char)(i * 37);
+                    p[3] = 255;
+                }
+            }
+
+            paths.push_back(TEXTURE_PREFIX + std::to_string(i) + ".tga");
+            if(!writeImage(paths.back(), image))
+                return false;
+        }
+        return true;
+    }
+
+    void textureStreaming(BenchmarkState &state)
+    {
+        const std::size_t count = (std::size_t)state.argument();
+        std::vector<std::string> paths;
+        if(!writeTextures(count, paths))
+        {
+            state.skip("could not write the textures");
+            return;
+        }
+
+        GLStateCache &glState = *GLStateCache::current();
+        std::size_t frames = 0, largestFrame = 0, uploaded = 0;
+
+        while(state.keepRunning())
+        {
+            TextureManager textures(glState, 0, UPLOAD_BUFFER_SIZE);
+            for(std::size_t i = 0; i < paths.size(); ++i)
+                textures.load(paths[i]);
+
+            for(;;)
+            {
+                textures.update(UPLOAD_BUDGET);
+                // Stands in for the swap, which would flush the fences update() polls.
+                glFlush();
+
+                TextureManagerStats stats = textures.stats();
+                largestFrame = std::max(largestFrame, stats.uploadedBytes);
+                uploaded += stats.uploadedBytes;
+                ++frames;
+
+                if(stats.failed > 0)
+                {
+                    state.skip("could not load the textures");
+                    return;
+                }
+                if(stats.resident == count)
+                    break;
+            }
+            glFinish();
+        }
+
+        if(largestFrame > UPLOAD_BUDGET)
+        {
+            state.skip("a frame uploaded " + std::to_string(largestFrame) + " bytes, over the budget of " + std::to_string(UPLOAD_BUDGET));
+            return;
+        }
+
+        state.setBytesProcessed((std::int64_t)uploaded);
+        state.setLabel(std::to_string(frames / state.iterations()) + " frames, at most " + std::to_string(largestFrame >> 10) + " KiB each");
+    }
+}
+
+LEARNGP_BENCHMARK("TextureStreaming", textureStreaming)->argument(4)->argument(32)->unit(BenchmarkUnit::Milliseconds)->requiresGL();
@@ -0,0 +1,61 @@
+#include <glad/glad.h>
+
+#include <iostream>
+#include <memory>
+
+#include "Benchmark.hpp"
+
+#include "Harness/GLContext.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+
+// LearnGP_bench: every benchmark registered with LEARNGP_BENCHMARK in this directory. The GL ones
+// run in a headless context (see GLContext), so the numbers don't depend on a window or vsync.
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    if(!parseBenchmarkSettings(argc, argv, settings))
+        return -1;
+    if(settings.help)
+        return 0;
+
+    BenchmarkRunner runner(settings);
+
+    // Only made when a selected benchmark needs it, CPU runs work without any GL at all.
+    // ----------------------------------------------------------------------------------
+    GLContext context;
+    std::unique_ptr<GLStateCache> glState;
+    if(settings.gl && !settings.list && runner.needsGL())
+    {
+        ContextSettings contextSettings;
+        contextSettings.title    = "LearnGP_bench";
+        contextSettings.headless = true;
+        if(context.create(contextSettings))
+        {
+            glState.reset(new GLStateCache());
+            glState->makeCurrent();
+        }
+        else
+            std::cout << "No GL context, GL benchmarks are skipped" << std::endl;
+    }
+
+    std::vector<BenchmarkResult> results = runner.run(glState != nullptr);
+
+    if(!settings.outPath.empty())
+    {
+        std::vector<std::pair<std::string, std::string>> info;
+        if(context.isValid())
+        {
+            info.push_back(std::make_pair(std::string("gl_backend"), std::string(context.backend())));
+            info.push_back(std::make_pair(std::string("gl_renderer"), std::string((const char*)glGetString(GL_RENDERER))));
+            info.push_back(std::make_pair(std::string("gl_version"), std::string((const char*)glGetString(GL_VERSION))));
+        }
+        if(!runner.writeJson(settings.outPath, results, info))
+            return -1;
+    }
+
+    glState.reset();
+    GLStateCache::clearCurrent();
+    context.destroy();
+    return 0;
+}
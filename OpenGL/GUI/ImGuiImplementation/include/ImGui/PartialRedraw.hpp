@@ -0,0 +1,69 @@
+#ifndef __PARTIAL_REDRAW_HPP_INCLUDED__
+#define __PARTIAL_REDRAW_HPP_INCLUDED__
+
+#include "imgui.h"
+
+#include <vector>
+
+struct ImGui_ImplOpenGL3_HostState;
+
+// Finds what changed between two frames of ImGui draw data, and keeps the UI in an offscreen
+// framebuffer so only that part is drawn again. Each draw list is hashed (vertices, indices and
+// commands) and bounded by its clip rectangles; a list that changed, appeared, disappeared or moved
+// in the draw order damages its old and new bounds. Whatever is under or over the damaged area is
+// redrawn clipped to it, so blending stays right.
+//
+// Only what is in the draw data is seen: a texture whose texels changed needs invalidate().
+// ------------------------------------------------------------------------------------------------
+class PartialRedraw
+{
+public:
+	PartialRedraw();
+	~PartialRedraw();
+
+	PartialRedraw(const PartialRedraw&) = delete;
+	PartialRedraw& operator=(const PartialRedraw&) = delete;
+
+	// The next update() damages everything.
+	void invalidate() { invalidated = true; }
+
+	// Compares with the draw data of the previous call. False when nothing changed, the frame
+	// shown last is still right.
+	bool update(const ImDrawData* drawData);
+	// Damaged area of the last update(), in display coordinates (x1, y1, x2, y2).
+	const ImVec4& damage() const { return damageRect; }
+	// Damaged share of the display, 0 to 1.
+	float damagedFraction() const;
+
+	// Redraws the damaged area into the retained framebuffer, then copies all of it to the default
+	// framebuffer. 'state' is what the host has bound, as given to ImGui_ImplOpenGL3_SetHostState().
+	void render(ImDrawData* drawData, const ImVec4& clearColor, const ImGui_ImplOpenGL3_HostState& state);
+
+	// Drops the framebuffer; needs the GL context, which the destructor does too.
+	void release();
+
+private:
+	struct ListRecord
+	{
+		const ImDrawList* list;
+		ImU32             hash;
+		ImVec4            bounds;
+	};
+
+private:
+	std::vector<ListRecord> previous;
+	std::vector<ListRecord> current;
+	ImVec2                  displayPos;
+	ImVec2                  displaySize;
+	ImVec4                  damageRect;
+	bool                    invalidated;
+	bool                    undrawn;        // The last damage isn't in the framebuffer yet.
+	bool                    stale;          // The framebuffer missed some damage, redraw it all.
+
+	unsigned int framebuffer;
+	unsigned int color;
+	int          width;
+	int          height;
+};
+
+#endif // !__PARTIAL_REDRAW_HPP_INCLUDED__
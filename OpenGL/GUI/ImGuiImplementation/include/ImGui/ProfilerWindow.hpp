@@ -0,0 +1,10 @@
+#ifndef __PROFILER_WINDOW_HPP_INCLUDED__
+#define __PROFILER_WINDOW_HPP_INCLUDED__
+
+class Profiler;
+
+// Per zone CPU / GPU min, average and p99 in ms, with an enable toggle and a Chrome trace export.
+// Call between ImGui::NewFrame() and ImGui::Render().
+void ShowProfilerWindow(Profiler &profiler, bool* open = nullptr);
+
+#endif // !__PROFILER_WINDOW_HPP_INCLUDED__
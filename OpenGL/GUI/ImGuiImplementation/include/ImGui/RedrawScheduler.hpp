@@ -0,0 +1,97 @@
+#ifndef __REDRAW_SCHEDULER_HPP_INCLUDED__
+#define __REDRAW_SCHEDULER_HPP_INCLUDED__
+
+#include <atomic>
+
+struct GLFWwindow;
+
+// Decides when the UI needs a new frame, so an unchanged UI sleeps in glfwWaitEvents instead of
+// building and presenting the same frame at the refresh rate. A frame is needed after any window
+// event (input, resize, expose), while ImGui is animating by itself (buttons or keys held, text
+// cursor blinking) and when the application asks for one.
+//
+// Installs GLFW callbacks on the window that chain to the ones already installed, like the ImGui
+// GLFW binding does; only one scheduler may exist at a time.
+// ------------------------------------------------------------------------------------------------
+class RedrawScheduler
+{
+public:
+	// Frames built after an event: ImGui takes a few to settle (a window shown for the first time
+	// stays hidden for a frame while it measures its contents).
+	static const int SETTLE_FRAMES = 3;
+
+	explicit RedrawScheduler(GLFWwindow* window);
+	~RedrawScheduler();
+
+	RedrawScheduler(const RedrawScheduler&) = delete;
+	RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+
+	// Off, every frame is built and presented, as a plain glfwPollEvents loop would.
+	void setIdle(bool enabled) { idleEnabled = enabled; }
+	bool idle() const { return idleEnabled; }
+
+	// Call instead of glfwPollEvents(): processes events and returns once a frame is needed, or the
+	// window should close.
+	void waitForFrame();
+	// Call after ImGui::Render(). 'presented' is false when the frame was built but not swapped
+	// (nothing changed), the next one then waits for a refresh period instead of spinning.
+	void endFrame(bool presented);
+
+	// A frame is needed, the content changed without any input. May be called from any thread.
+	void invalidate();
+	// One frame once 'seconds' have passed, e.g. for a value refreshed once a second.
+	void invalidateAfter(double seconds);
+	// Every frame for the next 'seconds', for animations ImGui can't see.
+	void animateFor(double seconds);
+
+	// The window lost its contents since the last frame (resized, uncovered): present it in full.
+	bool windowDamaged() const { return damaged; }
+
+	unsigned long long frames() const { return frameCount; }
+	// Seconds spent waiting for events.
+	double idleTime() const { return idleSeconds; }
+
+private:
+	static void cursorPosCallback(GLFWwindow* window, double x, double y);
+	static void cursorEnterCallback(GLFWwindow* window, int entered);
+	static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+	static void scrollCallback(GLFWwindow* window, double x, double y);
+	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void charCallback(GLFWwindow* window, unsigned int c);
+	static void focusCallback(GLFWwindow* window, int focused);
+	static void refreshCallback(GLFWwindow* window);
+	static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+	void requestFrames(int count) { if (pendingFrames < count) pendingFrames = count; }
+
+private:
+	static RedrawScheduler* instance;
+
+	GLFWwindow* window;
+	bool        idleEnabled;
+	double      refreshPeriod;
+
+	int               pendingFrames;
+	std::atomic<bool> invalidated;
+	double            redrawAt;         // glfwGetTime() of the next timed frame, infinity when none.
+	double            animateUntil;
+	bool              damaged;
+	bool              lastPresented;
+	double            lastFrameStart;
+
+	unsigned long long frameCount;
+	double             idleSeconds;
+
+	// The callbacks installed before ours, called first.
+	void (*previousCursorPos)(GLFWwindow*, double, double);
+	void (*previousCursorEnter)(GLFWwindow*, int);
+	void (*previousMouseButton)(GLFWwindow*, int, int, int);
+	void (*previousScroll)(GLFWwindow*, double, double);
+	void (*previousKey)(GLFWwindow*, int, int, int, int);
+	void (*previousChar)(GLFWwindow*, unsigned int);
+	void (*previousFocus)(GLFWwindow*, int);
+	void (*previousRefresh)(GLFWwindow*);
+	void (*previousFramebufferSize)(GLFWwindow*, int, int);
+};
+
+#endif // !__REDRAW_SCHEDULER_HPP_INCLUDED__
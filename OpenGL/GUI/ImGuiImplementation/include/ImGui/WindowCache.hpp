@@ -0,0 +1,86 @@
+#ifndef __WINDOW_CACHE_HPP_INCLUDED__
+#define __WINDOW_CACHE_HPP_INCLUDED__
+
+#include "imgui.h"
+
+#include <vector>
+
+struct ImGuiWindow;
+
+// Keeps the draw list of ImGui windows whose contents didn't change, so they aren't built, laid out
+// and tessellated again every frame. The caller hashes what the window shows (the values it prints,
+// the state of its widgets); when that hash, the window's placement, its decorations, the style and
+// the font are the same as last time, begin() puts last frame's vertices back and returns false.
+// The renderer is told the draw list is unchanged too, and draws it from the copy it already
+// uploaded (ImGui_ImplOpenGL3_RetainDrawList()).
+//
+// A window is built normally while the mouse, keyboard navigation or an active item is on it, while
+// a popup or a drag and drop is open, and when it has child windows or open columns.
+// ------------------------------------------------------------------------------------------------
+class WindowCache
+{
+public:
+	// Frames an entry is kept for after its window was last shown.
+	static const int KEEP_FRAMES = 600;
+
+	WindowCache();
+
+	WindowCache(const WindowCache&) = delete;
+	WindowCache& operator=(const WindowCache&) = delete;
+
+	// Off, begin() and end() are ImGui::Begin() and ImGui::End().
+	void setEnabled(bool enabled) { cacheEnabled = enabled; }
+	bool enabled() const { return cacheEnabled; }
+
+	// Like ImGui::Begin(), and as with it end() must always be called. False when the contents
+	// mustn't be submitted: the window is collapsed or clipped, or was restored from the cache.
+	bool begin(const char* name, ImGuiID contentHash, bool* open = nullptr, ImGuiWindowFlags flags = 0);
+	void end();
+
+	// Windows restored and built again during the last frame that had any.
+	int reused() const { return reusedCount; }
+	int rebuilt() const { return rebuiltCount; }
+
+	void clear() { entries.clear(); }
+
+private:
+	struct Entry
+	{
+		ImGuiID              id;
+		ImU32                key;
+		bool                 cacheable;
+		unsigned int         version;
+		int                  lastFrame;
+		ImVector<ImDrawCmd>  cmdBuffer;
+		ImVector<ImDrawIdx>  idxBuffer;
+		ImVector<ImDrawVert> vtxBuffer;
+		unsigned int         vtxCurrentOffset;
+		unsigned int         vtxCurrentIdx;
+		ImVec2               contentSize;   // DC.CursorMaxPos - DC.CursorStartPos
+	};
+
+	// One per begin() not yet ended.
+	struct Call
+	{
+		ImGuiWindow* window;
+		ImGuiID      id;
+		ImU32        key;
+		bool         restored;
+		bool         building;     // Contents submitted, compare or snapshot them in end().
+		bool         interacting;  // Built with hover or active states, not snapshot.
+	};
+
+	Entry* find(ImGuiID id);
+	void   countFrame();
+
+private:
+	std::vector<Entry> entries;
+	std::vector<Call>  calls;
+	bool               cacheEnabled;
+	unsigned int       nextVersion;
+	int                statsFrame;
+	int                reusedCount;
+	int                rebuiltCount;
+};
+
+#endif // !__WINDOW_CACHE_HPP_INCLUDED__
@@ -35,11 +35,51 @@
 #define IMGUI_IMPL_OPENGL_LOADER_GL3W
 #endif
 
+// GL state the host renderer already tracks (see ImGui_ImplOpenGL3_SetHostState). Values use GL types/enums.
+struct ImGui_ImplOpenGL3_HostState
+{
+    unsigned int    Program;
+    unsigned int    Texture2D;              // Bound to GL_TEXTURE0
+    unsigned int    Sampler;                // Bound to unit 0
+    unsigned int    ArrayBuffer;
+    unsigned int    VertexArray;
+    unsigned int    ActiveTexture;          // GL_TEXTURE0 + unit
+    unsigned int    PolygonMode;
+    int             Viewport[4];
+    int             ScissorBox[4];
+    unsigned int    BlendSrcRgb, BlendDstRgb, BlendSrcAlpha, BlendDstAlpha;
+    unsigned int    BlendEquationRgb, BlendEquationAlpha;
+    bool            EnableBlend, EnableCullFace, EnableDepthTest, EnableScissorTest;
+    bool            ClipOriginLowerLeft;    // False after glClipControl(GL_UPPER_LEFT, ...)
+};
+
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_Init(const char* glsl_version = NULL);
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_Shutdown();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_NewFrame();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data);
 
+// Desktop GL only, enabled by default: upload all draw lists of a frame into one contiguous region of a shared buffer
+// (persistently mapped and triple-buffered on GL 4.4+, orphaned and mapped once per frame otherwise) instead of reallocating per draw list.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStreamingUpload(bool enabled);
+
+// Opt-in: instead of ~20 glGet/glIsEnabled queries per frame to back up GL state, read it from 'state', which the host keeps current,
+// and restore it from there after rendering. Also keeps one VAO alive instead of creating one per frame, so only use it when
+// rendering from a single GL context. Pass NULL to go back to querying.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetHostState(const ImGui_ImplOpenGL3_HostState* state);
+
+// Partial redraw: only draw inside 'rect' (display coordinates, x1/y1/x2/y2 like ImDrawCmd::ClipRect). Commands outside of it are
+// skipped and the others are clipped to it, so the rest of the framebuffer keeps what the previous frame drew. Pass NULL to draw everything.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetDamageRect(const ImVec4* rect);
+
+// State changes made by the last ImGui_ImplOpenGL3_RenderDrawData() call: issued to GL vs. skipped because nothing would have changed.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_GetStateStats(int* out_issued, int* out_filtered);
+
+// Desktop GL, streaming upload and host state only: 'draw_list' is the same as in the last frame that declared it with this 'version',
+// so its vertices and indices are drawn from the copy already on the GPU. Any other version uploads it again. Declare every frame, after NewFrame().
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_RetainDrawList(const ImDrawList* draw_list, unsigned int version);
+// Declared draw lists of the last ImGui_ImplOpenGL3_RenderDrawData() call: drawn from the retained copy vs. uploaded again.
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_GetRetainStats(int* out_reused, int* out_uploaded);
+
 // Called by Init/NewFrame/Shutdown
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateFontsTexture();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
@@ -0,0 +1,213 @@
+#include "ImGui/PartialRedraw.hpp"
+
+#include "ImGui/imgui_impl_opengl3.h"
+
+#include "imgui_internal.h"
+
+#include <glad/glad.h>
+
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	const ImVec4 EMPTY_RECT(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	bool IsEmpty(const ImVec4& rect)
+	{
+		return rect.x >= rect.z || rect.y >= rect.w;
+	}
+
+	void AddRect(ImVec4& rect, const ImVec4& other)
+	{
+		if (IsEmpty(other))
+			return;
+		rect.x = ImMin(rect.x, other.x);
+		rect.y = ImMin(rect.y, other.y);
+		rect.z = ImMax(rect.z, other.z);
+		rect.w = ImMax(rect.w, other.w);
+	}
+
+	template<typename T>
+	ImU32 HashValue(const T& value, ImU32 seed)
+	{
+		return ImHashData(&value, sizeof(value), seed);
+	}
+}
+
+PartialRedraw::PartialRedraw()
+	: displayPos(0.0f, 0.0f), displaySize(0.0f, 0.0f), damageRect(EMPTY_RECT), invalidated(true), undrawn(false), stale(true),
+	  framebuffer(0), color(0), width(0), height(0)
+{
+}
+
+PartialRedraw::~PartialRedraw()
+{
+	release();
+}
+
+void PartialRedraw::release()
+{
+	if (framebuffer != 0)
+		glDeleteFramebuffers(1, &framebuffer);
+	if (color != 0)
+		glDeleteRenderbuffers(1, &color);
+	framebuffer = color = 0;
+	width = height = 0;
+	stale = true;
+}
+
+// ------------------------------------------------------------------------
+bool PartialRedraw::update(const ImDrawData* drawData)
+{
+	const ImVec4 display(drawData->DisplayPos.x, drawData->DisplayPos.y,
+	                     drawData->DisplayPos.x + drawData->DisplaySize.x, drawData->DisplayPos.y + drawData->DisplaySize.y);
+
+	// Commands and their clip rectangles are hashed field by field, ImDrawCmd has padding.
+	current.resize((size_t)drawData->CmdListsCount);
+	for (int n = 0; n < drawData->CmdListsCount; n++)
+	{
+		const ImDrawList* list = drawData->CmdLists[n];
+		ListRecord& record = current[(size_t)n];
+		record.list = list;
+		record.hash = ImHashData(list->VtxBuffer.Data, (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert), 0);
+		record.hash = ImHashData(list->IdxBuffer.Data, (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx), record.hash);
+
+		ImVec4 clip = EMPTY_RECT;
+		bool callbacks = false;
+		for (int i = 0; i < list->CmdBuffer.Size; i++)
+		{
+			const ImDrawCmd& cmd = list->CmdBuffer[i];
+			record.hash = HashValue(cmd.ElemCount, record.hash);
+			record.hash = HashValue(cmd.ClipRect, record.hash);
+			record.hash = HashValue(cmd.TextureId, record.hash);
+			record.hash = HashValue(cmd.VtxOffset, record.hash);
+			record.hash = HashValue(cmd.IdxOffset, record.hash);
+			record.hash = HashValue(cmd.UserCallback, record.hash);
+			record.hash = HashValue(cmd.UserCallbackData, record.hash);
+			// A callback may draw anywhere.
+			callbacks = callbacks || cmd.UserCallback != NULL;
+			AddRect(clip, callbacks ? display : cmd.ClipRect);
+		}
+
+		// Clip rectangles are often a lot larger than what is drawn in them (popups, the foreground list).
+		// A pixel of margin for vertices on a pixel's far edge.
+		ImVec2 low(FLT_MAX, FLT_MAX), high(-FLT_MAX, -FLT_MAX);
+		for (int i = 0; i < list->VtxBuffer.Size; i++)
+		{
+			low = ImMin(low, list->VtxBuffer.Data[i].pos);
+			high = ImMax(high, list->VtxBuffer.Data[i].pos);
+		}
+		record.bounds = clip;
+		if (!callbacks)
+			record.bounds = ImVec4(ImMax(clip.x, low.x), ImMax(clip.y, low.y), ImMin(clip.z, high.x + 1.0f), ImMin(clip.w, high.y + 1.0f));
+	}
+
+	damageRect = EMPTY_RECT;
+	bool resized = drawData->DisplayPos.x != displayPos.x || drawData->DisplayPos.y != displayPos.y ||
+	               drawData->DisplaySize.x != displaySize.x || drawData->DisplaySize.y != displaySize.y;
+	if (invalidated || resized)
+		damageRect = display;
+	else
+	{
+		// By position in the draw order: a list drawn in another place may now cover or uncover others.
+		for (size_t i = 0; i < ImMax(previous.size(), current.size()); i++)
+		{
+			const ListRecord* before = i < previous.size() ? &previous[i] : NULL;
+			const ListRecord* after = i < current.size() ? &current[i] : NULL;
+			if (before && after && before->list == after->list && before->hash == after->hash)
+				continue;
+			if (before)
+				AddRect(damageRect, before->bounds);
+			if (after)
+				AddRect(damageRect, after->bounds);
+		}
+	}
+
+	// Whole pixels, clipped to the display.
+	damageRect.x = ImMax(std::floor(damageRect.x), display.x);
+	damageRect.y = ImMax(std::floor(damageRect.y), display.y);
+	damageRect.z = ImMin(std::ceil(damageRect.z), display.z);
+	damageRect.w = ImMin(std::ceil(damageRect.w), display.w);
+
+	previous.swap(current);
+	displayPos = drawData->DisplayPos;
+	displaySize = drawData->DisplaySize;
+	invalidated = false;
+
+	bool changed = !IsEmpty(damageRect);
+	if (!changed)
+		damageRect = EMPTY_RECT;
+	// The retained framebuffer can only be patched if it saw every change before this one.
+	if (undrawn)
+		stale = true;
+	undrawn = changed;
+	return changed;
+}
+
+float PartialRedraw::damagedFraction() const
+{
+	if (IsEmpty(damageRect) || displaySize.x <= 0.0f || displaySize.y <= 0.0f)
+		return 0.0f;
+	return (damageRect.z - damageRect.x) * (damageRect.w - damageRect.y) / (displaySize.x * displaySize.y);
+}
+
+// ------------------------------------------------------------------------
+void PartialRedraw::render(ImDrawData* drawData, const ImVec4& clearColor, const ImGui_ImplOpenGL3_HostState& state)
+{
+	const int fbWidth = (int)(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+	const int fbHeight = (int)(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+	if (fbWidth <= 0 || fbHeight <= 0)
+		return;
+
+	if (fbWidth != width || fbHeight != height)
+	{
+		release();
+		glGenRenderbuffers(1, &color);
+		glBindRenderbuffer(GL_RENDERBUFFER, color);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, fbWidth, fbHeight);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+		width = fbWidth;
+		height = fbHeight;
+	}
+
+	ImVec4 rect = damageRect;
+	if (stale)
+		rect = ImVec4(displayPos.x, displayPos.y, displayPos.x + displaySize.x, displayPos.y + displaySize.y);
+
+	if (undrawn || stale)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+		// Clear just the damaged pixels (framebuffer space, origin bottom left) and put the scissor back.
+		const ImVec2 scale = drawData->FramebufferScale;
+		const int x = (int)((rect.x - displayPos.x) * scale.x);
+		const int y = (int)(fbHeight - (rect.w - displayPos.y) * scale.y);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(x, y, (int)((rect.z - rect.x) * scale.x), (int)((rect.w - rect.y) * scale.y));
+		glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glScissor(state.ScissorBox[0], state.ScissorBox[1], state.ScissorBox[2], state.ScissorBox[3]);
+		if (!state.EnableScissorTest)
+			glDisable(GL_SCISSOR_TEST);
+
+		ImGui_ImplOpenGL3_SetDamageRect(&rect);
+		ImGui_ImplOpenGL3_RenderDrawData(drawData);
+		ImGui_ImplOpenGL3_SetDamageRect(NULL);
+		undrawn = stale = false;
+	}
+
+	// The blit is scissored too.
+	if (state.EnableScissorTest)
+		glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (state.EnableScissorTest)
+		glEnable(GL_SCISSOR_TEST);
+}
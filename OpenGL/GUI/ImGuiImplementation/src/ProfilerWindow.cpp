@@ -0,0 +1,79 @@
+#include "ImGui/ProfilerWindow.hpp"
+
+#include "Renderer/Profiler.hpp"
+
+#include "imgui.h"
+
+#include <algorithm>
+
+namespace
+{
+	const char* TRACE_PATH = "profile_trace.json";
+
+	void StatsColumns(const ProfileStats &stats)
+	{
+		if (stats.samples == 0)
+		{
+			ImGui::TextDisabled("-"); ImGui::NextColumn();
+			ImGui::TextDisabled("-"); ImGui::NextColumn();
+			ImGui::TextDisabled("-"); ImGui::NextColumn();
+			return;
+		}
+		ImGui::Text("%.3f", stats.min);     ImGui::NextColumn();
+		ImGui::Text("%.3f", stats.average); ImGui::NextColumn();
+		ImGui::Text("%.3f", stats.p99);     ImGui::NextColumn();
+	}
+}
+
+void ShowProfilerWindow(Profiler &profiler, bool* open)
+{
+	if (!ImGui::Begin("Profiler", open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	bool enabled = profiler.enabled();
+	if (ImGui::Checkbox("Enabled", &enabled))
+		profiler.setEnabled(enabled);
+
+	ImGui::SameLine();
+	static bool saved = false;
+	if (ImGui::Button("Save Chrome trace"))
+		saved = profiler.writeChromeTrace(TRACE_PATH);
+	if (saved)
+	{
+		ImGui::SameLine();
+		ImGui::Text("%s", TRACE_PATH);
+	}
+
+	if (!profiler.gpuSupported())
+		ImGui::TextDisabled("GPU timings need OpenGL 3.3 timer queries.");
+	else if (profiler.droppedFrames() > 0)
+		ImGui::Text("%u frames without GPU timings (GPU too far behind)", profiler.droppedFrames());
+
+	// Slowest on the CPU first; "Frame" ends up on top.
+	std::vector<ProfileZoneStats> zones = profiler.stats();
+	std::sort(zones.begin(), zones.end(), [](const ProfileZoneStats &a, const ProfileZoneStats &b) { return a.cpu.average > b.cpu.average; });
+
+	ImGui::Separator();
+	ImGui::Columns(8, "zones");
+	const char* headers[] = { "Zone", "Calls", "CPU min", "CPU avg", "CPU p99", "GPU min", "GPU avg", "GPU p99" };
+	for (int i = 0; i < 8; ++i)
+	{
+		ImGui::Text("%s", headers[i]);
+		ImGui::NextColumn();
+	}
+	ImGui::Separator();
+
+	for (std::size_t i = 0; i < zones.size(); ++i)
+	{
+		ImGui::Text("%s", zones[i].name.c_str()); ImGui::NextColumn();
+		ImGui::Text("%.1f", zones[i].callsPerFrame); ImGui::NextColumn();
+		StatsColumns(zones[i].cpu);
+		StatsColumns(zones[i].gpu);
+	}
+	ImGui::Columns(1);
+
+	ImGui::End();
+}
@@ -0,0 +1,207 @@
+#include "ImGui/RedrawScheduler.hpp"
+
+#include "imgui.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	const double NEVER = std::numeric_limits<double>::infinity();
+	// ImGui blinks the text cursor on a 1.2s cycle (0.8s on, 0.4s off).
+	const double CURSOR_BLINK_INTERVAL = 0.4;
+	const double DEFAULT_REFRESH_PERIOD = 1.0 / 60.0;
+
+	// Whether ImGui keeps changing things while the input stays the same: held buttons repeat,
+	// drags scroll, keys auto-repeat.
+	bool InputHeld(const ImGuiIO& io)
+	{
+		for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); i++)
+			if (io.MouseDown[i])
+				return true;
+		for (int i = 0; i < IM_ARRAYSIZE(io.KeysDown); i++)
+			if (io.KeysDown[i])
+				return true;
+		return false;
+	}
+}
+
+RedrawScheduler* RedrawScheduler::instance = nullptr;
+
+RedrawScheduler::RedrawScheduler(GLFWwindow* window)
+	: window(window), idleEnabled(true), refreshPeriod(DEFAULT_REFRESH_PERIOD), pendingFrames(SETTLE_FRAMES), invalidated(false),
+	  redrawAt(NEVER), animateUntil(0.0), damaged(true), lastPresented(true), lastFrameStart(0.0), frameCount(0), idleSeconds(0.0)
+{
+	IM_ASSERT(instance == nullptr && "Only one RedrawScheduler at a time");
+	instance = this;
+
+	GLFWmonitor* monitor = glfwGetWindowMonitor(window) ? glfwGetWindowMonitor(window) : glfwGetPrimaryMonitor();
+	const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+	if (mode && mode->refreshRate > 0)
+		refreshPeriod = 1.0 / mode->refreshRate;
+
+	previousCursorPos       = glfwSetCursorPosCallback(window, cursorPosCallback);
+	previousCursorEnter     = glfwSetCursorEnterCallback(window, cursorEnterCallback);
+	previousMouseButton     = glfwSetMouseButtonCallback(window, mouseButtonCallback);
+	previousScroll          = glfwSetScrollCallback(window, scrollCallback);
+	previousKey             = glfwSetKeyCallback(window, keyCallback);
+	previousChar            = glfwSetCharCallback(window, charCallback);
+	previousFocus           = glfwSetWindowFocusCallback(window, focusCallback);
+	previousRefresh         = glfwSetWindowRefreshCallback(window, refreshCallback);
+	previousFramebufferSize = glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+}
+
+RedrawScheduler::~RedrawScheduler()
+{
+	glfwSetCursorPosCallback(window, previousCursorPos);
+	glfwSetCursorEnterCallback(window, previousCursorEnter);
+	glfwSetMouseButtonCallback(window, previousMouseButton);
+	glfwSetScrollCallback(window, previousScroll);
+	glfwSetKeyCallback(window, previousKey);
+	glfwSetCharCallback(window, previousChar);
+	glfwSetWindowFocusCallback(window, previousFocus);
+	glfwSetWindowRefreshCallback(window, previousRefresh);
+	glfwSetFramebufferSizeCallback(window, previousFramebufferSize);
+	instance = nullptr;
+}
+
+// ------------------------------------------------------------------------
+void RedrawScheduler::waitForFrame()
+{
+	glfwPollEvents();
+	if (!idleEnabled)
+	{
+		lastFrameStart = glfwGetTime();
+		return;
+	}
+
+	for (;;)
+	{
+		if (glfwWindowShouldClose(window))
+			break;
+
+		double now = glfwGetTime();
+		if (invalidated.exchange(false))
+			requestFrames(SETTLE_FRAMES);
+		if (now >= redrawAt)
+		{
+			requestFrames(1);
+			redrawAt = NEVER;
+		}
+		if (now < animateUntil)
+			requestFrames(1);
+
+		// A frame that wasn't presented didn't wait for vsync either, so the next one waits here.
+		double earliest = lastPresented ? now : lastFrameStart + refreshPeriod;
+		if (pendingFrames > 0 && now >= earliest)
+			break;
+
+		double wake = pendingFrames > 0 ? earliest : redrawAt;
+		if (wake == NEVER)
+			glfwWaitEvents();
+		else
+			glfwWaitEventsTimeout(wake - now);
+		idleSeconds += glfwGetTime() - now;
+	}
+	lastFrameStart = glfwGetTime();
+}
+
+void RedrawScheduler::endFrame(bool presented)
+{
+	++frameCount;
+	if (pendingFrames > 0)
+		--pendingFrames;
+	lastPresented = presented;
+	if (presented)
+		damaged = false;
+
+	const ImGuiIO& io = ImGui::GetIO();
+	if (InputHeld(io) || (ImGui::IsAnyItemActive() && !io.WantTextInput))
+		requestFrames(1);
+	else if (io.WantTextInput)
+		invalidateAfter(CURSOR_BLINK_INTERVAL);
+}
+
+void RedrawScheduler::invalidate()
+{
+	invalidated = true;
+	glfwPostEmptyEvent();
+}
+
+void RedrawScheduler::invalidateAfter(double seconds)
+{
+	redrawAt = std::min(redrawAt, glfwGetTime() + seconds);
+}
+
+void RedrawScheduler::animateFor(double seconds)
+{
+	animateUntil = std::max(animateUntil, glfwGetTime() + seconds);
+}
+
+// ------------------------------------------------------------------------
+void RedrawScheduler::cursorPosCallback(GLFWwindow* window, double x, double y)
+{
+	if (instance->previousCursorPos)
+		instance->previousCursorPos(window, x, y);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::cursorEnterCallback(GLFWwindow* window, int entered)
+{
+	if (instance->previousCursorEnter)
+		instance->previousCursorEnter(window, entered);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+	if (instance->previousMouseButton)
+		instance->previousMouseButton(window, button, action, mods);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::scrollCallback(GLFWwindow* window, double x, double y)
+{
+	if (instance->previousScroll)
+		instance->previousScroll(window, x, y);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (instance->previousKey)
+		instance->previousKey(window, key, scancode, action, mods);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::charCallback(GLFWwindow* window, unsigned int c)
+{
+	if (instance->previousChar)
+		instance->previousChar(window, c);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::focusCallback(GLFWwindow* window, int focused)
+{
+	if (instance->previousFocus)
+		instance->previousFocus(window, focused);
+	instance->requestFrames(SETTLE_FRAMES);
+}
+
+void RedrawScheduler::refreshCallback(GLFWwindow* window)
+{
+	if (instance->previousRefresh)
+		instance->previousRefresh(window);
+	instance->damaged = true;
+	instance->requestFrames(1);
+}
+
+void RedrawScheduler::framebufferSizeCallback(GLFWwindow* window, int width, int height)
+{
+	if (instance->previousFramebufferSize)
+		instance->previousFramebufferSize(window, width, height);
+	instance->damaged = true;
+	instance->requestFrames(SETTLE_FRAMES);
+}
@@ -0,0 +1,236 @@
+#include "ImGui/WindowCache.hpp"
+
+#include "ImGui/imgui_impl_opengl3.h"
+
+#include "imgui_internal.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	template<typename T>
+	ImU32 HashValue(const T& value, ImU32 seed)
+	{
+		return ImHashData(&value, sizeof(value), seed);
+	}
+
+	// ImDrawCmd has padding, its fields are hashed and compared one by one.
+	ImU32 HashCommand(const ImDrawCmd& cmd, ImU32 seed)
+	{
+		seed = HashValue(cmd.ElemCount, seed);
+		seed = HashValue(cmd.ClipRect, seed);
+		seed = HashValue(cmd.TextureId, seed);
+		seed = HashValue(cmd.VtxOffset, seed);
+		seed = HashValue(cmd.IdxOffset, seed);
+		seed = HashValue(cmd.UserCallback, seed);
+		return HashValue(cmd.UserCallbackData, seed);
+	}
+
+	bool SameCommand(const ImDrawCmd& a, const ImDrawCmd& b)
+	{
+		return a.ElemCount == b.ElemCount && a.TextureId == b.TextureId && a.VtxOffset == b.VtxOffset && a.IdxOffset == b.IdxOffset &&
+		       a.UserCallback == b.UserCallback && a.UserCallbackData == b.UserCallbackData &&
+		       a.ClipRect.x == b.ClipRect.x && a.ClipRect.y == b.ClipRect.y && a.ClipRect.z == b.ClipRect.z && a.ClipRect.w == b.ClipRect.w;
+	}
+
+	template<typename T>
+	bool SameBuffer(const ImVector<T>& a, const ImVector<T>& b)
+	{
+		return a.Size == b.Size && (a.Size == 0 || std::memcmp(a.Data, b.Data, (size_t)a.Size * sizeof(T)) == 0);
+	}
+
+	template<typename T>
+	void CopyBuffer(ImVector<T>& destination, const ImVector<T>& source)
+	{
+		// Not operator=, which frees and allocates again.
+		destination.resize(source.Size);
+		if (source.Size > 0)
+			std::memcpy(destination.Data, source.Data, (size_t)source.Size * sizeof(T));
+	}
+
+	// Everything other than the contents that the window's draw list depends on. What Begin() drew (background,
+	// title bar, scrollbars, borders) stands for the placement, size, focus and most of the style.
+	ImU32 WindowKey(const ImGuiWindow* window, ImGuiID contentHash)
+	{
+		const ImGuiContext& g = *GImGui;
+		const ImDrawList* list = window->DrawList;
+
+		ImU32 key = HashValue(contentHash, 0);
+		key = ImHashData(list->VtxBuffer.Data, (size_t)list->VtxBuffer.Size * sizeof(ImDrawVert), key);
+		key = ImHashData(list->IdxBuffer.Data, (size_t)list->IdxBuffer.Size * sizeof(ImDrawIdx), key);
+		for (int i = 0; i < list->CmdBuffer.Size; i++)
+			key = HashCommand(list->CmdBuffer[i], key);
+		key = HashValue(window->Pos, key);
+		key = HashValue(window->Size, key);
+		key = HashValue(window->Scroll, key);
+		key = HashValue(window->DC.CursorStartPos, key);
+		key = HashValue(window->FontWindowScale, key);
+		key = ImHashData(&g.Style, sizeof(g.Style), key);
+		key = HashValue(g.Font, key);
+		key = HashValue(g.FontSize, key);
+		key = HashValue(g.Font->ContainerAtlas->TexID, key);
+		return HashValue(g.IO.DisplaySize, key);
+	}
+
+	bool AnyKeyDown(const ImGuiIO& io)
+	{
+		for (int i = 0; i < IM_ARRAYSIZE(io.KeysDown); i++)
+			if (io.KeysDown[i])
+				return true;
+		return false;
+	}
+
+	// Whether what the window shows may depend on input this frame: hover and active states, popups, and for the
+	// focused window the navigation highlight and keys (Tab focuses the next item, which has to be submitted).
+	bool Interacting(const ImGuiWindow* window)
+	{
+		const ImGuiContext& g = *GImGui;
+		const bool focused = window == g.NavWindow && (!g.NavDisableHighlight || AnyKeyDown(g.IO) || g.IO.InputQueueCharacters.Size > 0);
+		return focused || window == g.HoveredWindow || window == g.HoveredRootWindow || window == g.ActiveIdWindow || window == g.MovingWindow ||
+		       g.NavWindowingTarget != NULL || g.OpenPopupStack.Size > 0 || g.DragDropActive;
+	}
+}
+
+WindowCache::WindowCache()
+	: cacheEnabled(true), nextVersion(0), statsFrame(-1), reusedCount(0), rebuiltCount(0)
+{
+}
+
+WindowCache::Entry* WindowCache::find(ImGuiID id)
+{
+	for (size_t i = 0; i < entries.size(); i++)
+		if (entries[i].id == id)
+			return &entries[i];
+	return nullptr;
+}
+
+void WindowCache::countFrame()
+{
+	const int frame = ImGui::GetFrameCount();
+	if (frame == statsFrame)
+		return;
+	statsFrame = frame;
+	reusedCount = rebuiltCount = 0;
+
+	// Outside of any begin()/end(), Call::id lookups stay valid.
+	if (calls.empty())
+		entries.erase(std::remove_if(entries.begin(), entries.end(),
+		                             [frame](const Entry& entry) { return frame - entry.lastFrame > KEEP_FRAMES; }),
+		              entries.end());
+}
+
+// ------------------------------------------------------------------------
+bool WindowCache::begin(const char* name, ImGuiID contentHash, bool* open, ImGuiWindowFlags flags)
+{
+	countFrame();
+	const bool visible = ImGui::Begin(name, open, flags);
+
+	ImGuiWindow* window = ImGui::GetCurrentWindow();
+	Call call = { window, window->ID, 0, false, false, false };
+	// Only the first Begin() of the frame: the draw list holds nothing else of this window.
+	if (!cacheEnabled || !visible || window->BeginCount > 1 || window->Appearing || !window->WasActive ||
+	    window->HiddenFramesCanSkipItems > 0 || window->HiddenFramesCannotSkipItems > 0)
+	{
+		calls.push_back(call);
+		return visible;
+	}
+
+	call.key = WindowKey(window, contentHash);
+	call.building = true;
+	call.interacting = Interacting(window);
+	Entry* entry = find(window->ID);
+	if (entry && entry->cacheable && entry->key == call.key && !call.interacting)
+	{
+		ImDrawList* list = window->DrawList;
+		CopyBuffer(list->CmdBuffer, entry->cmdBuffer);
+		CopyBuffer(list->IdxBuffer, entry->idxBuffer);
+		CopyBuffer(list->VtxBuffer, entry->vtxBuffer);
+		list->_VtxCurrentOffset = entry->vtxCurrentOffset;
+		list->_VtxCurrentIdx = entry->vtxCurrentIdx;
+		list->_VtxWritePtr = list->VtxBuffer.Data + list->VtxBuffer.Size;
+		list->_IdxWritePtr = list->IdxBuffer.Data + list->IdxBuffer.Size;
+		// The next frame sizes the scrollbars and auto-resizing windows from it.
+		window->DC.CursorMaxPos = ImVec2(window->DC.CursorStartPos.x + entry->contentSize.x, window->DC.CursorStartPos.y + entry->contentSize.y);
+
+		entry->lastFrame = ImGui::GetFrameCount();
+		call.restored = true;
+		call.building = false;
+		calls.push_back(call);
+		return false;
+	}
+
+	calls.push_back(call);
+	return true;
+}
+
+void WindowCache::end()
+{
+	IM_ASSERT(!calls.empty() && "end() without begin()");
+	const Call call = calls.back();
+	calls.pop_back();
+	ImGuiWindow* window = call.window;
+	IM_ASSERT(window == ImGui::GetCurrentWindow() && "Mismatched begin()/end()");
+
+	unsigned int version = 0;
+	if (call.restored)
+	{
+		version = find(call.id)->version;
+		++reusedCount;
+	}
+	else if (call.building)
+	{
+		Entry* entry = find(call.id);
+		if (!entry)
+		{
+			entries.push_back(Entry());
+			entry = &entries.back();
+			entry->id = call.id;
+			entry->key = 0;
+			entry->cacheable = false;
+			entry->version = 0;
+		}
+		entry->lastFrame = ImGui::GetFrameCount();
+
+		// Built again but the same (hovered, nothing changed): the renderer's copy is still good.
+		const ImDrawList* list = window->DrawList;
+		bool same = entry->version != 0 && entry->cmdBuffer.Size == list->CmdBuffer.Size &&
+		            SameBuffer(entry->idxBuffer, list->IdxBuffer) && SameBuffer(entry->vtxBuffer, list->VtxBuffer);
+		for (int i = 0; same && i < list->CmdBuffer.Size; i++)
+			same = SameCommand(entry->cmdBuffer[i], list->CmdBuffer[i]);
+
+		// Other draw lists (child windows) and split channels (columns) aren't in a snapshot.
+		const bool complete = window->DC.ChildWindows.Size == 0 && window->DC.CurrentColumns == NULL && list->_Splitter._Count <= 1;
+		if (call.interacting)
+		{
+			// Hover and active states must not end up in the snapshot, which stays what it was.
+			if (same && complete)
+				version = entry->version;
+		}
+		else
+		{
+			entry->key = call.key;
+			entry->cacheable = complete;
+			if (complete)
+			{
+				if (!same)
+				{
+					CopyBuffer(entry->cmdBuffer, list->CmdBuffer);
+					CopyBuffer(entry->idxBuffer, list->IdxBuffer);
+					CopyBuffer(entry->vtxBuffer, list->VtxBuffer);
+					entry->version = ++nextVersion != 0 ? nextVersion : ++nextVersion;
+				}
+				entry->vtxCurrentOffset = list->_VtxCurrentOffset;
+				entry->vtxCurrentIdx = list->_VtxCurrentIdx;
+				entry->contentSize = ImVec2(window->DC.CursorMaxPos.x - window->DC.CursorStartPos.x, window->DC.CursorMaxPos.y - window->DC.CursorStartPos.y);
+				version = entry->version;
+			}
+		}
+		++rebuiltCount;
+	}
+
+	ImGui::End();
+	// End() only closes the clip rectangle, which it does the same way each time.
+	if (version != 0)
+		ImGui_ImplOpenGL3_RetainDrawList(window->DrawList, version);
+}
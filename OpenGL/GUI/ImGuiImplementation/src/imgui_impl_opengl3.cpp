@@ -13,6 +13,11 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-17: OpenGL: Desktop GL only: Draw lists declared unchanged (ImGui_ImplOpenGL3_RetainDrawList()) are drawn from a copy kept on the GPU instead of being streamed again.
+//  2026-10-17: OpenGL: Optional damage rectangle (ImGui_ImplOpenGL3_SetDamageRect()) restricting rendering to the part of the framebuffer that changed.
+//  2026-10-17: OpenGL: Skip state changes that would not change anything (shadowed against the backed up state), see ImGui_ImplOpenGL3_GetStateStats().
+//  2026-10-17: OpenGL: Optional host supplied GL state (ImGui_ImplOpenGL3_SetHostState()) replacing the glGet backup, with a persistent VAO.
+//  2026-10-17: OpenGL: Desktop GL only: Streaming upload of all draw lists into one region per frame (persistently mapped triple buffer on GL 4.4+, orphan + glMapBufferRange otherwise). See ImGui_ImplOpenGL3_SetStreamingUpload().
 //  2019-05-29: OpenGL: Desktop GL only: Added support for large mesh (64K+ vertices), enable ImGuiBackendFlags_RendererHasVtxOffset flag.
 //  2019-04-30: OpenGL: Added support for special ImDrawCallback_ResetRenderState callback to reset render state.
 //  2019-03-29: OpenGL: Not calling glBindBuffer more than necessary in the render loop.
@@ -123,6 +128,55 @@ static int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;
 static int          g_AttribLocationVtxPos = 0, g_AttribLocationVtxUV = 0, g_AttribLocationVtxColor = 0; // Vertex attributes location
 static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
 
+// Streaming upload (desktop GL only): every draw list of a frame is copied into one contiguous region and drawn with base vertex offsets.
+// With GL 4.4 the buffers are persistently mapped and split into IMGUI_IMPL_OPENGL_STREAM_FRAMES regions guarded by fences,
+// otherwise the whole buffer is orphaned and mapped once per frame. Either way the buffer storage is no longer reallocated per draw list.
+#define IMGUI_IMPL_OPENGL_STREAM_FRAMES 3
+static bool         g_StreamingUpload = IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX != 0;
+static bool         g_StreamPersistent = false;
+static int          g_StreamVtxCapacity = 0, g_StreamIdxCapacity = 0;   // Per region, in elements
+static ImDrawVert*  g_StreamVtxMapped = NULL;
+static ImDrawIdx*   g_StreamIdxMapped = NULL;
+static int          g_StreamRegion = 0;
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+static GLsync       g_StreamFences[IMGUI_IMPL_OPENGL_STREAM_FRAMES] = {};
+#endif
+
+// Host state mode: the host tells us what is bound, so nothing is queried, and our VAO lives as long as the device objects.
+static const ImGui_ImplOpenGL3_HostState* g_HostState = NULL;
+static GLuint       g_VertexArrayObject = 0;
+static bool         g_VertexArrayDirty = true;  // Attribute pointers / element buffer need to be (re)recorded into g_VertexArrayObject
+
+// Redundant state filtering: while rendering, g_BoundState shadows what is bound (starting from the backed up state) and state calls
+// that would not change it are skipped. User callbacks may change anything, so after one the shadow is not trusted for the rest of the frame.
+static ImGui_ImplOpenGL3_HostState g_BoundState;
+static bool         g_BoundStateKnown = false;
+static int          g_StateCallsIssued = 0, g_StateCallsFiltered = 0;           // Current frame
+static int          g_LastStateCallsIssued = 0, g_LastStateCallsFiltered = 0;   // Last completed frame
+static const GLuint g_UnknownBinding = (GLuint)-1;                              // No GL object uses this name
+
+// Retained draw lists (streaming upload with host state only): lists declared with ImGui_ImplOpenGL3_RetainDrawList() are kept in buffers
+// of their own with their version, and drawn from there while the version stays the same. Space is only allocated at the end of the buffers;
+// when it runs out everything still in use is uploaded again from the start.
+struct ImGui_ImplOpenGL3_RetainedList
+{
+    const ImDrawList*   DrawList;
+    unsigned int        Version;
+    int                 VtxOffset, IdxOffset;   // In the retained buffers, in elements
+    int                 VtxCount, IdxCount;
+};
+static ImVector<ImGui_ImplOpenGL3_RetainedList> g_DeclaredLists;    // This frame's declarations, offsets unused
+static ImVector<ImGui_ImplOpenGL3_RetainedList> g_RetainedLists;    // What the retained buffers hold
+static ImVector<int> g_ListSources;                                 // Per draw list of the frame: index into g_RetainedLists, -1 when streamed
+static GLuint       g_RetainedVboHandle = 0, g_RetainedElementsHandle = 0, g_RetainedVertexArray = 0;
+static int          g_RetainedVtxCapacity = 0, g_RetainedIdxCapacity = 0;
+static int          g_RetainedVtxUsed = 0, g_RetainedIdxUsed = 0;
+static int          g_RetainedReused = 0, g_RetainedUploaded = 0;       // Last frame, in draw lists
+
+// Partial redraw: commands are clipped to g_DamageRect (display coordinates, like ImDrawCmd::ClipRect) and skipped when outside of it.
+static bool         g_HasDamageRect = false;
+static ImVec4       g_DamageRect;
+
 // Functions
 bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
 {
@@ -157,6 +211,59 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
     return true;
 }
 
+void    ImGui_ImplOpenGL3_SetStreamingUpload(bool enabled)
+{
+#if !IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    enabled = false;    // Needs glDrawElementsBaseVertex()
+#endif
+    if (g_StreamingUpload == enabled)
+        return;
+    // The buffers are allocated differently in each mode.
+    if (g_VboHandle)
+    {
+        ImGui_ImplOpenGL3_DestroyDeviceObjects();
+        g_StreamingUpload = enabled;
+        ImGui_ImplOpenGL3_CreateDeviceObjects();
+    }
+    g_StreamingUpload = enabled;
+}
+
+void    ImGui_ImplOpenGL3_SetHostState(const ImGui_ImplOpenGL3_HostState* state)
+{
+    g_HostState = state;
+}
+
+void    ImGui_ImplOpenGL3_RetainDrawList(const ImDrawList* draw_list, unsigned int version)
+{
+    for (int i = 0; i < g_DeclaredLists.Size; i++)
+        if (g_DeclaredLists[i].DrawList == draw_list)
+        {
+            g_DeclaredLists[i].Version = version;
+            return;
+        }
+    ImGui_ImplOpenGL3_RetainedList declared = { draw_list, version, 0, 0, 0, 0 };
+    g_DeclaredLists.push_back(declared);
+}
+
+void    ImGui_ImplOpenGL3_GetRetainStats(int* out_reused, int* out_uploaded)
+{
+    if (out_reused) *out_reused = g_RetainedReused;
+    if (out_uploaded) *out_uploaded = g_RetainedUploaded;
+}
+
+void    ImGui_ImplOpenGL3_SetDamageRect(const ImVec4* rect)
+{
+    g_HasDamageRect = rect != NULL;
+    if (rect != NULL)
+        g_DamageRect = *rect;
+}
+
+void    ImGui_ImplOpenGL3_GetStateStats(int* out_issued, int* out_filtered)
+{
+    if (out_issued) *out_issued = g_LastStateCallsIssued;
+    if (out_filtered) *out_filtered = g_LastStateCallsFiltered;
+}
+
 void    ImGui_ImplOpenGL3_Shutdown()
 {
     ImGui_ImplOpenGL3_DestroyDeviceObjects();
@@ -164,26 +271,143 @@ void    ImGui_ImplOpenGL3_Shutdown()
 
 void    ImGui_ImplOpenGL3_NewFrame()
 {
+    // Declarations only hold for the frame they were made in, rendered or not.
+    g_DeclaredLists.resize(0);
     if (!g_FontTexture)
         ImGui_ImplOpenGL3_CreateDeviceObjects();
 }
 
+// Filtered state changes, only valid inside ImGui_ImplOpenGL3_RenderDrawData(). Each returns without a GL call when g_BoundState already matches.
+static bool ImGui_ImplOpenGL3_Unchanged(bool unchanged)
+{
+    unchanged = unchanged && g_BoundStateKnown;
+    if (unchanged) g_StateCallsFiltered++; else g_StateCallsIssued++;
+    return unchanged;
+}
+
+static void ImGui_ImplOpenGL3_UseProgram(GLuint program)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.Program == program)) return;
+    glUseProgram(program);
+    g_BoundState.Program = program;
+}
+
+static void ImGui_ImplOpenGL3_ActiveTexture(GLenum texture)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.ActiveTexture == texture)) return;
+    glActiveTexture(texture);
+    g_BoundState.ActiveTexture = texture;
+}
+
+// Texture unit 0 only, which is active whenever this is called.
+static void ImGui_ImplOpenGL3_BindTexture(GLuint texture)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.Texture2D == texture)) return;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    g_BoundState.Texture2D = texture;
+}
+
+#ifdef GL_SAMPLER_BINDING
+static void ImGui_ImplOpenGL3_BindSampler(GLuint sampler)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.Sampler == sampler)) return;
+    glBindSampler(0, sampler);
+    g_BoundState.Sampler = sampler;
+}
+#endif
+
+#ifndef IMGUI_IMPL_OPENGL_ES2
+static void ImGui_ImplOpenGL3_BindVertexArray(GLuint vertex_array)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.VertexArray == vertex_array)) return;
+    glBindVertexArray(vertex_array);
+    g_BoundState.VertexArray = vertex_array;
+}
+#endif
+
+static void ImGui_ImplOpenGL3_BindArrayBuffer(GLuint buffer)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.ArrayBuffer == buffer)) return;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    g_BoundState.ArrayBuffer = buffer;
+}
+
+static void ImGui_ImplOpenGL3_SetEnabled(GLenum capability, bool* bound, bool enabled)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(*bound == enabled)) return;
+    if (enabled) glEnable(capability); else glDisable(capability);
+    *bound = enabled;
+}
+
+static void ImGui_ImplOpenGL3_BlendEquation(GLenum mode_rgb, GLenum mode_alpha)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.BlendEquationRgb == mode_rgb && g_BoundState.BlendEquationAlpha == mode_alpha)) return;
+    glBlendEquationSeparate(mode_rgb, mode_alpha);
+    g_BoundState.BlendEquationRgb = mode_rgb;
+    g_BoundState.BlendEquationAlpha = mode_alpha;
+}
+
+static void ImGui_ImplOpenGL3_BlendFunc(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+{
+    ImGui_ImplOpenGL3_HostState& b = g_BoundState;
+    if (ImGui_ImplOpenGL3_Unchanged(b.BlendSrcRgb == src_rgb && b.BlendDstRgb == dst_rgb && b.BlendSrcAlpha == src_alpha && b.BlendDstAlpha == dst_alpha)) return;
+    glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+    b.BlendSrcRgb = src_rgb; b.BlendDstRgb = dst_rgb; b.BlendSrcAlpha = src_alpha; b.BlendDstAlpha = dst_alpha;
+}
+
+#ifdef GL_POLYGON_MODE
+static void ImGui_ImplOpenGL3_PolygonMode(GLenum mode)
+{
+    if (ImGui_ImplOpenGL3_Unchanged(g_BoundState.PolygonMode == mode)) return;
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    g_BoundState.PolygonMode = mode;
+}
+#endif
+
+static void ImGui_ImplOpenGL3_Viewport(int x, int y, int w, int h)
+{
+    const int* v = g_BoundState.Viewport;
+    if (ImGui_ImplOpenGL3_Unchanged(v[0] == x && v[1] == y && v[2] == w && v[3] == h)) return;
+    glViewport(x, y, (GLsizei)w, (GLsizei)h);
+    g_BoundState.Viewport[0] = x; g_BoundState.Viewport[1] = y; g_BoundState.Viewport[2] = w; g_BoundState.Viewport[3] = h;
+}
+
+static void ImGui_ImplOpenGL3_Scissor(int x, int y, int w, int h)
+{
+    const int* s = g_BoundState.ScissorBox;
+    if (ImGui_ImplOpenGL3_Unchanged(s[0] == x && s[1] == y && s[2] == w && s[3] == h)) return;
+    glScissor(x, y, (GLsizei)w, (GLsizei)h);
+    g_BoundState.ScissorBox[0] = x; g_BoundState.ScissorBox[1] = y; g_BoundState.ScissorBox[2] = w; g_BoundState.ScissorBox[3] = h;
+}
+
+// Element buffer and ImDrawVert attributes of the bound VAO, reading from the bound GL_ARRAY_BUFFER.
+static void ImGui_ImplOpenGL3_SetupVertexAttribs(GLuint elements)
+{
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements);
+    glEnableVertexAttribArray(g_AttribLocationVtxPos);
+    glEnableVertexAttribArray(g_AttribLocationVtxUV);
+    glEnableVertexAttribArray(g_AttribLocationVtxColor);
+    glVertexAttribPointer(g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
+    glVertexAttribPointer(g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
+    glVertexAttribPointer(g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+}
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_SCISSOR_TEST);
+    ImGui_ImplOpenGL3_SetEnabled(GL_BLEND, &g_BoundState.EnableBlend, true);
+    ImGui_ImplOpenGL3_BlendEquation(GL_FUNC_ADD, GL_FUNC_ADD);
+    ImGui_ImplOpenGL3_BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    ImGui_ImplOpenGL3_SetEnabled(GL_CULL_FACE, &g_BoundState.EnableCullFace, false);
+    ImGui_ImplOpenGL3_SetEnabled(GL_DEPTH_TEST, &g_BoundState.EnableDepthTest, false);
+    ImGui_ImplOpenGL3_SetEnabled(GL_SCISSOR_TEST, &g_BoundState.EnableScissorTest, true);
 #ifdef GL_POLYGON_MODE
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    ImGui_ImplOpenGL3_PolygonMode(GL_FILL);
 #endif
 
     // Setup viewport, orthographic projection matrix
     // Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
-    glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height);
+    ImGui_ImplOpenGL3_Viewport(0, 0, fb_width, fb_height);
     float L = draw_data->DisplayPos.x;
     float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
     float T = draw_data->DisplayPos.y;
@@ -195,83 +419,404 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
         { 0.0f,         0.0f,        -1.0f,   0.0f },
         { (R+L)/(L-R),  (T+B)/(B-T),  0.0f,   1.0f },
     };
-    glUseProgram(g_ShaderHandle);
+    ImGui_ImplOpenGL3_UseProgram(g_ShaderHandle);
     glUniform1i(g_AttribLocationTex, 0);
     glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
 #ifdef GL_SAMPLER_BINDING
-    glBindSampler(0, 0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
+    ImGui_ImplOpenGL3_BindSampler(0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
 #endif
 
     (void)vertex_array_object;
 #ifndef IMGUI_IMPL_OPENGL_ES2
-    glBindVertexArray(vertex_array_object);
+    ImGui_ImplOpenGL3_BindVertexArray(vertex_array_object);
 #endif
 
     // Bind vertex/index buffers and setup attributes for ImDrawVert
-    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
-    glEnableVertexAttribArray(g_AttribLocationVtxPos);
-    glEnableVertexAttribArray(g_AttribLocationVtxUV);
-    glEnableVertexAttribArray(g_AttribLocationVtxColor);
-    glVertexAttribPointer(g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    ImGui_ImplOpenGL3_BindArrayBuffer(g_VboHandle);
+#ifndef IMGUI_IMPL_OPENGL_ES2
+    // The persistent VAO already holds the element buffer and attribute setup unless the buffers were recreated.
+    if (vertex_array_object != 0 && vertex_array_object == g_VertexArrayObject)
+    {
+        if (!g_VertexArrayDirty)
+            return;
+        g_VertexArrayDirty = false;
+    }
+#endif
+    ImGui_ImplOpenGL3_SetupVertexAttribs(g_ElementsHandle);
 }
 
-// OpenGL3 Render function.
-// (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
-// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
-void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+static void ImGui_ImplOpenGL3_DestroyStreamBuffers()
 {
-    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
-    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
-    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
-    if (fb_width <= 0 || fb_height <= 0)
-        return;
+    for (int i = 0; i < IMGUI_IMPL_OPENGL_STREAM_FRAMES; i++)
+        if (g_StreamFences[i]) { glDeleteSync(g_StreamFences[i]); g_StreamFences[i] = 0; }
+    // Deleting a buffer also unmaps it.
+    if (g_VboHandle) glDeleteBuffers(1, &g_VboHandle);
+    if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
+    g_VboHandle = g_ElementsHandle = 0;
+    g_StreamVtxMapped = NULL;
+    g_StreamIdxMapped = NULL;
+    g_StreamVtxCapacity = g_StreamIdxCapacity = 0;
+    g_StreamRegion = 0;
+}
 
-    // Backup GL state
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
+// (Re)create the stream buffers so one region holds at least vtx_count vertices and idx_count indices.
+// Uses GL_ARRAY_BUFFER for both: the binding is restored by the caller, and unlike GL_ELEMENT_ARRAY_BUFFER it is not VAO state.
+static void ImGui_ImplOpenGL3_CreateStreamBuffers(int vtx_count, int idx_count)
+{
+    int vtx_capacity = g_StreamVtxCapacity > 0 ? g_StreamVtxCapacity : 4096;
+    int idx_capacity = g_StreamIdxCapacity > 0 ? g_StreamIdxCapacity : 8192;
+    while (vtx_capacity < vtx_count) vtx_capacity *= 2;
+    while (idx_capacity < idx_count) idx_capacity *= 2;
+
+    ImGui_ImplOpenGL3_DestroyStreamBuffers();
+    g_StreamVtxCapacity = vtx_capacity;
+    g_VertexArrayDirty = true;
+    g_StreamIdxCapacity = idx_capacity;
+
+    glGenBuffers(1, &g_VboHandle);
+    glGenBuffers(1, &g_ElementsHandle);
+#ifdef GL_MAP_PERSISTENT_BIT
+    if (g_StreamPersistent)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr vtx_size = (GLsizeiptr)vtx_capacity * sizeof(ImDrawVert) * IMGUI_IMPL_OPENGL_STREAM_FRAMES;
+        const GLsizeiptr idx_size = (GLsizeiptr)idx_capacity * sizeof(ImDrawIdx) * IMGUI_IMPL_OPENGL_STREAM_FRAMES;
+        glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
+        glBufferStorage(GL_ARRAY_BUFFER, vtx_size, NULL, flags);
+        g_StreamVtxMapped = (ImDrawVert*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vtx_size, flags);
+        glBindBuffer(GL_ARRAY_BUFFER, g_ElementsHandle);
+        glBufferStorage(GL_ARRAY_BUFFER, idx_size, NULL, flags);
+        g_StreamIdxMapped = (ImDrawIdx*)glMapBufferRange(GL_ARRAY_BUFFER, 0, idx_size, flags);
+        if (g_StreamVtxMapped == NULL || g_StreamIdxMapped == NULL)
+        {
+            // Mapping failed, fall back to orphaning from now on.
+            g_StreamPersistent = false;
+            ImGui_ImplOpenGL3_CreateStreamBuffers(vtx_count, idx_count);
+        }
+    }
+#endif
+}
+
+// Copy every streamed draw list (see g_ListSources) into this frame's region. Returns the region's first vertex / index in *vtx_base / *idx_base.
+// Must be called with our VAO and buffers bound (after ImGui_ImplOpenGL3_SetupRenderState).
+static void ImGui_ImplOpenGL3_UploadStreamed(ImDrawData* draw_data, int* vtx_base, int* idx_base)
+{
+    ImDrawVert* vtx_dst = NULL;
+    ImDrawIdx* idx_dst = NULL;
+    if (g_StreamPersistent)
+    {
+        // Only waits if the GPU is still reading this region, i.e. we are IMGUI_IMPL_OPENGL_STREAM_FRAMES frames ahead.
+        GLsync& fence = g_StreamFences[g_StreamRegion];
+        if (fence)
+        {
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+            glDeleteSync(fence);
+            fence = 0;
+        }
+        *vtx_base = g_StreamRegion * g_StreamVtxCapacity;
+        *idx_base = g_StreamRegion * g_StreamIdxCapacity;
+        vtx_dst = g_StreamVtxMapped + *vtx_base;
+        idx_dst = g_StreamIdxMapped + *idx_base;
+    }
+    else
+    {
+        // Orphan the previous storage so the driver never has to wait for the GPU, then map the whole frame at once.
+        const GLsizeiptr vtx_size = (GLsizeiptr)g_StreamVtxCapacity * sizeof(ImDrawVert);
+        const GLsizeiptr idx_size = (GLsizeiptr)g_StreamIdxCapacity * sizeof(ImDrawIdx);
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        glBufferData(GL_ARRAY_BUFFER, vtx_size, NULL, GL_STREAM_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_size, NULL, GL_STREAM_DRAW);
+        vtx_dst = (ImDrawVert*)glMapBufferRange(GL_ARRAY_BUFFER, 0, vtx_size, access);
+        idx_dst = (ImDrawIdx*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, idx_size, access);
+        *vtx_base = 0;
+        *idx_base = 0;
+    }
+
+    if (vtx_dst != NULL && idx_dst != NULL)
+    {
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            const ImDrawList* cmd_list = draw_data->CmdLists[n];
+            if (n < g_ListSources.Size && g_ListSources[n] >= 0)
+                continue;
+            memcpy(vtx_dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+            memcpy(idx_dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vtx_dst += cmd_list->VtxBuffer.Size;
+            idx_dst += cmd_list->IdxBuffer.Size;
+        }
+    }
+
+    if (!g_StreamPersistent)
+    {
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    }
+}
+
+static void ImGui_ImplOpenGL3_DestroyRetainedBuffers()
+{
+    if (g_RetainedVboHandle) glDeleteBuffers(1, &g_RetainedVboHandle);
+    if (g_RetainedElementsHandle) glDeleteBuffers(1, &g_RetainedElementsHandle);
+    if (g_RetainedVertexArray) glDeleteVertexArrays(1, &g_RetainedVertexArray);
+    g_RetainedVboHandle = g_RetainedElementsHandle = g_RetainedVertexArray = 0;
+    g_RetainedVtxCapacity = g_RetainedIdxCapacity = 0;
+    g_RetainedVtxUsed = g_RetainedIdxUsed = 0;
+    g_RetainedLists.resize(0);
+}
+
+// Decide where each draw list is drawn from (g_ListSources) and upload the declared lists the retained buffers don't hold yet.
+// Called with 'vertex_array_object' and the stream buffers bound, which are bound again before returning.
+static void ImGui_ImplOpenGL3_UpdateRetained(ImDrawData* draw_data, GLuint vertex_array_object)
+{
+    g_ListSources.resize(draw_data->CmdListsCount);
+    g_RetainedReused = g_RetainedUploaded = 0;
+
+    // -1: streamed, -2: to upload, otherwise the retained copy is still current.
+    int upload_vtx_count = 0, upload_idx_count = 0;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        g_ListSources[n] = -1;
+        for (int i = 0; i < g_DeclaredLists.Size && g_ListSources[n] == -1; i++)
+            if (g_DeclaredLists[i].DrawList == cmd_list)
+                g_ListSources[n] = -2;
+        if (g_ListSources[n] == -1)
+            continue;
+
+        for (int i = 0; i < g_RetainedLists.Size; i++)
+        {
+            const ImGui_ImplOpenGL3_RetainedList& retained = g_RetainedLists[i];
+            if (retained.DrawList == cmd_list && retained.VtxCount == cmd_list->VtxBuffer.Size && retained.IdxCount == cmd_list->IdxBuffer.Size)
+            {
+                for (int j = 0; j < g_DeclaredLists.Size; j++)
+                    if (g_DeclaredLists[j].DrawList == cmd_list && g_DeclaredLists[j].Version == retained.Version)
+                        g_ListSources[n] = i;
+                break;
+            }
+        }
+        if (g_ListSources[n] == -2)
+        {
+            upload_vtx_count += cmd_list->VtxBuffer.Size;
+            upload_idx_count += cmd_list->IdxBuffer.Size;
+        }
+    }
+
+    // Out of space: start over, uploading every declared list again (growing the buffers if needed).
+    if (g_RetainedVtxUsed + upload_vtx_count > g_RetainedVtxCapacity || g_RetainedIdxUsed + upload_idx_count > g_RetainedIdxCapacity)
+    {
+        upload_vtx_count = upload_idx_count = 0;
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+        {
+            if (g_ListSources[n] == -1)
+                continue;
+            g_ListSources[n] = -2;
+            upload_vtx_count += draw_data->CmdLists[n]->VtxBuffer.Size;
+            upload_idx_count += draw_data->CmdLists[n]->IdxBuffer.Size;
+        }
+        g_RetainedVtxUsed = g_RetainedIdxUsed = 0;
+
+        if (upload_vtx_count > g_RetainedVtxCapacity || upload_idx_count > g_RetainedIdxCapacity)
+        {
+            // Twice what is needed now, so panels that change now and then have room before the next restart.
+            if (g_RetainedVtxCapacity < 4096) g_RetainedVtxCapacity = 4096;
+            if (g_RetainedIdxCapacity < 8192) g_RetainedIdxCapacity = 8192;
+            while (g_RetainedVtxCapacity < upload_vtx_count * 2) g_RetainedVtxCapacity *= 2;
+            while (g_RetainedIdxCapacity < upload_idx_count * 2) g_RetainedIdxCapacity *= 2;
+
+            if (g_RetainedVertexArray == 0)
+            {
+                glGenBuffers(1, &g_RetainedVboHandle);
+                glGenBuffers(1, &g_RetainedElementsHandle);
+                glGenVertexArrays(1, &g_RetainedVertexArray);
+                ImGui_ImplOpenGL3_BindVertexArray(g_RetainedVertexArray);
+                ImGui_ImplOpenGL3_BindArrayBuffer(g_RetainedVboHandle);
+                ImGui_ImplOpenGL3_SetupVertexAttribs(g_RetainedElementsHandle);
+                ImGui_ImplOpenGL3_BindVertexArray(vertex_array_object);
+            }
+            // Same names, so the VAO stays valid; uses GL_ARRAY_BUFFER for both like the stream buffers.
+            ImGui_ImplOpenGL3_BindArrayBuffer(g_RetainedVboHandle);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)g_RetainedVtxCapacity * sizeof(ImDrawVert), NULL, GL_STATIC_DRAW);
+            ImGui_ImplOpenGL3_BindArrayBuffer(g_RetainedElementsHandle);
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)g_RetainedIdxCapacity * sizeof(ImDrawIdx), NULL, GL_STATIC_DRAW);
+        }
+    }
+
+    // Only what this frame draws is kept; the space of the rest is reclaimed at the next restart.
+    ImVector<ImGui_ImplOpenGL3_RetainedList> kept;
+    kept.reserve(g_RetainedLists.Size);
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (g_ListSources[n] == -1)
+            continue;
+        if (g_ListSources[n] >= 0)
+        {
+            kept.push_back(g_RetainedLists[g_ListSources[n]]);
+            g_RetainedReused++;
+        }
+        else
+        {
+            ImGui_ImplOpenGL3_RetainedList retained = { cmd_list, 0, g_RetainedVtxUsed, g_RetainedIdxUsed, cmd_list->VtxBuffer.Size, cmd_list->IdxBuffer.Size };
+            for (int i = 0; i < g_DeclaredLists.Size; i++)
+                if (g_DeclaredLists[i].DrawList == cmd_list)
+                    retained.Version = g_DeclaredLists[i].Version;
+            ImGui_ImplOpenGL3_BindArrayBuffer(g_RetainedVboHandle);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)retained.VtxOffset * sizeof(ImDrawVert), (GLsizeiptr)retained.VtxCount * sizeof(ImDrawVert), cmd_list->VtxBuffer.Data);
+            ImGui_ImplOpenGL3_BindArrayBuffer(g_RetainedElementsHandle);
+            glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)retained.IdxOffset * sizeof(ImDrawIdx), (GLsizeiptr)retained.IdxCount * sizeof(ImDrawIdx), cmd_list->IdxBuffer.Data);
+            g_RetainedVtxUsed += retained.VtxCount;
+            g_RetainedIdxUsed += retained.IdxCount;
+            kept.push_back(retained);
+            g_RetainedUploaded++;
+        }
+        g_ListSources[n] = kept.Size - 1;
+    }
+    g_RetainedLists.swap(kept);
+    ImGui_ImplOpenGL3_BindArrayBuffer(g_VboHandle);
+}
+#endif
+
+// Fill 'state' by querying the driver. This is what the host state mode avoids: each glGet may sync with the driver thread.
+static void ImGui_ImplOpenGL3_QueryState(ImGui_ImplOpenGL3_HostState* state)
+{
+    glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&state->ActiveTexture);
+    glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&state->Program);
     glActiveTexture(GL_TEXTURE0);
-    GLint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, &last_program);
-    GLint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, &last_texture);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&state->Texture2D);
 #ifdef GL_SAMPLER_BINDING
-    GLint last_sampler; glGetIntegerv(GL_SAMPLER_BINDING, &last_sampler);
+    glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&state->Sampler);
 #endif
-    GLint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &last_array_buffer);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&state->ArrayBuffer);
 #ifndef IMGUI_IMPL_OPENGL_ES2
-    GLint last_vertex_array_object; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &last_vertex_array_object);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&state->VertexArray);
 #endif
 #ifdef GL_POLYGON_MODE
-    GLint last_polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode);
-#endif
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-    bool clip_origin_lower_left = true;
+    GLint polygon_mode[2]; glGetIntegerv(GL_POLYGON_MODE, polygon_mode);
+    state->PolygonMode = (unsigned int)polygon_mode[0];
+#endif
+    glGetIntegerv(GL_VIEWPORT, state->Viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, state->ScissorBox);
+    glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&state->BlendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&state->BlendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&state->BlendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&state->BlendDstAlpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&state->BlendEquationRgb);
+    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&state->BlendEquationAlpha);
+    state->EnableBlend = glIsEnabled(GL_BLEND) == GL_TRUE;
+    state->EnableCullFace = glIsEnabled(GL_CULL_FACE) == GL_TRUE;
+    state->EnableDepthTest = glIsEnabled(GL_DEPTH_TEST) == GL_TRUE;
+    state->EnableScissorTest = glIsEnabled(GL_SCISSOR_TEST) == GL_TRUE;
+    state->ClipOriginLowerLeft = true;
 #if defined(GL_CLIP_ORIGIN) && !defined(__APPLE__)
     GLenum last_clip_origin = 0; glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&last_clip_origin); // Support for GL 4.5's glClipControl(GL_UPPER_LEFT)
     if (last_clip_origin == GL_UPPER_LEFT)
-        clip_origin_lower_left = false;
+        state->ClipOriginLowerLeft = false;
 #endif
+}
+
+// Only what we actually changed gets restored.
+static void ImGui_ImplOpenGL3_RestoreState(const ImGui_ImplOpenGL3_HostState* state)
+{
+    ImGui_ImplOpenGL3_UseProgram(state->Program);
+    ImGui_ImplOpenGL3_BindTexture(state->Texture2D);
+#ifdef GL_SAMPLER_BINDING
+    ImGui_ImplOpenGL3_BindSampler(state->Sampler);
+#endif
+    ImGui_ImplOpenGL3_ActiveTexture(state->ActiveTexture);
+#ifndef IMGUI_IMPL_OPENGL_ES2
+    ImGui_ImplOpenGL3_BindVertexArray(state->VertexArray);
+#endif
+    ImGui_ImplOpenGL3_BindArrayBuffer(state->ArrayBuffer);
+    ImGui_ImplOpenGL3_BlendEquation(state->BlendEquationRgb, state->BlendEquationAlpha);
+    ImGui_ImplOpenGL3_BlendFunc(state->BlendSrcRgb, state->BlendDstRgb, state->BlendSrcAlpha, state->BlendDstAlpha);
+    ImGui_ImplOpenGL3_SetEnabled(GL_BLEND, &g_BoundState.EnableBlend, state->EnableBlend);
+    ImGui_ImplOpenGL3_SetEnabled(GL_CULL_FACE, &g_BoundState.EnableCullFace, state->EnableCullFace);
+    ImGui_ImplOpenGL3_SetEnabled(GL_DEPTH_TEST, &g_BoundState.EnableDepthTest, state->EnableDepthTest);
+    ImGui_ImplOpenGL3_SetEnabled(GL_SCISSOR_TEST, &g_BoundState.EnableScissorTest, state->EnableScissorTest);
+#ifdef GL_POLYGON_MODE
+    ImGui_ImplOpenGL3_PolygonMode((GLenum)state->PolygonMode);
+#endif
+    ImGui_ImplOpenGL3_Viewport(state->Viewport[0], state->Viewport[1], state->Viewport[2], state->Viewport[3]);
+    ImGui_ImplOpenGL3_Scissor(state->ScissorBox[0], state->ScissorBox[1], state->ScissorBox[2], state->ScissorBox[3]);
+}
+
+// OpenGL3 Render function.
+// (this used to be set in io.RenderDrawListsFn and called by ImGui::Render(), but you can now call this directly from your main loop)
+// Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly, in order to be able to run within any OpenGL engine that doesn't do so.
+void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
+{
+    // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
+    int fb_width = (int)(draw_data->DisplaySize.x * draw_data->FramebufferScale.x);
+    int fb_height = (int)(draw_data->DisplaySize.y * draw_data->FramebufferScale.y);
+    if (fb_width <= 0 || fb_height <= 0)
+        return;
+
+    // Backup GL state
+    g_StateCallsIssued = g_StateCallsFiltered = 0;
+    ImGui_ImplOpenGL3_HostState last_state;
+    if (g_HostState != NULL)
+    {
+        last_state = *g_HostState;
+        g_BoundState = last_state;
+        g_BoundStateKnown = true;
+        ImGui_ImplOpenGL3_ActiveTexture(GL_TEXTURE0);
+    }
+    else
+    {
+        ImGui_ImplOpenGL3_QueryState(&last_state);
+        g_BoundState = last_state;
+        g_BoundState.ActiveTexture = GL_TEXTURE0;   // Set by ImGui_ImplOpenGL3_QueryState()
+        g_BoundStateKnown = true;
+    }
+    const bool clip_origin_lower_left = last_state.ClipOriginLowerLeft;
 
     // Setup desired GL state
     // Recreate the VAO every time (this is to easily allow multiple GL contexts to be rendered to. VAO are not shared among GL contexts)
     // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
+    // In host state mode the host renders from a single context, so one VAO is kept alive instead.
     GLuint vertex_array_object = 0;
 #ifndef IMGUI_IMPL_OPENGL_ES2
-    glGenVertexArrays(1, &vertex_array_object);
+    if (g_HostState != NULL)
+    {
+        if (g_VertexArrayObject == 0)
+        {
+            glGenVertexArrays(1, &g_VertexArrayObject);
+            g_VertexArrayDirty = true;
+        }
+        vertex_array_object = g_VertexArrayObject;
+    }
+    else
+    {
+        glGenVertexArrays(1, &vertex_array_object);
+    }
+#endif
+
+    // Grow the stream buffers before they get bound to the VAO.
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    if (g_StreamingUpload && (draw_data->TotalVtxCount > g_StreamVtxCapacity || draw_data->TotalIdxCount > g_StreamIdxCapacity))
+    {
+        ImGui_ImplOpenGL3_CreateStreamBuffers(draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+        g_BoundState.ArrayBuffer = g_UnknownBinding;
+    }
 #endif
     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
 
+    // Upload all vertex/index buffers at once
+    int stream_vtx_offset = 0;  // Where the current draw list starts in the streamed buffers, in elements
+    int stream_idx_offset = 0;
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    if (g_StreamingUpload && g_HostState != NULL && g_DeclaredLists.Size > 0)
+        ImGui_ImplOpenGL3_UpdateRetained(draw_data, vertex_array_object);
+    else
+    {
+        g_ListSources.resize(0);
+        g_RetainedReused = g_RetainedUploaded = 0;
+    }
+    if (g_StreamingUpload)
+        ImGui_ImplOpenGL3_UploadStreamed(draw_data, &stream_vtx_offset, &stream_idx_offset);
+#endif
+
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
@@ -282,8 +827,29 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
 
         // Upload vertex/index buffers
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+        if (!g_StreamingUpload)
+        {
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+        }
+
+        // Retained lists are drawn from their own buffers, where they start at their own offsets
+        int list_vtx_offset = stream_vtx_offset;
+        int list_idx_offset = stream_idx_offset;
+        GLuint list_vertex_array = vertex_array_object;
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+        const bool retained = n < g_ListSources.Size && g_ListSources[n] >= 0;
+        if (retained)
+        {
+            list_vtx_offset = g_RetainedLists[g_ListSources[n]].VtxOffset;
+            list_idx_offset = g_RetainedLists[g_ListSources[n]].IdxOffset;
+            list_vertex_array = g_RetainedVertexArray;
+        }
+        if (g_ListSources.Size > 0)
+            ImGui_ImplOpenGL3_BindVertexArray(list_vertex_array);
+#else
+        const bool retained = false;
+#endif
 
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
@@ -293,66 +859,85 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                {
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+                    if (g_ListSources.Size > 0)
+                        ImGui_ImplOpenGL3_BindVertexArray(list_vertex_array);
+#endif
+                }
                 else
+                {
                     pcmd->UserCallback(cmd_list, pcmd);
+                    g_BoundStateKnown = false;
+                }
             }
             else
             {
+                // Only what overlaps the damaged area gets drawn again
+                ImVec4 cmd_clip_rect = pcmd->ClipRect;
+                if (g_HasDamageRect)
+                {
+                    if (cmd_clip_rect.x < g_DamageRect.x) cmd_clip_rect.x = g_DamageRect.x;
+                    if (cmd_clip_rect.y < g_DamageRect.y) cmd_clip_rect.y = g_DamageRect.y;
+                    if (cmd_clip_rect.z > g_DamageRect.z) cmd_clip_rect.z = g_DamageRect.z;
+                    if (cmd_clip_rect.w > g_DamageRect.w) cmd_clip_rect.w = g_DamageRect.w;
+                    if (cmd_clip_rect.x >= cmd_clip_rect.z || cmd_clip_rect.y >= cmd_clip_rect.w)
+                        continue;
+                }
+
                 // Project scissor/clipping rectangles into framebuffer space
                 ImVec4 clip_rect;
-                clip_rect.x = (pcmd->ClipRect.x - clip_off.x) * clip_scale.x;
-                clip_rect.y = (pcmd->ClipRect.y - clip_off.y) * clip_scale.y;
-                clip_rect.z = (pcmd->ClipRect.z - clip_off.x) * clip_scale.x;
-                clip_rect.w = (pcmd->ClipRect.w - clip_off.y) * clip_scale.y;
+                clip_rect.x = (cmd_clip_rect.x - clip_off.x) * clip_scale.x;
+                clip_rect.y = (cmd_clip_rect.y - clip_off.y) * clip_scale.y;
+                clip_rect.z = (cmd_clip_rect.z - clip_off.x) * clip_scale.x;
+                clip_rect.w = (cmd_clip_rect.w - clip_off.y) * clip_scale.y;
 
                 if (clip_rect.x < fb_width && clip_rect.y < fb_height && clip_rect.z >= 0.0f && clip_rect.w >= 0.0f)
                 {
                     // Apply scissor/clipping rectangle
                     if (clip_origin_lower_left)
-                        glScissor((int)clip_rect.x, (int)(fb_height - clip_rect.w), (int)(clip_rect.z - clip_rect.x), (int)(clip_rect.w - clip_rect.y));
+                        ImGui_ImplOpenGL3_Scissor((int)clip_rect.x, (int)(fb_height - clip_rect.w), (int)(clip_rect.z - clip_rect.x), (int)(clip_rect.w - clip_rect.y));
                     else
-                        glScissor((int)clip_rect.x, (int)clip_rect.y, (int)clip_rect.z, (int)clip_rect.w); // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
+                        ImGui_ImplOpenGL3_Scissor((int)clip_rect.x, (int)clip_rect.y, (int)clip_rect.z, (int)clip_rect.w); // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
 
                     // Bind texture, Draw
-                    glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
+                    ImGui_ImplOpenGL3_BindTexture((GLuint)(intptr_t)pcmd->TextureId);
 #if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
-                    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset);
+                    glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)((list_idx_offset + pcmd->IdxOffset) * sizeof(ImDrawIdx)), (GLint)(list_vtx_offset + pcmd->VtxOffset));
 #else
                     glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)));
 #endif
                 }
             }
         }
+
+        if (g_StreamingUpload && !retained)
+        {
+            stream_vtx_offset += cmd_list->VtxBuffer.Size;
+            stream_idx_offset += cmd_list->IdxBuffer.Size;
+        }
     }
 
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    if (g_StreamingUpload && g_StreamPersistent)
+    {
+        g_StreamFences[g_StreamRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        g_StreamRegion = (g_StreamRegion + 1) % IMGUI_IMPL_OPENGL_STREAM_FRAMES;
+    }
+#endif
+
     // Destroy the temporary VAO
 #ifndef IMGUI_IMPL_OPENGL_ES2
-    glDeleteVertexArrays(1, &vertex_array_object);
+    if (vertex_array_object != g_VertexArrayObject)
+        glDeleteVertexArrays(1, &vertex_array_object);
 #endif
 
     // Restore modified GL state
-    glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-#ifdef GL_SAMPLER_BINDING
-    glBindSampler(0, last_sampler);
-#endif
-    glActiveTexture(last_active_texture);
-#ifndef IMGUI_IMPL_OPENGL_ES2
-    glBindVertexArray(last_vertex_array_object);
-#endif
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-#ifdef GL_POLYGON_MODE
-    glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]);
-#endif
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+    ImGui_ImplOpenGL3_RestoreState(&last_state);
+    g_BoundStateKnown = false;
+    g_LastStateCallsIssued = g_StateCallsIssued;
+    g_LastStateCallsFiltered = g_StateCallsFiltered;
 }
 
 bool ImGui_ImplOpenGL3_CreateFontsTexture()
@@ -596,8 +1181,27 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
     g_AttribLocationVtxColor = glGetAttribLocation(g_ShaderHandle, "Color");
 
     // Create buffers
-    glGenBuffers(1, &g_VboHandle);
-    glGenBuffers(1, &g_ElementsHandle);
+    g_VertexArrayDirty = true;
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    if (g_StreamingUpload)
+    {
+        // Persistent mapping needs glBufferStorage (GL 4.4 / GL_ARB_buffer_storage).
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+#ifdef GL_MAP_PERSISTENT_BIT
+        g_StreamPersistent = (major > 4 || (major == 4 && minor >= 4)) && glBufferStorage != NULL;
+#else
+        g_StreamPersistent = false;
+#endif
+        ImGui_ImplOpenGL3_CreateStreamBuffers(0, 0);
+    }
+    else
+#endif
+    {
+        glGenBuffers(1, &g_VboHandle);
+        glGenBuffers(1, &g_ElementsHandle);
+    }
 
     ImGui_ImplOpenGL3_CreateFontsTexture();
 
@@ -613,6 +1217,10 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 
 void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
 {
+#if IMGUI_IMPL_OPENGL_HAS_DRAW_WITH_BASE_VERTEX
+    ImGui_ImplOpenGL3_DestroyStreamBuffers();
+    ImGui_ImplOpenGL3_DestroyRetainedBuffers();
+#endif
     if (g_VboHandle) glDeleteBuffers(1, &g_VboHandle);
     if (g_ElementsHandle) glDeleteBuffers(1, &g_ElementsHandle);
     g_VboHandle = g_ElementsHandle = 0;
@@ -628,5 +1236,10 @@ void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
     if (g_ShaderHandle) glDeleteProgram(g_ShaderHandle);
     g_ShaderHandle = 0;
 
+#ifndef IMGUI_IMPL_OPENGL_ES2
+    if (g_VertexArrayObject) glDeleteVertexArrays(1, &g_VertexArrayObject);
+    g_VertexArrayObject = 0;
+#endif
+
     ImGui_ImplOpenGL3_DestroyFontsTexture();
 }
@@ -24,6 +24,14 @@
 #include IMGUI_IMPL_OPENGL_LOADER_CUSTOM
 #endif
 
+#include <memory>
+
+#include "ImGui/PartialRedraw.hpp"
+#include "ImGui/ProfilerWindow.hpp"
+#include "ImGui/RedrawScheduler.hpp"
+#include "ImGui/WindowCache.hpp"
+#include "Renderer/Profiler.hpp"
+
 // Include glfw3.h after our OpenGL definitions
 #include <GLFW/glfw3.h>
 
@@ -128,7 +136,20 @@ int main()
 
 	#if defined(IMGUI_IMPL_OPENGL_LOADER_GLEW)
 	bool err = glewInit() != GLEW_OK;
+	#elif defined(IMGUI_IMPL_OPENGL_LOADER_GLAD)
+	bool err = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) == 0;
 	#endif
+	if (err)
+	{
+		std::cout << "Failed to initialize OpenGL loader" << std::endl;
+		return -1;
+	}
+
+	/**
+	 * CPU and GPU time per zone: the whole frame, building the UI and rendering it. GPU times arrive a few frames late,
+	 * the profiler never waits for them.
+	 */
+	std::unique_ptr<Profiler> profiler(new Profiler());
 	 // Setup Dear ImGui context
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -144,9 +165,46 @@ int main()
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init(glsl_version);
 
+	/**
+	 * We know what is bound between frames (nothing but the defaults), so we hand that to the renderer instead of letting it
+	 * query ~20 values from the driver every frame. It has to stay true: update it whenever we change one of these ourselves.
+	 */
+	ImGui_ImplOpenGL3_HostState gl_state;
+	gl_state.Program = 0;
+	gl_state.Texture2D = 0;
+	gl_state.Sampler = 0;
+	gl_state.ArrayBuffer = 0;
+	gl_state.VertexArray = 0;
+	gl_state.ActiveTexture = GL_TEXTURE0;
+	gl_state.PolygonMode = GL_FILL;
+	glGetIntegerv(GL_VIEWPORT, gl_state.Viewport);
+	glGetIntegerv(GL_SCISSOR_BOX, gl_state.ScissorBox);
+	gl_state.BlendSrcRgb = gl_state.BlendSrcAlpha = GL_ONE;
+	gl_state.BlendDstRgb = gl_state.BlendDstAlpha = GL_ZERO;
+	gl_state.BlendEquationRgb = gl_state.BlendEquationAlpha = GL_FUNC_ADD;
+	gl_state.EnableBlend = gl_state.EnableCullFace = gl_state.EnableDepthTest = gl_state.EnableScissorTest = false;
+	gl_state.ClipOriginLowerLeft = true;
+	ImGui_ImplOpenGL3_SetHostState(&gl_state);
+
+	/**
+	 * An unchanged UI doesn't need new frames: the scheduler sleeps until an event, an animation or an invalidate() asks for one,
+	 * and frames whose draw data didn't change aren't drawn nor swapped. With partial redraw the UI lives in a framebuffer of its own
+	 * and only the part that changed is drawn again. Installed after ImGui's GLFW callbacks, it chains to them.
+	 */
+	std::unique_ptr<RedrawScheduler> scheduler(new RedrawScheduler(window));
+	std::unique_ptr<PartialRedraw> redraw(new PartialRedraw());
+	unsigned long long frames_presented = 0;
+
+	// Windows whose contents didn't change reuse last frame's draw list, and the renderer its uploaded copy.
+	std::unique_ptr<WindowCache> window_cache(new WindowCache());
+
 	// Our state
 	bool show_demo_window = true;
 	bool show_another_window = false;
+	bool show_profiler_window = true;
+	bool idle_when_unchanged = scheduler->idle();
+	bool partial_redraw = false;
+	bool retain_windows = window_cache->enabled();
 	ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
 	/**
@@ -161,14 +219,20 @@ int main()
 	 */
 	while (!glfwWindowShouldClose(window))
 	{
-		// Input  ----- 
-		processInput(window);
-
 		/**
 		 * The glfwPollEvents function checks if any events are triggered (like keyboard input or mouse movement events),
 		 * updates the window state, and calls the corresponding functions (which we can set via callback methods).
+		 * The scheduler calls it too, then waits with glfwWaitEventsTimeout while no frame is needed.
 		 */
-		glfwPollEvents();
+		scheduler->waitForFrame();
+		if (glfwWindowShouldClose(window))
+			break;
+
+		// Input  ----- 
+		processInput(window);
+
+		profiler->beginFrame();
+		profiler->beginCpu("ImGui build");
 
 		// Start the Dear ImGui frame
 		ImGui_ImplOpenGL3_NewFrame();
@@ -189,6 +253,7 @@ int main()
 			ImGui::Text("This is some useful text.");               // Display some text (you can use a format strings too)
 			ImGui::Checkbox("Demo Window", &show_demo_window);      // Edit bools storing our window open/close state
 			ImGui::Checkbox("Another Window", &show_another_window);
+			ImGui::Checkbox("Profiler", &show_profiler_window);
 
 			ImGui::SliderFloat("float", &f, 0.0f, 1.0f);            // Edit 1 float using a slider from 0.0f to 1.0f
 			ImGui::ColorEdit3("clear color", (float*)& clear_color); // Edit 3 floats representing a color
@@ -199,29 +264,77 @@ int main()
 			ImGui::Text("counter = %d", counter);
 
 			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+			int state_calls_issued, state_calls_filtered;
+			ImGui_ImplOpenGL3_GetStateStats(&state_calls_issued, &state_calls_filtered);
+			ImGui::Text("GL state calls: %d issued, %d filtered", state_calls_issued, state_calls_filtered);
+
+			if (ImGui::Checkbox("Idle when unchanged", &idle_when_unchanged))
+				scheduler->setIdle(idle_when_unchanged);
+			ImGui::SameLine();
+			ImGui::Checkbox("Partial redraw", &partial_redraw);
+			if (ImGui::Checkbox("Retain unchanged windows", &retain_windows))
+				window_cache->setEnabled(retain_windows);
+			// Closed by default: text changing every frame would keep every frame from being skipped.
+			if (ImGui::TreeNode("Redraw stats"))
+			{
+				ImGui::Text("%llu frames built, %llu presented, %.1f s idle", scheduler->frames(), frames_presented, scheduler->idleTime());
+				ImGui::Text("Last damage: %.0f%% of the window", redraw->damagedFraction() * 100.0f);
+				int lists_reused, lists_uploaded;
+				ImGui_ImplOpenGL3_GetRetainStats(&lists_reused, &lists_uploaded);
+				ImGui::Text("Windows: %d reused, %d rebuilt; draw lists: %d kept on the GPU, %d uploaded",
+				            window_cache->reused(), window_cache->rebuilt(), lists_reused, lists_uploaded);
+				ImGui::TreePop();
+			}
 			ImGui::End();
 		}
 
 		// 3. Show another simple window.
 		if (show_another_window)
 		{
-			ImGui::Begin("Another Window", &show_another_window);   // Pass a pointer to our bool variable (the window will have a closing button that will clear the bool when clicked)
-			ImGui::Text("Hello from another window!");
-			if (ImGui::Button("Close Me"))
-				show_another_window = false;
-			ImGui::End();
+			// Nothing it shows changes, so its content hash is a constant: unless hovered or moved it is restored from the cache.
+			if (window_cache->begin("Another Window", 0, &show_another_window)) // Pass a pointer to our bool variable (the window will have a closing button that will clear the bool when clicked)
+			{
+				ImGui::Text("Hello from another window!");
+				if (ImGui::Button("Close Me"))
+					show_another_window = false;
+			}
+			window_cache->end();
 		}
 
-
+		// 4. Where the frame time goes.
+		if (show_profiler_window)
+			ShowProfilerWindow(*profiler, &show_profiler_window);
 
 		// Render ----- 
 		ImGui::Render();
+		profiler->endCpu();
 		int display_w, display_h;
 		glfwGetFramebufferSize(window, &display_w, &display_h);
-		glViewport(0, 0, display_w, display_h);
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		if (gl_state.Viewport[2] != display_w || gl_state.Viewport[3] != display_h)
+		{
+			glViewport(0, 0, display_w, display_h);
+			gl_state.Viewport[0] = gl_state.Viewport[1] = 0;
+			gl_state.Viewport[2] = display_w;
+			gl_state.Viewport[3] = display_h;
+		}
+
+		// Same draw data as the frame on screen: nothing to draw, the window keeps showing it.
+		ImDrawData* draw_data = ImGui::GetDrawData();
+		bool changed = redraw->update(draw_data);
+		bool present = !scheduler->idle() || changed || scheduler->windowDamaged();
+		if (present)
+		{
+			GpuProfileScope scope(*profiler, "ImGui render");
+			if (partial_redraw)
+				redraw->render(draw_data, ImVec4(0.2f, 0.3f, 0.3f, 1.0f), gl_state);
+			else
+			{
+				glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+				glClear(GL_COLOR_BUFFER_BIT);
+				ImGui_ImplOpenGL3_RenderDrawData(draw_data);
+			}
+		}
 
 		/**
 		 * glfwSwapBuffers will swap the color buffer (a large buffer that contains color values for each pixel in GLFW's window)
@@ -230,10 +343,20 @@ int main()
 		 * @param[GLFWwindow]
 		 *      Take the window object as argument.
 		 */
-		glfwSwapBuffers(window);
+		if (present)
+		{
+			glfwSwapBuffers(window);
+			++frames_presented;
+		}
+		scheduler->endFrame(present);
+		profiler->endFrame();
 	}
 
 	// Cleanup
+	redraw.reset();
+	scheduler.reset();
+	profiler.reset();
+	ImGui_ImplOpenGL3_SetHostState(NULL);
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
@@ -0,0 +1,135 @@
+#ifndef __FRAME_LOOP_HPP_INCLUDED__
+#define __FRAME_LOOP_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Harness/FrameRunner.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+class GLContext;
+
+enum class PresentMode
+{
+    VSync,          // Swap interval 1.
+    Adaptive,       // Swap interval -1: vsync, but a late frame tears instead of waiting a whole refresh.
+                    // Needs (WGL|GLX)_EXT_swap_control_tear, otherwise the same as VSync.
+    Uncapped,       // Swap interval 0.
+    FixedTimestep   // VSync presentation with updates at a fixed rate, rendering interpolates between them.
+};
+
+const char* presentModeName(PresentMode mode);
+// "vsync", "adaptive", "uncapped", "fixed"; false for anything else.
+bool parsePresentMode(const std::string &name, PresentMode &mode);
+
+struct FrameLoopSettings
+{
+    PresentMode  mode;
+    double       fixedStep;          // Seconds per update in FixedTimestep.
+    unsigned int maxStepsPerFrame;   // Updates one frame may catch up on before time is dropped.
+    unsigned int maxFramesInFlight;  // Frames queued on the GPU before the CPU waits; 0 leaves it to the driver.
+
+    FrameLoopSettings() : mode(PresentMode::VSync), fixedStep(1.0 / 60.0), maxStepsPerFrame(5), maxFramesInFlight(2) {}
+};
+
+// Milliseconds over the last FrameLoop::HISTORY frames; latency is from input sampling to the
+// GPU finishing the frame's swap, as far as GL can see it (the compositor and the display itself
+// come on top). The throttling counters are since the loop started.
+struct FrameLoopStats
+{
+    FrameTimings frameTimes;
+    FrameTimings latency;
+    unsigned int throttledFrames;    // Frames that had to wait for an older one to leave the GPU.
+    double       throttledTime;
+};
+
+// The render loop shared by the applications. Each frame:
+//
+//   1. wait until fewer than maxFramesInFlight frames are still on the GPU (glFenceSync after
+//      every swap), so the driver can't queue frames up and add their latency and jitter;
+//   2. poll events and call the input callback only now, as late as possible before submitting;
+//   3. update: once with the real frame time, or in FixedTimestep as many fixed steps as the
+//      elapsed time covers;
+//   4. render, with the interpolation factor between the last two fixed steps (1 otherwise);
+//   5. swap, then fence and timestamp the frame to measure its input to present latency.
+//
+// Latency comes from a GL_TIMESTAMP query behind the swap when the context has GL 3.3, else
+// from when the fence is seen signaled. Without GL 3.2 fences there is no frame limit either.
+// ----------------------------------------------------------------------------------------
+class FrameLoop
+{
+public:
+    static const unsigned int HISTORY = 240;
+
+    explicit FrameLoop(GLContext &context, const FrameLoopSettings &settings = FrameLoopSettings());
+    ~FrameLoop();
+
+    FrameLoop(const FrameLoop&) = delete;
+    FrameLoop& operator=(const FrameLoop&) = delete;
+
+    void setMode(PresentMode mode);
+    PresentMode mode() const { return settings.mode; }
+    bool adaptiveSupported() const { return adaptive; }
+    void setMaxFramesInFlight(unsigned int frames) { settings.maxFramesInFlight = frames; }
+
+    // Any may be left empty.
+    void onInput(const std::function<void()> &callback) { input = callback; }
+    void onUpdate(const std::function<void(double seconds)> &callback) { update = callback; }
+    void onRender(const std::function<void(double alpha)> &callback) { render = callback; }
+
+    // Frames until the window is asked to close.
+    void run();
+    void frame();
+
+    FrameLoopStats stats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct InFlight
+    {
+        GLsync            fence;
+        GLuint            query;
+        Clock::time_point input;
+    };
+
+    void applySwapInterval();
+    // Blocks until the oldest frame is done with 'wait', otherwise only takes finished ones.
+    void retire(bool wait);
+    void addSample(std::vector<double> &samples, std::size_t &next, double milliseconds);
+    double millisecondsSince(Clock::time_point start, Clock::time_point end) const;
+
+private:
+    GLContext        &context;
+    FrameLoopSettings settings;
+    bool              fences;
+    bool              timerQueries;
+    bool              adaptive;
+
+    std::function<void()>       input;
+    std::function<void(double)> update;
+    std::function<void(double)> render;
+
+    std::deque<InFlight> inFlight;
+    std::vector<GLuint>  freeQueries;
+
+    bool              started;
+    Clock::time_point lastInput;
+    double            accumulator;    // Seconds not yet covered by fixed steps.
+    std::int64_t      gpuOffset;      // CPU minus GPU nanoseconds.
+    Clock::time_point epoch;
+
+    std::vector<double> frameTimes;
+    std::vector<double> latencies;
+    std::size_t         nextFrameTime;
+    std::size_t         nextLatency;
+    unsigned int        throttledFrames;
+    double              throttledTime;
+};
+
+#endif // !__FRAME_LOOP_HPP_INCLUDED__
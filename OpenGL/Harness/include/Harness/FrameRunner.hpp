@@ -0,0 +1,87 @@
+#ifndef __FRAME_RUNNER_HPP_INCLUDED__
+#define __FRAME_RUNNER_HPP_INCLUDED__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Milliseconds per measured frame, GPU work included.
+struct FrameTimings
+{
+    unsigned int frames;
+    double       total;
+    double       min;
+    double       average;
+    double       median;
+    double       p99;
+    double       max;
+};
+
+// Summary of any list of per frame milliseconds; all zero when empty.
+FrameTimings summarizeFrameTimes(const std::vector<double> &milliseconds);
+
+// Renders a fixed number of frames as fast as it can, for runs that have to be repeatable: no
+// window events, no vsync, and frame N is always handed the same number whatever the clock says,
+// so animations have to be driven by it rather than by glfwGetTime(). Each frame ends in glFinish()
+// and the time includes it, which makes one frame the whole CPU + GPU cost of that frame instead of
+// however much the driver happened to queue up. The first 'warmup' frames (shader compiles, first
+// uploads) run but aren't measured.
+// ---------------------------------------------------------------------------------------------
+class FrameRunner
+{
+public:
+    FrameRunner(unsigned int frames, unsigned int warmup = 10);
+
+    // Frames are numbered from 0, warmup included.
+    FrameTimings run(const std::function<void(unsigned int frame)> &renderFrame);
+
+    // Every measured frame of the last run, in order.
+    const std::vector<double>& samples() const { return times; }
+
+private:
+    unsigned int        frames;
+    unsigned int        warmup;
+    std::vector<double> times;
+};
+
+// What the applications accept on the command line for headless runs; without --headless the
+// rest of these are ignored:
+//
+//   --headless          no window, render into an offscreen target
+//   --frames N          fixed frame run of N frames, default 300
+//   --warmup N          unmeasured frames before those, default 10
+//   --size WxH          offscreen target size, default the window size
+//   --dump FILE.tga     write the last frame
+//   --compare FILE.tga  compare the last frame against a reference, fail on a mismatch
+//   --tolerance N       per channel difference still counted as equal, default 0
+//   --report FILE.json  write the frame timings
+//
+// and for windowed runs, see FrameLoop:
+//
+//   --present MODE        vsync (default), adaptive, uncapped or fixed
+//   --frames-in-flight N  GPU queue depth before the CPU waits, default 2, 0 for no limit
+// ---------------------------------------------------------------------------------------------
+struct RunSettings
+{
+    bool         headless;
+    unsigned int frames;
+    unsigned int warmup;
+    int          width;         // 0 keeps the application's own size.
+    int          height;
+    std::string  dumpPath;
+    std::string  comparePath;
+    int          tolerance;
+    std::string  reportPath;
+    std::string  presentMode;       // Checked by parseRunSettings, see parsePresentMode().
+    unsigned int framesInFlight;
+
+    RunSettings() : headless(false), frames(300), warmup(10), width(0), height(0), tolerance(0), presentMode("vsync"), framesInFlight(2) {}
+};
+
+// False on an unknown or malformed argument, after printing the usage.
+bool parseRunSettings(int argc, char** argv, RunSettings &settings);
+
+// JSON: the settings of the run, the backend and renderer, and the timings.
+bool writeFrameTimings(const std::string &path, const FrameTimings &timings, const std::string &backend);
+
+#endif // !__FRAME_RUNNER_HPP_INCLUDED__
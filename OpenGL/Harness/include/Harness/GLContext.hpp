@@ -0,0 +1,77 @@
+#ifndef __GL_CONTEXT_HPP_INCLUDED__
+#define __GL_CONTEXT_HPP_INCLUDED__
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <string>
+
+struct ContextSettings
+{
+    int         width;
+    int         height;
+    std::string title;
+    bool        headless;
+    bool        vsync;      // Windowed only.
+    int         major;
+    int         minor;
+
+    ContextSettings() : width(800), height(600), title("LearnGP"), headless(false), vsync(true), major(3), minor(3) {}
+};
+
+// A current GL context with GLAD loaded, in a window or without any display at all. Headless
+// tries, in order:
+//
+//   EGL surfaceless    (Linux, Mesa; llvmpipe when there is no GPU)
+//   hidden GLFW window (which is an OSMesa context when GLFW is built with GLFW_USE_OSMESA,
+//                       see LEARNGP_HEADLESS in the top level CMakeLists.txt)
+//   GLFW's OSMesa context API on the native platform
+//
+// A headless context has no default framebuffer worth reading, so render into a RenderTarget.
+// --------------------------------------------------------------------------------------------
+class GLContext
+{
+public:
+    GLContext();
+    ~GLContext();
+
+    GLContext(const GLContext&) = delete;
+    GLContext& operator=(const GLContext&) = delete;
+
+    bool create(const ContextSettings &settings);
+    void destroy();
+
+    bool isValid() const { return backendName != nullptr; }
+    bool headless() const { return isHeadless; }
+    // Which of the ways above made the context, for logs and reports.
+    const char* backend() const { return backendName ? backendName : "none"; }
+
+    // Null when headless over EGL.
+    GLFWwindow* window() const { return glfwWindow; }
+    // The backend's GetProcAddress, for extension loaders.
+    GLADloadproc loader() const { return procAddress; }
+
+    // No-ops without a window; shouldClose() is then always false.
+    bool shouldClose() const;
+    void swapBuffers();
+    void pollEvents();
+
+private:
+    bool createWindow(const ContextSettings &settings, bool visible, int creationApi);
+    bool createEgl(const ContextSettings &settings);
+    void destroyEgl();
+
+private:
+    GLFWwindow* glfwWindow;
+    bool        glfwStarted;
+    bool        isHeadless;
+    const char* backendName;
+    GLADloadproc procAddress;
+
+    // EGL objects, kept opaque so the header doesn't need EGL.
+    void* eglLibrary;
+    void* eglDisplay;
+    void* eglContext;
+};
+
+#endif // !__GL_CONTEXT_HPP_INCLUDED__
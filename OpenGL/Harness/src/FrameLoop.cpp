@@ -0,0 +1,235 @@
+#include "Harness/FrameLoop.hpp"
+
+#include "Harness/GLContext.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    const GLuint64 WAIT_TIMEOUT = 1000000000;   // 1 s per glClientWaitSync, retried while the GPU is busy.
+}
+
+const char* presentModeName(PresentMode mode)
+{
+    switch(mode)
+    {
+    case PresentMode::VSync:         return "vsync";
+    case PresentMode::Adaptive:      return "adaptive";
+    case PresentMode::Uncapped:      return "uncapped";
+    case PresentMode::FixedTimestep: return "fixed";
+    }
+    return "vsync";
+}
+
+bool parsePresentMode(const std::string &name, PresentMode &mode)
+{
+    const PresentMode modes[] = { PresentMode::VSync, PresentMode::Adaptive, PresentMode::Uncapped, PresentMode::FixedTimestep };
+    for(PresentMode candidate : modes)
+    {
+        if(name == presentModeName(candidate))
+        {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+FrameLoop::FrameLoop(GLContext &context, const FrameLoopSettings &settings)
+    : context(context), settings(settings), fences(GLAD_GL_VERSION_3_2 != 0), timerQueries(GLAD_GL_VERSION_3_3 != 0), adaptive(false),
+      started(false), accumulator(0.0), gpuOffset(0), epoch(Clock::now()),
+      nextFrameTime(0), nextLatency(0), throttledFrames(0), throttledTime(0.0)
+{
+    if(context.window())
+        adaptive = glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+
+    if(timerQueries)
+    {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuOffset = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count() - gpuNow;
+    }
+
+    applySwapInterval();
+}
+
+FrameLoop::~FrameLoop()
+{
+    for(std::size_t i = 0; i < inFlight.size(); ++i)
+    {
+        glDeleteSync(inFlight[i].fence);
+        if(inFlight[i].query)
+            glDeleteQueries(1, &inFlight[i].query);
+    }
+    if(!freeQueries.empty())
+        glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+}
+
+void FrameLoop::setMode(PresentMode mode)
+{
+    if(mode == PresentMode::FixedTimestep && settings.mode != PresentMode::FixedTimestep)
+        accumulator = 0.0;
+    settings.mode = mode;
+    applySwapInterval();
+}
+
+void FrameLoop::applySwapInterval()
+{
+    if(!context.window() || context.headless())
+        return;
+
+    switch(settings.mode)
+    {
+    case PresentMode::Adaptive: glfwSwapInterval(adaptive ? -1 : 1); break;
+    case PresentMode::Uncapped: glfwSwapInterval(0);                  break;
+    default:                    glfwSwapInterval(1);                  break;
+    }
+}
+
+// ------------------------------------------------------------------------
+void FrameLoop::run()
+{
+    while(!context.shouldClose())
+        frame();
+}
+
+void FrameLoop::frame()
+{
+    // 1. Keep the queue short, before input is sampled so the wait doesn't age it.
+    // ---------------------------------------------------------------------------
+    if(settings.maxFramesInFlight > 0)
+    {
+        Clock::time_point waitStart = Clock::now();
+        bool throttled = false;
+        while(inFlight.size() >= settings.maxFramesInFlight)
+        {
+            retire(true);
+            throttled = true;
+        }
+        if(throttled)
+        {
+            ++throttledFrames;
+            throttledTime += millisecondsSince(waitStart, Clock::now());
+        }
+    }
+    retire(false);
+
+    // 2. Late input.
+    // --------------
+    context.pollEvents();
+    if(input)
+        input();
+
+    Clock::time_point now = Clock::now();
+    double elapsed = started ? std::chrono::duration<double>(now - lastInput).count() : settings.fixedStep;
+    if(started)
+        addSample(frameTimes, nextFrameTime, elapsed * 1000.0);
+    started   = true;
+    lastInput = now;
+
+    // 3. Update, 4. render.
+    // ---------------------
+    if(settings.mode == PresentMode::FixedTimestep)
+    {
+        // A long stall (breakpoint, window drag) drops time rather than running a burst of steps.
+        accumulator = std::min(accumulator + elapsed, settings.fixedStep * settings.maxStepsPerFrame);
+        while(accumulator >= settings.fixedStep)
+        {
+            if(update)
+                update(settings.fixedStep);
+            accumulator -= settings.fixedStep;
+        }
+        if(render)
+            render(accumulator / settings.fixedStep);
+    }
+    else
+    {
+        if(update)
+            update(elapsed);
+        if(render)
+            render(1.0);
+    }
+
+    // 5. Present, then mark where the frame ends in the command stream.
+    // -----------------------------------------------------------------
+    context.swapBuffers();
+    if(!fences)
+        return;
+
+    InFlight frame = { 0, 0, now };
+    if(timerQueries)
+    {
+        if(freeQueries.empty())
+        {
+            GLuint query = 0;
+            glGenQueries(1, &query);
+            freeQueries.push_back(query);
+        }
+        frame.query = freeQueries.back();
+        freeQueries.pop_back();
+        glQueryCounter(frame.query, GL_TIMESTAMP);
+    }
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    inFlight.push_back(frame);
+}
+
+void FrameLoop::retire(bool wait)
+{
+    while(!inFlight.empty())
+    {
+        InFlight &oldest = inFlight.front();
+        GLenum status = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? WAIT_TIMEOUT : 0);
+        if(status == GL_TIMEOUT_EXPIRED && wait)
+            continue;
+        if(status == GL_TIMEOUT_EXPIRED)
+            return;
+
+        // Signaled (or the wait failed, which shouldn't keep the frame around forever).
+        Clock::time_point done = Clock::now();
+        if(status != GL_WAIT_FAILED)
+        {
+            double latency = millisecondsSince(oldest.input, done);
+            if(oldest.query)
+            {
+                GLuint64 gpuTime = 0;
+                glGetQueryObjectui64v(oldest.query, GL_QUERY_RESULT, &gpuTime);
+                std::int64_t inputTime = std::chrono::duration_cast<std::chrono::nanoseconds>(oldest.input - epoch).count();
+                latency = std::max<std::int64_t>((std::int64_t)gpuTime + gpuOffset - inputTime, 0) / 1e6;
+            }
+            addSample(latencies, nextLatency, latency);
+        }
+
+        glDeleteSync(oldest.fence);
+        if(oldest.query)
+            freeQueries.push_back(oldest.query);
+        inFlight.pop_front();
+
+        if(wait)
+            return;
+    }
+}
+
+// ------------------------------------------------------------------------
+void FrameLoop::addSample(std::vector<double> &samples, std::size_t &next, double milliseconds)
+{
+    if(samples.size() < HISTORY)
+        samples.push_back(milliseconds);
+    else
+        samples[next] = milliseconds;
+    next = (next + 1) % HISTORY;
+}
+
+double FrameLoop::millisecondsSince(Clock::time_point start, Clock::time_point end) const
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+FrameLoopStats FrameLoop::stats() const
+{
+    FrameLoopStats result;
+    result.frameTimes      = summarizeFrameTimes(frameTimes);
+    result.latency         = summarizeFrameTimes(latencies);
+    result.throttledFrames = throttledFrames;
+    result.throttledTime   = throttledTime;
+    return result;
+}
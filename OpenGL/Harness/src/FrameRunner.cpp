@@ -0,0 +1,182 @@
+#include "Harness/FrameRunner.hpp"
+
+#include "Harness/FrameLoop.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    double percentile(const std::vector<double> &sorted, unsigned int percent)
+    {
+        std::size_t rank = (sorted.size() * percent + 99) / 100;
+        return sorted[std::min(std::max(rank, (std::size_t)1), sorted.size()) - 1];
+    }
+
+    bool parseNumber(const char* text, unsigned int &value)
+    {
+        char* end = nullptr;
+        unsigned long number = std::strtoul(text, &end, 10);
+        if(end == text || *end != '\0')
+            return false;
+        value = (unsigned int)number;
+        return true;
+    }
+
+    void printUsage(const char* program)
+    {
+        std::cout << "Usage: " << program << " [--headless] [--frames N] [--warmup N] [--size WxH]\n"
+                  << "       [--dump FILE.tga] [--compare FILE.tga] [--tolerance N] [--report FILE.json]\n"
+                  << "       [--present vsync|adaptive|uncapped|fixed] [--frames-in-flight N]" << std::endl;
+    }
+
+    void writeEscaped(std::ofstream &out, const char* text)
+    {
+        for(; text && *text; ++text)
+        {
+            if(*text == '"' || *text == '\\')
+                out << '\\';
+            if((unsigned char)*text >= 0x20)
+                out << *text;
+        }
+    }
+}
+
+FrameRunner::FrameRunner(unsigned int frames, unsigned int warmup)
+    : frames(std::max(frames, 1u)), warmup(warmup)
+{
+
+}
+
+FrameTimings FrameRunner::run(const std::function<void(unsigned int frame)> &renderFrame)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    // Nothing queued before the run counts against its first frame.
+    glFinish();
+
+    times.clear();
+    times.reserve(frames);
+    for(unsigned int frame = 0; frame < warmup + frames; ++frame)
+    {
+        Clock::time_point start = Clock::now();
+        renderFrame(frame);
+        glFinish();
+        std::chrono::duration<double, std::milli> time = Clock::now() - start;
+
+        if(frame >= warmup)
+            times.push_back(time.count());
+    }
+
+    return summarizeFrameTimes(times);
+}
+
+FrameTimings summarizeFrameTimes(const std::vector<double> &milliseconds)
+{
+    FrameTimings timings = { (unsigned int)milliseconds.size(), 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if(milliseconds.empty())
+        return timings;
+
+    std::vector<double> sorted(milliseconds);
+    std::sort(sorted.begin(), sorted.end());
+
+    for(std::size_t i = 0; i < sorted.size(); ++i)
+        timings.total += sorted[i];
+    timings.min     = sorted.front();
+    timings.average = timings.total / sorted.size();
+    timings.median  = percentile(sorted, 50);
+    timings.p99     = percentile(sorted, 99);
+    timings.max     = sorted.back();
+    return timings;
+}
+
+// ------------------------------------------------------------------------
+bool parseRunSettings(int argc, char** argv, RunSettings &settings)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        const char* argument = argv[i];
+        const char* value    = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool valid = true;
+
+        if(std::strcmp(argument, "--headless") == 0)
+        {
+            settings.headless = true;
+            continue;
+        }
+
+        if(!value)
+            valid = false;
+        else if(std::strcmp(argument, "--frames") == 0)
+            valid = parseNumber(value, settings.frames) && settings.frames > 0;
+        else if(std::strcmp(argument, "--warmup") == 0)
+            valid = parseNumber(value, settings.warmup);
+        else if(std::strcmp(argument, "--size") == 0)
+            valid = std::sscanf(value, "%dx%d", &settings.width, &settings.height) == 2 && settings.width > 0 && settings.height > 0;
+        else if(std::strcmp(argument, "--dump") == 0)
+            settings.dumpPath = value;
+        else if(std::strcmp(argument, "--compare") == 0)
+            settings.comparePath = value;
+        else if(std::strcmp(argument, "--tolerance") == 0)
+        {
+            unsigned int tolerance = 0;
+            valid = parseNumber(value, tolerance) && tolerance <= 255;
+            settings.tolerance = (int)tolerance;
+        }
+        else if(std::strcmp(argument, "--report") == 0)
+            settings.reportPath = value;
+        else if(std::strcmp(argument, "--present") == 0)
+        {
+            PresentMode mode;
+            valid = parsePresentMode(value, mode);
+            settings.presentMode = value;
+        }
+        else if(std::strcmp(argument, "--frames-in-flight") == 0)
+            valid = parseNumber(value, settings.framesInFlight);
+        else
+            valid = false;
+
+        if(!valid)
+        {
+            std::cout << "ERROR::RUN_SETTINGS::INVALID_ARGUMENT " << argument << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+bool writeFrameTimings(const std::string &path, const FrameTimings &timings, const std::string &backend)
+{
+    std::ofstream out(path.c_str(), std::ios::trunc);
+
+    out << "{\n  \"backend\": \"";
+    writeEscaped(out, backend.c_str());
+    out << "\",\n  \"renderer\": \"";
+    writeEscaped(out, (const char*)glGetString(GL_RENDERER));
+    out << "\",\n  \"version\": \"";
+    writeEscaped(out, (const char*)glGetString(GL_VERSION));
+    out << "\",\n  \"frames\": " << timings.frames
+        << ",\n  \"totalMs\": "   << timings.total
+        << ",\n  \"minMs\": "     << timings.min
+        << ",\n  \"averageMs\": " << timings.average
+        << ",\n  \"medianMs\": "  << timings.median
+        << ",\n  \"p99Ms\": "     << timings.p99
+        << ",\n  \"maxMs\": "     << timings.max
+        << "\n}\n";
+
+    if(!out)
+    {
+        std::cout << "ERROR::FRAME_RUNNER::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,274 @@
+#include "Harness/GLContext.hpp"
+
+#include <iostream>
+
+#if defined(__linux__)
+    #include <dlfcn.h>
+    #define GL_CONTEXT_EGL
+#endif
+
+namespace
+{
+    void glfwErrorCallback(int error, const char* description)
+    {
+        std::cout << "ERROR::GLFW::" << error << " " << description << std::endl;
+    }
+
+#ifdef GL_CONTEXT_EGL
+    // The part of EGL 1.5 and its extensions used here, declared rather than taken from <EGL/egl.h>
+    // so building needs no EGL headers either; the values are fixed by the Khronos registry.
+    typedef int          EGLint;
+    typedef unsigned int EGLBoolean;
+    typedef unsigned int EGLenum;
+    typedef void*        EGLDisplay;
+    typedef void*        EGLConfig;
+    typedef void*        EGLContext;
+    typedef void*        EGLSurface;
+
+    const EGLenum    EGL_PLATFORM_SURFACELESS_MESA       = 0x31DD;
+    const EGLenum    EGL_OPENGL_API                      = 0x30A2;
+    const EGLint     EGL_NONE                            = 0x3038;
+    const EGLint     EGL_RENDERABLE_TYPE                 = 0x3040;
+    const EGLint     EGL_OPENGL_BIT                      = 0x0008;
+    const EGLint     EGL_CONTEXT_MAJOR_VERSION           = 0x3098;
+    const EGLint     EGL_CONTEXT_MINOR_VERSION           = 0x30FB;
+    const EGLint     EGL_CONTEXT_OPENGL_PROFILE_MASK     = 0x30FD;
+    const EGLint     EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+    void* const      EGL_DEFAULT_DISPLAY                 = nullptr;
+    const EGLDisplay EGL_NO_DISPLAY                      = nullptr;
+    const EGLConfig  EGL_NO_CONFIG_KHR                   = nullptr;
+    const EGLContext EGL_NO_CONTEXT                      = nullptr;
+    const EGLSurface EGL_NO_SURFACE                      = nullptr;
+
+    // Loaded at run time, so nothing links against libEGL and machines without it still run windowed.
+    struct EglFunctions
+    {
+        void*      (*getProcAddress)(const char* name);
+        EGLBoolean (*initialize)(EGLDisplay display, EGLint* major, EGLint* minor);
+        EGLBoolean (*terminate)(EGLDisplay display);
+        EGLBoolean (*bindAPI)(EGLenum api);
+        EGLBoolean (*chooseConfig)(EGLDisplay display, const EGLint* attributes, EGLConfig* configs, EGLint size, EGLint* count);
+        EGLContext (*createContext)(EGLDisplay display, EGLConfig config, EGLContext share, const EGLint* attributes);
+        EGLBoolean (*destroyContext)(EGLDisplay display, EGLContext context);
+        EGLBoolean (*makeCurrent)(EGLDisplay display, EGLSurface draw, EGLSurface read, EGLContext context);
+        EGLDisplay (*getPlatformDisplay)(EGLenum platform, void* nativeDisplay, const EGLint* attributes);
+    };
+
+    template<typename Function>
+    bool loadSymbol(void* library, const char* name, Function &function)
+    {
+        function = reinterpret_cast<Function>(dlsym(library, name));
+        return function != nullptr;
+    }
+
+    bool loadEgl(void* library, EglFunctions &egl)
+    {
+        if(!loadSymbol(library, "eglGetProcAddress", egl.getProcAddress) || !loadSymbol(library, "eglInitialize", egl.initialize)
+            || !loadSymbol(library, "eglTerminate", egl.terminate) || !loadSymbol(library, "eglBindAPI", egl.bindAPI)
+            || !loadSymbol(library, "eglChooseConfig", egl.chooseConfig) || !loadSymbol(library, "eglCreateContext", egl.createContext)
+            || !loadSymbol(library, "eglDestroyContext", egl.destroyContext) || !loadSymbol(library, "eglMakeCurrent", egl.makeCurrent))
+            return false;
+
+        egl.getPlatformDisplay = reinterpret_cast<EGLDisplay (*)(EGLenum, void*, const EGLint*)>(egl.getProcAddress("eglGetPlatformDisplayEXT"));
+        return egl.getPlatformDisplay != nullptr;
+    }
+
+    EglFunctions egl;
+#endif
+}
+
+GLContext::GLContext()
+    : glfwWindow(nullptr), glfwStarted(false), isHeadless(false), backendName(nullptr), procAddress(nullptr),
+      eglLibrary(nullptr), eglDisplay(nullptr), eglContext(nullptr)
+{
+
+}
+
+GLContext::~GLContext()
+{
+    destroy();
+}
+
+bool GLContext::create(const ContextSettings &settings)
+{
+    destroy();
+    isHeadless = settings.headless;
+
+    if(!settings.headless)
+    {
+        if(createWindow(settings, true, GLFW_NATIVE_CONTEXT_API))
+            backendName = "GLFW window";
+    }
+    else if(createEgl(settings))
+        backendName = "EGL surfaceless";
+    else if(createWindow(settings, false, GLFW_NATIVE_CONTEXT_API))
+        backendName = "GLFW hidden window";
+    else if(createWindow(settings, false, GLFW_OSMESA_CONTEXT_API))
+        backendName = "GLFW OSMesa";
+
+    if(!backendName)
+    {
+        std::cout << "ERROR::GL_CONTEXT::CREATION_FAILED" << (settings.headless ? " (headless)" : "") << std::endl;
+        destroy();
+        return false;
+    }
+
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << " on " << glGetString(GL_RENDERER) << " (" << backendName << ")" << std::endl;
+    return true;
+}
+
+void GLContext::destroy()
+{
+    if(glfwWindow)
+        glfwDestroyWindow(glfwWindow);
+    glfwWindow = nullptr;
+
+    if(glfwStarted)
+        glfwTerminate();
+    glfwStarted = false;
+
+    destroyEgl();
+    backendName = nullptr;
+    procAddress = nullptr;
+}
+
+// ------------------------------------------------------------------------
+bool GLContext::createWindow(const ContextSettings &settings, bool visible, int creationApi)
+{
+    glfwSetErrorCallback(glfwErrorCallback);
+    if(!glfwStarted)
+    {
+        if(!glfwInit())
+            return false;
+        glfwStarted = true;
+    }
+
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, settings.major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, settings.minor);
+    if(settings.major * 10 + settings.minor >= 32)
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, creationApi);
+
+    glfwWindow = glfwCreateWindow(settings.width, settings.height, settings.title.c_str(), NULL, NULL);
+    if(!glfwWindow)
+        return false;
+
+    glfwMakeContextCurrent(glfwWindow);
+    if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "ERROR::GL_CONTEXT::GLAD_LOAD_FAILED" << std::endl;
+        glfwDestroyWindow(glfwWindow);
+        glfwWindow = nullptr;
+        return false;
+    }
+
+    procAddress = (GLADloadproc)glfwGetProcAddress;
+    if(visible)
+        glfwSwapInterval(settings.vsync ? 1 : 0);
+    return true;
+}
+
+bool GLContext::createEgl(const ContextSettings &settings)
+{
+#ifdef GL_CONTEXT_EGL
+    eglLibrary = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if(!eglLibrary || !loadEgl(eglLibrary, egl))
+    {
+        destroyEgl();
+        return false;
+    }
+
+    EGLDisplay display = egl.getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !egl.initialize(display, &major, &minor))
+    {
+        destroyEgl();
+        return false;
+    }
+    eglDisplay = display;
+
+    if(!egl.bindAPI(EGL_OPENGL_API))
+    {
+        destroyEgl();
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, settings.major,
+        EGL_CONTEXT_MINOR_VERSION, settings.minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    // No surface is ever made, so any config will do; EGL_KHR_no_config_context skips choosing one.
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLContext context = egl.createContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if(context == EGL_NO_CONTEXT)
+    {
+        const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLint count = 0;
+        if(egl.chooseConfig(display, configAttributes, &config, 1, &count) && count > 0)
+            context = egl.createContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    }
+    if(context == EGL_NO_CONTEXT)
+    {
+        destroyEgl();
+        return false;
+    }
+    eglContext = context;
+
+    if(!egl.makeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)
+        || !gladLoadGLLoader((GLADloadproc)egl.getProcAddress))
+    {
+        std::cout << "ERROR::GL_CONTEXT::EGL_MAKE_CURRENT_FAILED" << std::endl;
+        destroyEgl();
+        return false;
+    }
+    procAddress = (GLADloadproc)egl.getProcAddress;
+    return true;
+#else
+    (void)settings;
+    return false;
+#endif
+}
+
+void GLContext::destroyEgl()
+{
+#ifdef GL_CONTEXT_EGL
+    if(eglContext)
+    {
+        egl.makeCurrent((EGLDisplay)eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        egl.destroyContext((EGLDisplay)eglDisplay, (EGLContext)eglContext);
+    }
+    if(eglDisplay)
+        egl.terminate((EGLDisplay)eglDisplay);
+    if(eglLibrary)
+        dlclose(eglLibrary);
+#endif
+    eglLibrary = nullptr;
+    eglDisplay = nullptr;
+    eglContext = nullptr;
+}
+
+// ------------------------------------------------------------------------
+bool GLContext::shouldClose() const
+{
+    return glfwWindow && glfwWindowShouldClose(glfwWindow);
+}
+
+void GLContext::swapBuffers()
+{
+    if(glfwWindow && !isHeadless)
+        glfwSwapBuffers(glfwWindow);
+}
+
+void GLContext::pollEvents()
+{
+    if(glfwStarted)
+        glfwPollEvents();
+}
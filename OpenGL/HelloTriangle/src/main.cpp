@@ -2,6 +2,13 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <memory>
+
+#include "Renderer/DrawQueue.hpp"
+#include "Renderer/GeometryArena.hpp"
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/Mesh.hpp"
+#include "Renderer/MeshOptimizer.hpp"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
@@ -60,6 +67,15 @@ int main()
         return -1;
     }
 
+    // Every bind in the render loop goes through the state cache, which drops the ones that change nothing.
+    // -----------------------------------------------------------------------------------------------------
+    GLStateCache glState;
+    glState.makeCurrent();
+
+    // Draws are recorded during the frame and issued together, sorted so that draws sharing state are adjacent.
+    // ----------------------------------------------------------------------------------------------------------
+    std::unique_ptr<DrawQueue> drawQueue(new DrawQueue());
+
     int success;
     char infoLog[512];
 
@@ -131,39 +147,42 @@ int main()
         1, 2, 3                 // second Triangle
     };
     
-    unsigned int VBO, VAO, EBO;
-    
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    
-    // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-    // ----------------------------------------------------------------------------------------------------------------
-    glBindVertexArray(VAO);
+    float triangleVertices[] = {
+        -0.9f,  0.9f, 0.0f,     // top
+        -0.9f,  0.6f, 0.0f,     // bottom left
+        -0.6f,  0.6f, 0.0f      // bottom right
+    };
+    unsigned int triangleIndices[] = {
+        0, 1, 2
+    };
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // Meshes don't get a VAO / VBO / EBO each: they are ranges of one shared vertex and index buffer with a single VAO per vertex layout.
+    // ---------------------------------------------------------------------------------------------------------------------------------
+    VertexLayout positionLayout;
+    positionLayout.add(0, 3, GL_FLOAT);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    Mesh quadData(positionLayout, 4);
+    quadData.set(0, vertices, 3);
+    quadData.setIndices(indices, 6);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    Mesh triangleData(positionLayout, 3);
+    triangleData.set(0, triangleVertices, 3);
+    triangleData.setIndices(triangleIndices, 3);
 
-    // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind.
-    // --------------------------------------------------------------------------------------------------------------------------------------------------------------------
-    glBindBuffer(GL_ARRAY_BUFFER, 0); 
+    // Indices are reordered for the post-transform cache before upload, not drawn as authored.
+    // ----------------------------------------------------------------------------------------
+    Mesh* meshes[]          = { &quadData, &triangleData };
+    const char* meshNames[] = { "quad", "triangle" };
+    for(int i = 0; i < 2; ++i)
+    {
+        MeshOptimizerReport report = optimizeMesh(*meshes[i]);
+        std::cout << "Mesh " << meshNames[i] << ": " << report.verticesBefore << " -> " << report.verticesAfter << " vertices, ACMR "
+                  << report.before.acmr << " -> " << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+    }
 
-    // Remember: do NOT unbind the EBO while a VAO is active as the bound element buffer object IS stored in the VAO; keep the EBO bound.
-    // ----------------------------------------------------------------------------------------------------------------------------------
-    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    // -----------------------------------------
-    
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    // ----------------------------------------------------------------------------------------------------------------------------------
-    
-    glBindVertexArray(0); 
+    std::unique_ptr<GeometryArena> geometry(new GeometryArena(glState, positionLayout));
+    MeshRange quadMesh     = quadData.upload(*geometry);
+    MeshRange triangleMesh = triangleData.upload(*geometry);
 
     // Uncomment this call to draw in wireframe polygons.
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -176,27 +195,27 @@ int main()
         // Input
         // -----
         processInput(window);
+        glState.beginFrame();
 
         // Render
         // ------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        // Draw our first triangle.
-        // ------------------------
-        glUseProgram(shaderProgram);
-
-        // Seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized.
-        // -------------------------------------------------------------------------------------------------------------------------------
-        glBindVertexArray(VAO); 
-        
-        // glDrawArrays(GL_TRIANGLES, 0, 6);
+        // Record the quad and the triangle.
         // ---------------------------------
+        DrawPacket quad = geometry->packet(quadMesh);
+        quad.program    = shaderProgram;
+        drawQueue->push(quad);
+
+        DrawPacket triangle = geometry->packet(triangleMesh);
+        triangle.program    = shaderProgram;
+        drawQueue->push(triangle);
 
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-        
-        // No need to unbind glBindVertexArray(0) every time.
-        // --------------------------------------------------
+        // Binds only what changed between packets; both meshes share program and VAO, so with GL 4.3 they go out as one multi draw.
+        // -------------------------------------------------------------------------------------------------------------------------
+        drawQueue->submit(glState);
+        drawQueue->clear();
 
         // GLFW: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -204,11 +223,13 @@ int main()
         glfwPollEvents();
     }
 
+    std::cout << "GL state calls in the last frame: " << glState.lastFrame().issued << " issued, " << glState.lastFrame().filtered << " filtered" << std::endl;
+
     // Optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    geometry.reset();
+    drawQueue.reset();
+    GLStateCache::clearCurrent();
 
     // GLFW: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -230,5 +251,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     // Make sure the viewport matches the new window dimensions; note that width and height will be significantly larger than specified on retina displays.
     // ----------------------------------------------------------------------------------------------------------------------------------------------------
-    glViewport(0, 0, width, height);
+    if (GLStateCache* state = GLStateCache::current())
+        state->viewport(0, 0, width, height);
+    else
+        glViewport(0, 0, width, height);
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef __BLOCK_COMPRESSION_HPP_INCLUDED__
+#define __BLOCK_COMPRESSION_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/Image.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// S3TC is an extension rather than core GL, so the loader doesn't define its tokens.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT        0x83F1
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT        0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT  0x8C4D
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT  0x8C4F
+#endif
+
+// 4x4 texel block formats. BC1 is 8 bytes a block (RGB, 1-bit alpha), BC3 16 (BC1 color plus an
+// interpolated alpha block): 8:1 and 4:1 against RGBA8.
+// ------------------------------------------------------------------------------------------
+enum class BlockFormat
+{
+    BC1,
+    BC3
+};
+
+std::size_t blockSize(BlockFormat format);
+// Bytes of a whole level; partial blocks at the edges count as full ones.
+std::size_t compressedSize(BlockFormat format, GLsizei width, GLsizei height);
+GLenum compressedInternalFormat(BlockFormat format, bool srgb);
+
+// BC1 for fully opaque images, BC3 for anything with alpha.
+BlockFormat chooseBlockFormat(const Image &image);
+
+// Encodes one block of 16 RGBA8 texels, row by row. BC1 switches to its 3 color + transparent
+// mode when a texel has alpha below 128.
+void compressBlockBC1(const unsigned char* texels, unsigned char* block);
+void compressBlockBC3(const unsigned char* texels, unsigned char* block);
+
+// One level ready for glCompressedTexImage2D.
+// -----------------------------------------
+struct CompressedImage
+{
+    GLsizei                    width;
+    GLsizei                    height;
+    std::vector<unsigned char> data;
+
+    CompressedImage() : width(0), height(0) {}
+};
+
+// Edge blocks repeat the last row / column. With a pool the block rows are split into jobs that
+// the calling thread shares with the pool; it only waits for its own jobs, never the whole pool,
+// so a job already running on 'pool' may pass it too.
+void compressImage(const Image &image, BlockFormat format, CompressedImage &result, ThreadPool* pool = nullptr);
+
+#endif // !__BLOCK_COMPRESSION_HPP_INCLUDED__
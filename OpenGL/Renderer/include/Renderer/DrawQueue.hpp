@@ -0,0 +1,160 @@
+#ifndef __DRAW_QUEUE_HPP_INCLUDED__
+#define __DRAW_QUEUE_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/UniformBlocks.hpp"
+#include "Renderer/UniformRingBuffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GLStateCache;
+
+// Everything needed to issue one indexed draw, recorded instead of drawn right away.
+struct DrawPacket
+{
+    GLuint program;
+    GLuint vertexArray;
+    GLuint texture;          // Bound to unit 0, 0 for none.
+
+    // Per-draw data, written by submit() into the Draws array bound to DRAW_BLOCK_BINDING.
+    DrawBlock block;
+
+    GLenum  mode;
+    GLsizei count;
+    GLenum  indexType;
+    GLuint  firstIndex;      // In indices, not bytes.
+    GLint   baseVertex;
+
+    // Instanced draws, see InstanceBatcher. baseInstance indexes the per-instance attributes in instanceBuffer.
+    GLsizei instanceCount;
+    GLuint  baseInstance;
+    GLuint  instanceBuffer;
+    GLuint  instanceLocation;
+
+    float         depth;     // View depth mapped to [0, 1].
+    unsigned char layer;     // Layers draw in increasing order, 0 - 15.
+    bool          blended;   // Alpha blended: drawn after the opaque packets of its layer, back to front.
+
+    DrawPacket();
+};
+
+// The packet a sort key belongs to, radix sorted by key.
+struct DrawSortEntry
+{
+    std::uint64_t key;
+    std::uint32_t packet;
+};
+
+// Stable LSD radix sort on the 64-bit keys, 8 bits per pass. Passes whose byte is the same for
+// every key are skipped, so keys that only use a few bits sort in a few passes.
+// 'scratch' must hold 'count' entries too; the result ends up in 'entries'.
+void radixSort(DrawSortEntry* entries, DrawSortEntry* scratch, std::size_t count);
+
+// Layout of one glMultiDrawElementsIndirect record.
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+struct DrawQueueStats
+{
+    unsigned int draws;       // Packets drawn.
+    unsigned int drawCalls;   // GL draw calls issued for them.
+    unsigned int multiDraws;  // How many of those were glMultiDrawElementsIndirect.
+    unsigned int programChanges;
+    unsigned int vertexArrayChanges;
+    unsigned int textureChanges;
+};
+
+// Deferred draws: push() records packets, submit() sorts them by a 64-bit key so draws sharing
+// a program, then a vertex array, then a texture end up next to each other, and issues them
+// through the state cache. Opaque packets sort by state first and front to back within the same
+// state; blended ones sort back to front first so they still compose correctly.
+//
+// Key layout, most significant bits first:
+//   opaque:  layer (4) | 0 | program (12) | vertex array (12) | texture (12) | depth (23)
+//   blended: layer (4) | 1 | inverted depth (23) | program (12) | vertex array (12) | texture (12)
+// Object names are truncated to 12 bits; a collision only costs a state change, never a wrong draw.
+//
+// The per-draw blocks are copied in submission order into arrays of DRAW_BLOCK_CAPACITY
+// elements allocated from the ring buffer, one bind per array; shaders find their element with
+// draw.glsl. Packets of one array that share program, vertex array, texture, blending and mode
+// therefore form one run, whatever their blocks hold. With GL 4.3 and
+// GL_ARB_shader_draw_parameters (gl_DrawIDARB) every run of more than one packet is drawn by one
+// glMultiDrawElementsIndirect call; the commands of the whole frame go into the ring buffer next
+// to the Draws arrays, so persistent rings need no upload at all.
+// ----------------------------------------------------------------------------------------------
+class DrawQueue
+{
+public:
+    explicit DrawQueue(std::size_t capacity = 1024);
+
+    DrawQueue(const DrawQueue&) = delete;
+    DrawQueue& operator=(const DrawQueue&) = delete;
+
+    // Generic vertex attribute holding the draw's element in the Draws array, see draw.glsl.
+    static const GLuint DRAW_INDEX_LOCATION = 15;
+
+    static std::uint64_t makeKey(const DrawPacket &packet);
+
+    void push(const DrawPacket &packet);
+    void clear();
+
+    void sort();
+    // Sorts if needed, writes the per-draw blocks and indirect commands to 'uniforms' (between its beginFrame()
+    // and endFrame()) and flushes it, then draws every packet. Without a ring nothing is multi drawn.
+    // Call clear() before recording the next frame.
+    void submit(GLStateCache &state, UniformRingBuffer* uniforms = nullptr);
+
+    // On by default when the context has GL 4.3 and GL_ARB_shader_draw_parameters.
+    void setMultiDrawIndirect(bool enabled);
+    bool isMultiDrawIndirect() const { return multiDraw; }
+
+    std::size_t size() const { return packets.size(); }
+    const DrawPacket& packet(std::size_t index) const { return packets[index]; }
+    // Packet indices in submission order, valid after sort().
+    const std::vector<DrawSortEntry>& order() const { return entries; }
+
+    // Counted by the last submit().
+    const DrawQueueStats& stats() const { return lastStats; }
+
+private:
+    // Sorted entries [first, last) drawn with the same state and Draws array, commands from 'command' on when multi drawn.
+    struct Run
+    {
+        std::size_t first;
+        std::size_t last;
+        std::size_t command;
+    };
+
+    static bool sameState(const DrawPacket &a, const DrawPacket &b);
+    void writeBlocks(UniformRingBuffer &uniforms);
+    void buildRuns(bool multiDrawRuns);
+    void applyState(GLStateCache &state, const DrawPacket &packet);
+    void draw(GLStateCache &state, const DrawPacket &packet);
+
+private:
+    std::vector<DrawPacket>    packets;
+    std::vector<DrawSortEntry> entries;
+    std::vector<DrawSortEntry> scratch;
+    bool                       sorted;
+
+    // One per DRAW_BLOCK_CAPACITY sorted packets, invalid when the ring ran out of space.
+    std::vector<UniformAllocation>           blockArrays;
+
+    bool                                     multiDrawSupported;
+    bool                                     multiDraw;
+    std::vector<Run>                         runs;
+    std::vector<DrawElementsIndirectCommand> commands;
+
+    DrawQueueStats lastStats;
+};
+
+#endif // !__DRAW_QUEUE_HPP_INCLUDED__
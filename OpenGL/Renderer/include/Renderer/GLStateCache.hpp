@@ -0,0 +1,155 @@
+#ifndef __GL_STATE_CACHE_HPP_INCLUDED__
+#define __GL_STATE_CACHE_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+// How many state calls reached GL and how many were dropped as redundant.
+struct GLStateStats
+{
+    unsigned int issued;
+    unsigned int filtered;
+};
+
+// Shadows the bind / enable state of one context and only forwards calls that change it.
+// Everything starts out unknown, so the first call of each kind is always issued. Code that
+// changes state behind the cache's back (third party renderers, raw GL calls) has to call
+// invalidate() afterwards, and deleted objects have to be reported so a new object reusing
+// the name isn't mistaken for the one still "bound".
+//
+// Per frame: beginFrame() closes the counters of the previous frame, see lastFrame().
+// ---------------------------------------------------------------------------------------
+class GLStateCache
+{
+public:
+    static const unsigned int MAX_TEXTURE_UNITS   = 16;
+    static const unsigned int MAX_BUFFER_BINDINGS = 16;
+
+    GLStateCache();
+
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    // The cache of the context current on this thread, used by Shader::use() and the renderer
+    // helpers; null means they call GL directly.
+    static GLStateCache* current();
+    void makeCurrent();
+    static void clearCurrent();
+
+    // Forget everything, the next call of each kind reaches GL again.
+    void invalidate();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void activeTexture(GLenum texture);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    void bindSampler(GLuint unit, GLuint sampler);
+
+    void enable(GLenum capability)  { setEnabled(capability, true); }
+    void disable(GLenum capability) { setEnabled(capability, false); }
+    void setEnabled(GLenum capability, bool enabled);
+
+    void blendFunc(GLenum source, GLenum destination) { blendFuncSeparate(source, destination, source, destination); }
+    void blendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha, GLenum destinationAlpha);
+    void blendEquation(GLenum mode) { blendEquationSeparate(mode, mode); }
+    void blendEquationSeparate(GLenum modeRgb, GLenum modeAlpha);
+    void depthFunc(GLenum function);
+    void depthMask(GLboolean mask);
+    void scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+    // Report deletions, GL silently unbinds deleted objects.
+    void programDeleted(GLuint program);
+    void vertexArrayDeleted(GLuint vertexArray);
+    void bufferDeleted(GLuint buffer);
+    void textureDeleted(GLuint texture);
+    void samplerDeleted(GLuint sampler);
+
+    // Last value set through the cache, 0 while unknown.
+    GLuint boundProgram() const { return known(program) ? program : 0; }
+    GLuint boundVertexArray() const { return known(vertexArray) ? vertexArray : 0; }
+
+    void beginFrame();
+    const GLStateStats& thisFrame() const { return frame; }
+    const GLStateStats& lastFrame() const { return previousFrame; }
+
+private:
+    enum BufferTarget
+    {
+        ARRAY_BUFFER,
+        ELEMENT_ARRAY_BUFFER,
+        UNIFORM_BUFFER,
+        SHADER_STORAGE_BUFFER,
+        DRAW_INDIRECT_BUFFER,
+        PIXEL_PACK_BUFFER,
+        PIXEL_UNPACK_BUFFER,
+        COPY_READ_BUFFER,
+        COPY_WRITE_BUFFER,
+        BUFFER_TARGET_COUNT
+    };
+
+    enum TextureTarget
+    {
+        TEXTURE_2D,
+        TEXTURE_2D_ARRAY,
+        TEXTURE_3D,
+        TEXTURE_CUBE_MAP,
+        TEXTURE_TARGET_COUNT
+    };
+
+    enum Capability
+    {
+        BLEND,
+        CULL_FACE,
+        DEPTH_TEST,
+        SCISSOR_TEST,
+        STENCIL_TEST,
+        CAPABILITY_COUNT
+    };
+
+    struct BufferRange
+    {
+        GLuint     buffer;
+        GLintptr   offset;
+        GLsizeiptr size;
+    };
+
+    // Shadow value for "not known", no GL object name or enum uses it.
+    static const GLuint UNKNOWN = ~0u;
+    static bool known(GLuint value) { return value != UNKNOWN; }
+
+    static int bufferTarget(GLenum target);
+    static int indexedTarget(GLenum target);
+    static int textureTarget(GLenum target);
+    static int capability(GLenum capability);
+
+    // Counts the call and returns true when it can be dropped.
+    bool redundant(bool unchanged);
+
+private:
+    GLuint program;
+    GLuint vertexArray;
+    GLuint buffers[BUFFER_TARGET_COUNT];
+    BufferRange ranges[2][MAX_BUFFER_BINDINGS];  // Uniform and shader storage binding points.
+
+    GLenum activeUnit;
+    GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+    GLuint samplers[MAX_TEXTURE_UNITS];
+
+    int    enabled[CAPABILITY_COUNT];  // -1 unknown, 0 / 1 otherwise.
+    GLenum blendFuncs[4];
+    GLenum blendEquations[2];
+    GLenum depthFunction;
+    int    depthWrite;
+    GLint  scissorBox[4];
+    GLint  viewportBox[4];
+    bool   scissorKnown;
+    bool   viewportKnown;
+
+    GLStateStats frame;
+    GLStateStats previousFrame;
+};
+
+#endif // !__GL_STATE_CACHE_HPP_INCLUDED__
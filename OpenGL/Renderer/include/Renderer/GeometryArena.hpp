@@ -0,0 +1,93 @@
+#ifndef __GEOMETRY_ARENA_HPP_INCLUDED__
+#define __GEOMETRY_ARENA_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/DrawQueue.hpp"
+#include "Renderer/VertexLayout.hpp"
+
+#include <map>
+
+class GLStateCache;
+
+// First fit allocator over [0, capacity) that merges neighbouring free ranges.
+// ---------------------------------------------------------------------------
+class RangeAllocator
+{
+public:
+    static const GLuint INVALID = ~0u;
+
+    explicit RangeAllocator(GLuint capacity = 0);
+
+    // INVALID when no free range is large enough.
+    GLuint allocate(GLuint size);
+    void release(GLuint offset, GLuint size);
+    void grow(GLuint capacity);
+
+    GLuint capacity() const { return total; }
+    GLuint used() const { return inUse; }
+
+private:
+    std::map<GLuint, GLuint> freeRanges;  // Offset -> size.
+    GLuint                   total;
+    GLuint                   inUse;
+};
+
+// Where a mesh lives in its arena, in vertices / indices.
+struct MeshRange
+{
+    GLuint baseVertex;
+    GLuint vertexCount;
+    GLuint firstIndex;
+    GLuint indexCount;
+
+    bool isValid() const { return indexCount != 0; }
+};
+
+// Many meshes of one vertex layout in one vertex buffer and one index buffer (32-bit indices)
+// behind a single vertex array. Every mesh drawn from the arena shares the vertex array, so
+// the DrawQueue can submit runs of them with one glMultiDrawElementsIndirect call.
+// A full buffer grows by doubling on its own; its data is copied on the GPU and the vertex array re-pointed.
+// -------------------------------------------------------------------------------------------
+class GeometryArena
+{
+public:
+    GeometryArena(GLStateCache &state, const VertexLayout &layout, GLuint vertexCapacity = 65536, GLuint indexCapacity = 196608);
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    MeshRange allocate(GLuint vertexCount, GLuint indexCount);
+    void release(const MeshRange &range);
+
+    // Indices are relative to the mesh's first vertex.
+    MeshRange add(const void* vertices, GLuint vertexCount, const GLuint* indices, GLuint indexCount);
+    void upload(const MeshRange &range, const void* vertices, const GLuint* indices);
+
+    // A packet drawing 'range', program / material / depth still to be filled in.
+    DrawPacket packet(const MeshRange &range) const;
+
+    const VertexLayout& layout() const { return vertexLayout; }
+    GLuint vertexArray() const { return vao; }
+
+private:
+    void createVertexBuffer(GLuint capacity);
+    void createIndexBuffer(GLuint capacity);
+    void growVertices(GLuint needed);
+    void growIndices(GLuint needed);
+    void replaceBuffer(GLuint oldBuffer, GLuint newBuffer, GLsizeiptr size);
+
+private:
+    GLStateCache &state;
+    VertexLayout  vertexLayout;
+
+    GLuint vao;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+
+    RangeAllocator vertices;
+    RangeAllocator indices;
+};
+
+#endif // !__GEOMETRY_ARENA_HPP_INCLUDED__
@@ -0,0 +1,42 @@
+#ifndef __IMAGE_HPP_INCLUDED__
+#define __IMAGE_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 8-bit RGBA pixels, bottom row first as glTexImage2D expects them.
+// ---------------------------------------------------------------
+struct Image
+{
+    GLsizei                    width;
+    GLsizei                    height;
+    std::vector<unsigned char> pixels;
+
+    Image() : width(0), height(0) {}
+    Image(GLsizei width, GLsizei height) : width(width), height(height), pixels((std::size_t)width * height * 4) {}
+
+    std::size_t size() const { return pixels.size(); }
+};
+
+// TGA (uncompressed or RLE; 8, 24 or 32 bit) and binary PPM / PGM (P6 / P5, 8 bit).
+bool decodeImage(const unsigned char* data, std::size_t size, Image &image);
+bool loadImage(const std::string &path, Image &image);
+// Uncompressed 32-bit TGA, bottom row first, so loadImage gives back the same pixels.
+bool writeImage(const std::string &path, const Image &image);
+
+// How far apart two images are, per channel. Images of different sizes never match.
+// --------------------------------------------------------------------------------
+struct ImageDifference
+{
+    bool        sameSize;
+    int         maxDifference;      // Largest per channel difference, 0..255.
+    std::size_t differingPixels;    // Pixels with any channel apart by more than the tolerance.
+    double      psnr;               // dB over all four channels; infinite when identical.
+};
+
+ImageDifference compareImages(const Image &a, const Image &b, int tolerance = 0);
+
+#endif // !__IMAGE_HPP_INCLUDED__
@@ -0,0 +1,55 @@
+#ifndef __IMAGE_PROCESSING_HPP_INCLUDED__
+#define __IMAGE_PROCESSING_HPP_INCLUDED__
+
+#include "Renderer/Image.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Instruction sets the image kernels can use. Every level produces bit identical results: the
+// kernels only do integer arithmetic on 15-bit linear values, and the conversions in and out of
+// that range are table lookups shared by all of them.
+// -------------------------------------------------------------------------------------------
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Best level the CPU supports (and the build was compiled with).
+SimdLevel supportedSimdLevel();
+// The level in use, supportedSimdLevel() unless forced lower with setSimdLevel().
+SimdLevel simdLevel();
+// Clamped to what is supported; for validation and benchmarks.
+void setSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+// RGBA with every channel as linear light in [0, 32767], the form mip levels are filtered in.
+// Keeping 15 bits between levels avoids re-quantizing to 8 bits at every step.
+// -------------------------------------------------------------------------------------------
+struct LinearImage
+{
+    GLsizei                    width;
+    GLsizei                    height;
+    std::vector<std::uint16_t> pixels;
+
+    LinearImage() : width(0), height(0) {}
+    LinearImage(GLsizei width, GLsizei height) : width(width), height(height), pixels((std::size_t)width * height * 4) {}
+};
+
+// 'srgb' decodes / encodes the color channels with the sRGB curve; alpha is always linear.
+void toLinear(const Image &image, LinearImage &linear, bool srgb);
+void fromLinear(const LinearImage &linear, Image &image, bool srgb);
+
+// Half size (rounded down, at least 1). Box averages 2x2 blocks; Kaiser is a separable 8 tap
+// windowed sinc that keeps more detail, at the cost of some ringing clipped to the valid range.
+void downsampleBox(const LinearImage &source, LinearImage &result);
+void downsampleKaiser(const LinearImage &source, LinearImage &result);
+
+// 16-bit formats for GL_UNSIGNED_SHORT_5_6_5 (GL_RGB) and GL_UNSIGNED_SHORT_4_4_4_4 (GL_RGBA),
+// rounded to nearest like glm::packUnorm1x5_1x6_1x5 / glm::packUnorm4x4.
+void packRGB565(const Image &image, std::vector<std::uint16_t> &packed);
+void packRGBA4(const Image &image, std::vector<std::uint16_t> &packed);
+
+#endif // !__IMAGE_PROCESSING_HPP_INCLUDED__
@@ -0,0 +1,87 @@
+#ifndef __INSTANCE_BATCHER_HPP_INCLUDED__
+#define __INSTANCE_BATCHER_HPP_INCLUDED__
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Renderer/DrawQueue.hpp"
+
+#include <cstddef>
+#include <vector>
+
+class GLStateCache;
+
+// Per-instance vertex attributes: model matrix in 4 consecutive locations, then the color.
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+static_assert(sizeof(InstanceData) == 80, "InstanceData must stay tightly packed");
+
+struct InstanceBatcherStats
+{
+    unsigned int instances;
+    unsigned int batches;
+    unsigned int bytesUploaded;  // 0 when the instance data was the same as last flush()'s.
+};
+
+// Turns repeated draws into instanced ones. add() collects a packet plus its per-instance data;
+// flush() merges packets that share program, vertex array, texture, DrawBlock and index range
+// into one packet with an instance count, uploads all instance data of the frame in one call
+// (none when it didn't change since the last flush()) and pushes the merged packets to a
+// DrawQueue. Blended packets are never merged, they keep their own depth order.
+//
+// The instance attributes live in the mesh's vertex array (divisor 1) starting at the location
+// passed to attach(); shaders declare them as
+//   layout (location = N)     in mat4 instanceModel;
+//   layout (location = N + 4) in vec4 instanceColor;
+// ------------------------------------------------------------------------------------------
+class InstanceBatcher
+{
+public:
+    static const GLuint DEFAULT_LOCATION = 8;
+    static const GLuint LOCATION_COUNT   = 5;
+
+    // 'capacity' is the initial buffer size in instances, it grows as needed.
+    explicit InstanceBatcher(std::size_t capacity = 4096);
+    ~InstanceBatcher();
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+    // Records the instance attributes into 'vertexArray' once; packets added later must use this location.
+    void attach(GLStateCache &state, GLuint vertexArray, GLuint location = DEFAULT_LOCATION);
+
+    void add(const DrawPacket &packet, const InstanceData &instance, GLuint location = DEFAULT_LOCATION);
+    void flush(GLStateCache &state, DrawQueue &queue);
+
+    // Point the instance attributes at instance 'first' of the bound GL_ARRAY_BUFFER, for contexts without base instance.
+    static void pointAttributes(GLuint location, GLuint first);
+
+    // Counted by the last flush().
+    const InstanceBatcherStats& stats() const { return lastStats; }
+
+private:
+    struct Entry
+    {
+        DrawPacket   packet;
+        InstanceData instance;
+    };
+
+    static bool sameBatch(const DrawPacket &a, const DrawPacket &b);
+    static bool batchOrder(const Entry* a, const Entry* b);
+
+private:
+    GLuint                    buffer;
+    std::size_t               capacity;  // In instances.
+    std::vector<Entry>        entries;
+    std::vector<const Entry*> order;
+    std::vector<InstanceData> upload;
+    std::vector<InstanceData> uploaded;  // What the buffer holds.
+
+    InstanceBatcherStats lastStats;
+};
+
+#endif // !__INSTANCE_BATCHER_HPP_INCLUDED__
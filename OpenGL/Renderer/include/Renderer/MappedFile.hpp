@@ -0,0 +1,38 @@
+#ifndef __MAPPED_FILE_HPP_INCLUDED__
+#define __MAPPED_FILE_HPP_INCLUDED__
+
+#include <cstddef>
+#include <string>
+
+// Read only view of a whole file mapped into memory. Pages are read in by the OS as they are
+// touched, so nothing is copied until the data is actually used. Other processes may still write
+// or replace the file while it is mapped, which editors do to shaders being hot reloaded.
+// -------------------------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // An empty file can't be mapped; with 'allowEmpty' it opens as a valid zero length view
+    // instead of failing.
+    bool open(const std::string &path, bool allowEmpty = false);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const unsigned char* data() const { return mapping; }
+    std::size_t size() const { return length; }
+
+private:
+    const unsigned char* mapping;
+    std::size_t          length;
+#ifdef _WIN32
+    void* file;
+    void* mappingHandle;
+#endif
+};
+
+#endif // !__MAPPED_FILE_HPP_INCLUDED__
@@ -0,0 +1,63 @@
+#ifndef __MESH_HPP_INCLUDED__
+#define __MESH_HPP_INCLUDED__
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Renderer/GeometryArena.hpp"
+#include "Renderer/VertexLayout.hpp"
+
+#include <vector>
+
+// CPU side mesh in the interleaved format of its layout. Attributes are written as floats and
+// encoded to the attribute's VertexFormat on the way in, so the same source data can feed a
+// full float layout or a quantized one.
+// -------------------------------------------------------------------------------------------
+class Mesh
+{
+public:
+    explicit Mesh(const VertexLayout &layout, GLuint vertexCount = 0);
+
+    void resize(GLuint vertexCount);
+
+    // Missing components read as (0, 0, 0, 1).
+    void set(GLuint location, GLuint vertex, const glm::vec4 &value);
+    void set(GLuint location, GLuint vertex, const glm::vec3 &value) { set(location, vertex, glm::vec4(value, 1.0f)); }
+    void set(GLuint location, GLuint vertex, const glm::vec2 &value) { set(location, vertex, glm::vec4(value, 0.0f, 1.0f)); }
+
+    // One attribute for every vertex, 'components' floats each; 'stride' in bytes, 0 when tightly packed.
+    void set(GLuint location, const float* values, GLint components, GLsizei stride = 0);
+
+    // Decoded back to floats, (0, 0, 0, 1) when 'location' is not in the layout.
+    glm::vec4 get(GLuint location, GLuint vertex) const;
+
+    void setIndices(const GLuint* indices, GLuint count) { indexData.assign(indices, indices + count); }
+
+    // Moves vertex i to remap[i] and rewrites the indices; vertices mapped to ~0u are dropped.
+    // Several vertices may map to the same slot when they are identical.
+    void remapVertices(const std::vector<GLuint> &remap, GLuint vertexCount);
+
+    // Adds the vertices and indices of 'other', which has to use the same layout, after this mesh's.
+    void append(const Mesh &other);
+
+    // Copies the mesh into 'arena', which has to use the same layout.
+    MeshRange upload(GeometryArena &arena) const;
+
+    const VertexLayout& layout() const { return vertexLayout; }
+    GLuint vertexCount() const { return count; }
+    const void* vertices() const { return vertexData.data(); }
+    const std::vector<GLuint>& indices() const { return indexData; }
+    std::vector<GLuint>& indices() { return indexData; }
+
+private:
+    VertexLayout               vertexLayout;
+    GLuint                     count;
+    std::vector<unsigned char> vertexData;
+    std::vector<GLuint>        indexData;
+};
+
+// Unit vector folded onto the octahedron and unrolled to [-1, 1]^2.
+glm::vec2 encodeOctahedral(const glm::vec3 &normal);
+glm::vec3 decodeOctahedral(const glm::vec2 &encoded);
+
+#endif // !__MESH_HPP_INCLUDED__
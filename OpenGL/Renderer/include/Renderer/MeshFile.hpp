@@ -0,0 +1,97 @@
+#ifndef __MESH_FILE_HPP_INCLUDED__
+#define __MESH_FILE_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/GeometryArena.hpp"
+#include "Renderer/MappedFile.hpp"
+#include "Renderer/VertexLayout.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Mesh;
+
+// Binary mesh container (.lgpm), laid out exactly as it is uploaded:
+//
+//   MeshFileHeader
+//   MeshFileAttribute[attributeCount]   the vertex layout
+//   MeshFileLod[lodCount]               index ranges, LOD 0 first
+//   vertices                            interleaved, stride bytes each, at vertexOffset
+//   indices                             32-bit, relative to the first vertex, at indexOffset
+//
+// Both blobs start on a BLOB_ALIGNMENT boundary. All LODs share the vertex blob.
+// ------------------------------------------------------------------------------------------
+const std::uint32_t MESH_FILE_MAGIC   = 0x4D50474C; // "LGPM"
+const std::uint32_t MESH_FILE_VERSION = 1;
+
+struct MeshFileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    std::uint32_t stride;
+    std::uint32_t attributeCount;
+    std::uint32_t lodCount;
+    std::uint32_t reserved;
+    std::uint64_t vertexOffset;
+    std::uint64_t indexOffset;
+};
+
+struct MeshFileAttribute
+{
+    std::uint32_t location;
+    std::uint32_t format;   // VertexFormat, never Raw.
+};
+
+struct MeshFileLod
+{
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    float         error;     // Screen space error the LOD was built for, 0 for the full mesh or when unknown.
+    std::uint32_t reserved;
+};
+
+// A memory mapped .lgpm file. Nothing is parsed beyond the header and one pass checking every index
+// is below vertexCount: upload() hands pointers into the mapping straight to glBufferSubData.
+// ---------------------------------------------------------------------------------------------
+class MeshFile
+{
+public:
+    static const std::size_t BLOB_ALIGNMENT = 16;
+
+    MeshFile();
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+
+    const VertexLayout& layout() const { return vertexLayout; }
+    GLuint vertexCount() const { return header->vertexCount; }
+    GLuint indexCount() const { return header->indexCount; }
+    const void* vertices() const;
+    const GLuint* indices() const;
+
+    GLuint lodCount() const { return header->lodCount; }
+    const MeshFileLod& lod(GLuint level) const { return lods[level]; }
+
+    // Every LOD in one range of 'arena', which has to use the file's layout.
+    MeshRange upload(GeometryArena &arena) const;
+    // The part of an uploaded range that draws 'level'.
+    MeshRange lodRange(const MeshRange &uploaded, GLuint level) const;
+
+private:
+    MappedFile               file;
+    const MeshFileHeader*    header;
+    const MeshFileLod*       lods;
+    VertexLayout             vertexLayout;
+};
+
+// Writes 'mesh' as a .lgpm file. 'lods' index into the mesh's index buffer; empty means a single
+// LOD covering all of it. The layout may only use VertexFormat attributes, not Raw ones.
+bool writeMeshFile(const std::string &path, const Mesh &mesh, const std::vector<MeshFileLod> &lods = std::vector<MeshFileLod>());
+
+#endif // !__MESH_FILE_HPP_INCLUDED__
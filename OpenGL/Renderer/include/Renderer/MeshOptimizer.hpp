@@ -0,0 +1,59 @@
+#ifndef __MESH_OPTIMIZER_HPP_INCLUDED__
+#define __MESH_OPTIMIZER_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+class Mesh;
+
+// Post-transform cache efficiency of an index buffer, simulated with a FIFO cache.
+//   acmr - transformed vertices per triangle (0.5 is ideal for a regular grid, 3 is the worst).
+//   atvr - transformed vertices per referenced vertex (1 is ideal).
+// --------------------------------------------------------------------------------------------
+struct VertexCacheStats
+{
+    float acmr;
+    float atvr;
+};
+
+struct MeshOptimizerReport
+{
+    GLuint           verticesBefore;
+    GLuint           verticesAfter;   // After welding and dropping unreferenced vertices.
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+const unsigned int DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+VertexCacheStats analyzeVertexCache(const GLuint* indices, std::size_t indexCount, GLuint vertexCount, unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Tipsify (Sander et al. 2007): triangles are fanned around the vertex most likely to still be
+// in the cache. 'clusters', when given, receives the first triangle of every run that had to
+// restart from a dead end; those runs are what optimizeOverdraw reorders.
+// 'destination' must not alias 'indices'.
+void optimizeVertexCache(GLuint* destination, const GLuint* indices, std::size_t indexCount, GLuint vertexCount,
+                         unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE, std::vector<GLuint>* clusters = nullptr);
+
+// Reorders the clusters of a cache optimized index buffer so outward facing ones come first and
+// occlude the rest. Clusters are split further while that costs at most 'threshold' times their
+// ACMR. 'positions' are three floats per vertex, 'positionStride' bytes apart.
+void optimizeOverdraw(GLuint* destination, const GLuint* indices, std::size_t indexCount,
+                      const float* positions, GLsizei positionStride, GLuint vertexCount,
+                      const std::vector<GLuint> &clusters, float threshold = 1.05f,
+                      unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Old vertex -> new vertex in order of first use; unreferenced vertices map to ~0u.
+// Returns the number of vertices left.
+GLuint optimizeVertexFetchRemap(std::vector<GLuint> &remap, const GLuint* indices, std::size_t indexCount, GLuint vertexCount);
+
+// Old vertex -> first vertex with the same bytes. Returns the number of unique vertices.
+GLuint weldVerticesRemap(std::vector<GLuint> &remap, const void* vertices, GLuint vertexCount, GLsizei stride);
+
+// Welds, cache optimizes, overdraw sorts and fetch orders 'mesh' in place. The positions used
+// for overdraw sorting are read from 'positionLocation'.
+MeshOptimizerReport optimizeMesh(Mesh &mesh, GLuint positionLocation = 0, unsigned int cacheSize = DEFAULT_VERTEX_CACHE_SIZE, float overdrawThreshold = 1.05f);
+
+#endif // !__MESH_OPTIMIZER_HPP_INCLUDED__
@@ -0,0 +1,34 @@
+#ifndef __MIPMAPS_HPP_INCLUDED__
+#define __MIPMAPS_HPP_INCLUDED__
+
+#include "Renderer/Image.hpp"
+
+#include <vector>
+
+enum class MipFilter
+{
+    Box,
+    Kaiser
+};
+
+// Levels are filtered in linear light; 'srgb' says the color channels are sRGB encoded (and will
+// be sampled through GL_SRGB8_ALPHA8), so they are decoded first and encoded again per level.
+struct MipOptions
+{
+    MipFilter filter;
+    bool      srgb;
+
+    MipOptions(MipFilter filter = MipFilter::Box, bool srgb = true) : filter(filter), srgb(srgb) {}
+};
+
+// Number of levels in a full chain down to 1x1.
+GLsizei mipLevelCount(GLsizei width, GLsizei height);
+
+// Half the size (rounded down, at least 1); odd edges clamp.
+Image downsample(const Image &source, const MipOptions &options = MipOptions());
+
+// Appends every level below levels.back() down to 1x1. The chain stays in 15-bit linear form
+// between levels, so each level is quantized to 8 bits once rather than once per step.
+void buildMipChain(std::vector<Image> &levels, const MipOptions &options = MipOptions());
+
+#endif // !__MIPMAPS_HPP_INCLUDED__
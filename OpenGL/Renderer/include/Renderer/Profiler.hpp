@@ -0,0 +1,182 @@
+#ifndef __PROFILER_HPP_INCLUDED__
+#define __PROFILER_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Milliseconds per frame over the recent history; a zone entered several times in a frame
+// counts once, with its times added up.
+struct ProfileStats
+{
+    double       min;
+    double       average;
+    double       p99;
+    unsigned int samples;   // Frames the zone was seen in, 0 when it never ran on this side.
+};
+
+struct ProfileZoneStats
+{
+    std::string  name;
+    ProfileStats cpu;
+    ProfileStats gpu;
+    double       callsPerFrame;
+};
+
+// Frame profiler with named zones. CPU zones are timed with steady_clock; GPU zones with a pair
+// of GL_TIMESTAMP queries (glQueryCounter), which unlike GL_TIME_ELAPSED may nest. Queries are
+// kept in a ring of 'frameLatency' frames and only read once available, so reading back never
+// stalls: if the GPU falls that far behind, the frame simply records no GPU zones.
+//
+// Everything is called from the render thread. The frame itself is the zone "Frame".
+// ------------------------------------------------------------------------------------------
+class Profiler
+{
+public:
+    static const unsigned int DEFAULT_FRAME_LATENCY = 4;
+    static const unsigned int DEFAULT_HISTORY       = 240;
+
+    explicit Profiler(unsigned int frameLatency = DEFAULT_FRAME_LATENCY, unsigned int history = DEFAULT_HISTORY);
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Disabled, every call below returns straight away; toggling takes effect at the next frame.
+    void setEnabled(bool enabled) { enabledNextFrame = enabled; }
+    bool enabled() const { return enabledNextFrame; }
+    // GPU zones need GL 3.3 timer queries.
+    bool gpuSupported() const { return timerQueries; }
+
+    void beginFrame();
+    void endFrame();
+
+    // Names are compared by content; string literals are the cheap case.
+    void beginCpu(const char* name);
+    void endCpu();
+    void beginGpu(const char* name);
+    void endGpu();
+
+    std::vector<ProfileZoneStats> stats() const;
+    // Frames whose GPU zones were skipped because their queries were still in use.
+    unsigned int droppedFrames() const { return dropped; }
+
+    // The recorded history as a Chrome trace (chrome://tracing, Perfetto); GPU zones on their own track.
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Zone
+    {
+        std::string        name;
+        std::vector<float> cpuSamples;      // Rings of 'history' per frame totals.
+        std::vector<float> gpuSamples;
+        std::size_t        cpuNext;
+        std::size_t        gpuNext;
+        std::uint64_t      cpuFrameTime;    // Nanoseconds, this frame so far.
+        std::uint64_t      gpuFrameTime;
+        unsigned int       cpuFrameCalls;
+        bool               gpuTouched;
+        unsigned long long calls;
+        unsigned long long framesSeen;
+    };
+
+    struct OpenCpuScope
+    {
+        unsigned int  zone;
+        std::uint64_t start;
+    };
+
+    struct GpuRange
+    {
+        unsigned int zone;
+        unsigned int begin;     // Indices into the frame's queries.
+        unsigned int end;
+    };
+
+    struct FrameQueries
+    {
+        std::vector<GLuint>       queries;
+        unsigned int              used;
+        std::vector<GpuRange>     ranges;
+        std::vector<unsigned int> open;      // Ranges begun but not yet ended.
+        bool                      pending;   // Recorded, not yet read back.
+    };
+
+    struct TraceEvent
+    {
+        unsigned int  zone;
+        bool          gpu;
+        std::uint64_t start;      // Nanoseconds since construction, GPU ones mapped onto the CPU clock.
+        std::uint64_t duration;
+        std::uint64_t frame;
+    };
+
+private:
+    unsigned int zoneIndex(const char* name);
+    std::uint64_t now() const;
+    void addSample(std::vector<float> &samples, std::size_t &next, std::uint64_t nanoseconds);
+    // Reads back every finished frame of queries, oldest first.
+    void resolveQueries();
+    void resolve(FrameQueries &frame, std::uint64_t frameNumber);
+
+private:
+    bool enabledNextFrame;
+    bool active;
+    bool gpuActive;
+    bool timerQueries;
+
+    unsigned int  history;
+    std::uint64_t frame;
+    unsigned int  dropped;
+
+    Clock::time_point epoch;
+    std::int64_t      gpuOffset;    // CPU minus GPU nanoseconds.
+
+    std::vector<Zone>                             zones;
+    std::unordered_map<std::string, unsigned int> zonesByName;
+    std::unordered_map<const char*, unsigned int> zonesByPointer;
+
+    std::vector<OpenCpuScope>  cpuStack;
+    std::vector<FrameQueries>  ring;
+    std::vector<std::uint64_t> ringFrames;   // Frame number recorded in each ring slot.
+
+    std::deque<TraceEvent> trace;
+};
+
+// RAII zones: construct at the start of the work, let the scope end it.
+// ---------------------------------------------------------------------
+class CpuProfileScope
+{
+public:
+    CpuProfileScope(Profiler &profiler, const char* name) : profiler(profiler) { profiler.beginCpu(name); }
+    ~CpuProfileScope() { profiler.endCpu(); }
+
+    CpuProfileScope(const CpuProfileScope&) = delete;
+    CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+    Profiler &profiler;
+};
+
+// Times the GL commands issued inside the scope on the GPU, and the CPU time spent issuing them.
+class GpuProfileScope
+{
+public:
+    GpuProfileScope(Profiler &profiler, const char* name) : profiler(profiler) { profiler.beginCpu(name); profiler.beginGpu(name); }
+    ~GpuProfileScope() { profiler.endGpu(); profiler.endCpu(); }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    Profiler &profiler;
+};
+
+#endif // !__PROFILER_HPP_INCLUDED__
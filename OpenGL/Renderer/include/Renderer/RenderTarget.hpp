@@ -0,0 +1,46 @@
+#ifndef __RENDER_TARGET_HPP_INCLUDED__
+#define __RENDER_TARGET_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/Image.hpp"
+
+class GLStateCache;
+
+// An offscreen framebuffer: RGBA8 color and 24/8 depth stencil renderbuffers. Headless contexts
+// have no default framebuffer to draw into, and a fixed size target makes frames comparable
+// across machines whatever the window looks like.
+// -------------------------------------------------------------------------------------------
+class RenderTarget
+{
+public:
+    RenderTarget(GLStateCache &state, GLsizei width, GLsizei height);
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    bool isComplete() const { return complete; }
+    GLsizei width() const { return targetWidth; }
+    GLsizei height() const { return targetHeight; }
+
+    // Draws go here from now on, with the viewport covering the whole target.
+    void bind();
+    // Back to the default framebuffer; the viewport is left to the caller.
+    static void unbind();
+
+    // Waits for the GPU; bottom row first like every Image.
+    void readPixels(Image &image);
+
+private:
+    GLStateCache &state;
+
+    GLuint  framebuffer;
+    GLuint  color;
+    GLuint  depthStencil;
+    GLsizei targetWidth;
+    GLsizei targetHeight;
+    bool    complete;
+};
+
+#endif // !__RENDER_TARGET_HPP_INCLUDED__
@@ -0,0 +1,61 @@
+#ifndef __TEXTURE_CACHE_HPP_INCLUDED__
+#define __TEXTURE_CACHE_HPP_INCLUDED__
+
+#include "Renderer/BlockCompression.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Block compressed mip chains on disk, one file per key (<directory>/<key as hex>.lgpt):
+//
+//   TextureCacheHeader
+//   TextureCacheLevel[levelCount]   largest first
+//   blocks of every level, in the same order
+//
+// The key is a hash of the source file's bytes plus everything that changes the encoded result,
+// so an edited source simply misses and old entries are never stale, only unused.
+// -------------------------------------------------------------------------------------------
+const std::uint32_t TEXTURE_CACHE_MAGIC   = 0x5450474C; // "LGPT"
+const std::uint32_t TEXTURE_CACHE_VERSION = 1;
+const std::uint32_t MAX_TEXTURE_CACHE_SIZE = 16384;     // Largest level width or height read() accepts.
+
+struct TextureCacheHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t format;       // BlockFormat.
+    std::uint32_t levelCount;
+    std::uint64_t key;
+};
+
+struct TextureCacheLevel
+{
+    std::uint32_t width;
+    std::uint32_t height;
+};
+
+// 64-bit FNV-1a; pass a previous result as 'seed' to extend it.
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed = 0xCBF29CE484222325ull);
+
+// Safe to use from several threads at once: entries are written to a temporary file and renamed
+// into place, so a reader sees either nothing or a whole file.
+// --------------------------------------------------------------------------------------------
+class TextureCache
+{
+public:
+    // Creates the directory if it doesn't exist (not its parents).
+    explicit TextureCache(const std::string &directory);
+
+    // False on a miss or a damaged entry, which then simply gets rewritten.
+    bool read(std::uint64_t key, BlockFormat &format, std::vector<CompressedImage> &levels) const;
+    bool write(std::uint64_t key, BlockFormat format, const std::vector<CompressedImage> &levels) const;
+
+    std::string path(std::uint64_t key) const;
+
+private:
+    std::string directory;
+};
+
+#endif // !__TEXTURE_CACHE_HPP_INCLUDED__
@@ -0,0 +1,163 @@
+#ifndef __TEXTURE_MANAGER_HPP_INCLUDED__
+#define __TEXTURE_MANAGER_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include "Renderer/BlockCompression.hpp"
+#include "Renderer/Image.hpp"
+#include "Renderer/TextureCache.hpp"
+#include "Renderer/ThreadPool.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class GLStateCache;
+
+// Index + 1 into the manager's textures, 0 is never a texture.
+typedef std::uint32_t TextureHandle;
+
+struct TextureManagerStats
+{
+    unsigned int decoding;       // Queued or running on the worker threads.
+    unsigned int uploading;      // Decoded, waiting for or in the middle of their upload.
+    unsigned int resident;
+    unsigned int failed;
+    std::size_t  uploadedBytes;  // During the last update().
+    std::size_t  residentBytes;  // GPU memory of the resident textures, mips included.
+};
+
+// Streams textures in without stalling the render thread. Files are read, decoded and mipmapped
+// on a thread pool; update() then copies the levels into a ring of pixel buffer objects and lets
+// glTexSubImage2D pull them from there, never more than the budget per frame (a single row bigger
+// than the whole budget, or a compressed texture without glTexStorage2D, goes up alone). A ring
+// buffer is only reused once its fence shows the GPU is done with it, and update() stops for the
+// frame rather than wait. Until a texture is resident, texture() returns a placeholder.
+//
+// With compression on, the workers also encode every level to BC1 / BC3 and keep the result in a
+// TextureCache, so the next run skips decoding, mipmapping and encoding altogether.
+// --------------------------------------------------------------------------------------------
+class TextureManager
+{
+public:
+    static const std::size_t  DEFAULT_UPLOAD_BUFFER_SIZE  = 4 << 20;
+    static const unsigned int DEFAULT_UPLOAD_BUFFER_COUNT = 3;
+    static const std::size_t  DEFAULT_UPLOAD_BUDGET       = 8 << 20;
+
+    TextureManager(GLStateCache &state, unsigned int threadCount = 0,
+                   std::size_t uploadBufferSize = DEFAULT_UPLOAD_BUFFER_SIZE, unsigned int uploadBufferCount = DEFAULT_UPLOAD_BUFFER_COUNT);
+    ~TextureManager();
+
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+
+    // Loading the same path with the same flags twice returns the same handle; other flags load
+    // it again as a texture of its own. 'srgb' stores color textures as
+    // GL_SRGB8_ALPHA8 and filters their mips in linear light; leave it off for data (normals, masks).
+    TextureHandle load(const std::string &path, bool mipmaps = true, bool srgb = true);
+
+    // Applies to later load() calls. Needs GL_EXT_texture_compression_s3tc (and its sRGB formats
+    // for sRGB textures); textures it can't be used for stay uncompressed. An empty directory
+    // compresses without caching.
+    void setCompression(bool enabled, const std::string &cacheDirectory = std::string());
+    bool compressionSupported() const { return s3tc; }
+
+    // Call once per frame on the render thread. stats().uploadedBytes is what it uploaded.
+    void update(std::size_t budget = DEFAULT_UPLOAD_BUDGET);
+
+    // The texture once resident, the placeholder before that or if loading failed.
+    GLuint texture(TextureHandle handle) const;
+    bool isResident(TextureHandle handle) const;
+    GLuint placeholder() const { return placeholderTexture; }
+
+    TextureManagerStats stats() const;
+
+private:
+    enum class State
+    {
+        Decoding,
+        Uploading,
+        Resident,
+        Failed
+    };
+
+    struct Texture
+    {
+        std::string path;
+        GLuint      name;
+        State       state;
+        bool        srgb;
+        std::size_t bytes;
+    };
+
+    // Either 'levels' or, when 'format' is a compressed internal format, 'compressed'.
+    struct Decoded
+    {
+        TextureHandle                handle;
+        GLenum                       format;
+        std::vector<Image>           levels;       // Both empty when decoding failed.
+        std::vector<CompressedImage> compressed;
+    };
+
+    struct Upload
+    {
+        TextureHandle                handle;
+        GLenum                       format;
+        std::vector<Image>           levels;
+        std::vector<CompressedImage> compressed;
+        std::size_t                  level;
+        GLsizei                      row;          // In pixel rows, or block rows when compressed.
+
+        std::size_t levelCount() const { return format ? compressed.size() : levels.size(); }
+    };
+
+    struct UploadBuffer
+    {
+        GLuint buffer;
+        GLsync fence;
+    };
+
+    // Path, mipmaps, srgb: everything load() makes a different texture for.
+    typedef std::tuple<std::string, bool, bool> TextureKey;
+
+private:
+    void createPlaceholder();
+    // Also uploads everything when glTexStorage2D is missing and the levels are compressed.
+    void allocate(Texture &texture, Upload &upload);
+    // Uploads the next rows of 'upload' that fit in what is left of 'budget'; false when none
+    // fit or no ring buffer is free this frame.
+    bool uploadRows(Upload &upload, std::size_t budget, std::size_t &uploaded);
+
+private:
+    GLStateCache &state;
+    GLuint        placeholderTexture;
+
+    std::vector<Texture>                 textures;
+    std::map<TextureKey, TextureHandle>  handles;
+    std::deque<Upload>                   uploads;
+    std::size_t                          lastUploaded;
+
+    std::vector<UploadBuffer> ring;
+    std::size_t               ringSize;
+    std::size_t               nextBuffer;
+    bool                      fences;
+
+    bool                                s3tc;
+    bool                                s3tcSrgb;
+    bool                                compress;
+    std::shared_ptr<const TextureCache> cache;   // Shared with the jobs in flight.
+
+    // Filled by the workers, drained by update().
+    std::mutex          mutex;
+    std::deque<Decoded> decoded;
+
+    // Last, so it is destroyed first: running jobs still push into 'decoded'.
+    ThreadPool workers;
+};
+
+#endif // !__TEXTURE_MANAGER_HPP_INCLUDED__
@@ -0,0 +1,45 @@
+#ifndef __THREAD_POOL_HPP_INCLUDED__
+#define __THREAD_POOL_HPP_INCLUDED__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running jobs in submission order. Jobs must not touch GL: the
+// context belongs to the render thread. Destroying the pool drops the jobs that haven't
+// started and waits for the running ones.
+// ----------------------------------------------------------------------------------------
+class ThreadPool
+{
+public:
+    // 0 picks one thread less than the hardware has, and at least one.
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Blocks until every submitted job has finished.
+    void wait();
+
+    unsigned int size() const { return (unsigned int)workers.size(); }
+
+private:
+    void run();
+
+private:
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex                        mutex;
+    std::condition_variable           wake;
+    std::condition_variable           idle;
+    unsigned int                      running;
+    bool                              stopping;
+};
+
+#endif // !__THREAD_POOL_HPP_INCLUDED__
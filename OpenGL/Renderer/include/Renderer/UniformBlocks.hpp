@@ -0,0 +1,60 @@
+#ifndef __UNIFORM_BLOCKS_HPP_INCLUDED__
+#define __UNIFORM_BLOCKS_HPP_INCLUDED__
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// C++ mirrors of the std140 uniform blocks declared in Shaders/res/shaders/blocks.glsl.
+// std140 aligns vec3 to 16 bytes and pads mat3 columns to vec4, so the blocks only use
+// vec4 / mat4 members and every block is a multiple of 16 bytes; the asserts keep it that way.
+// -----------------------------------------------------------------------------------------
+
+// Binding points shared by C++ and GLSL (layout(std140, binding = N) needs GL 4.2, so shaders
+// are bound through Shader::bindUniformBlock instead).
+enum UniformBlockBinding
+{
+    CAMERA_BLOCK_BINDING = 0,
+    DRAW_BLOCK_BINDING   = 1
+};
+
+// Elements of the Draws array; 100 * 160 bytes stays within the 16 KB block size every implementation supports.
+const unsigned int DRAW_BLOCK_CAPACITY = 100;
+
+struct CameraBlock
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::vec4 position;       // xyz: world position, w: unused.
+};
+
+struct ObjectBlock
+{
+    glm::mat4 model;
+    glm::mat4 normalMatrix;   // Upper 3x3 used; a mat3 would be padded to this size anyway.
+};
+
+struct MaterialBlock
+{
+    glm::vec4 color;
+    glm::vec4 parameters;     // x: metallic, y: roughness, z: emissive strength, w: unused.
+};
+
+// One element of the Draws array: the per-draw data of a DrawPacket, see DrawQueue.
+struct DrawBlock
+{
+    ObjectBlock   object;
+    MaterialBlock material;
+};
+
+static_assert(sizeof(CameraBlock)   == 208, "CameraBlock does not match the std140 layout");
+static_assert(sizeof(ObjectBlock)   == 128, "ObjectBlock does not match the std140 layout");
+static_assert(sizeof(MaterialBlock) == 32,  "MaterialBlock does not match the std140 layout");
+static_assert(sizeof(DrawBlock)     == 160, "DrawBlock does not match the std140 array stride");
+static_assert(offsetof(CameraBlock, position)       == 192, "CameraBlock::position is misplaced");
+static_assert(offsetof(ObjectBlock, normalMatrix)   == 64,  "ObjectBlock::normalMatrix is misplaced");
+static_assert(offsetof(MaterialBlock, parameters)   == 16,  "MaterialBlock::parameters is misplaced");
+static_assert(offsetof(DrawBlock, material)         == 128, "DrawBlock::material is misplaced");
+
+#endif // !__UNIFORM_BLOCKS_HPP_INCLUDED__
@@ -0,0 +1,76 @@
+#ifndef __UNIFORM_RING_BUFFER_HPP_INCLUDED__
+#define __UNIFORM_RING_BUFFER_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <vector>
+
+// A slice of the ring written this frame, bind it with UniformRingBuffer::bind.
+struct UniformAllocation
+{
+    GLintptr   offset;
+    GLsizeiptr size;
+    void*      data;
+
+    bool isValid() const { return data != nullptr; }
+};
+
+// One large uniform buffer split into per-frame segments, sub-allocated per draw.
+// With GL 4.4 the buffer is persistently and coherently mapped, blocks are written straight
+// into GPU visible memory and a fence per segment keeps the CPU from overwriting a frame
+// still in flight. Older contexts write into a CPU copy that flush() uploads in one call.
+//
+// Per frame: beginFrame(), allocate / push every block, flush(), bind + draw, endFrame().
+// ---------------------------------------------------------------------------------------
+class UniformRingBuffer
+{
+public:
+    explicit UniformRingBuffer(GLsizeiptr segmentSize = 4 * 1024 * 1024, unsigned int segmentCount = 3);
+    ~UniformRingBuffer();
+
+    UniformRingBuffer(const UniformRingBuffer&) = delete;
+    UniformRingBuffer& operator=(const UniformRingBuffer&) = delete;
+
+    // Waits (normally not at all) until the GPU is done with the segment about to be reused.
+    void beginFrame();
+    UniformAllocation allocate(GLsizeiptr size);
+    void flush();
+    void endFrame();
+
+    template<typename Block>
+    UniformAllocation push(const Block &block)
+    {
+        UniformAllocation allocation = allocate(sizeof(Block));
+        if(allocation.isValid())
+            std::memcpy(allocation.data, &block, sizeof(Block));
+        return allocation;
+    }
+
+    void bind(GLuint binding, const UniformAllocation &allocation) const;
+    // Buffers have no type: other per-frame data (indirect draw commands) can be allocated here too and
+    // read by binding this buffer to its target.
+    GLuint handle() const { return buffer; }
+
+    bool       isPersistent() const { return persistent; }
+    GLsizeiptr used() const { return head - segmentStart(); }
+
+private:
+    GLintptr segmentStart() const { return (GLintptr)segment * segmentSize; }
+
+private:
+    GLuint     buffer;
+    GLsizeiptr segmentSize;
+    GLint      alignment;
+    bool       persistent;
+
+    unsigned char*             mapped;
+    std::vector<unsigned char> staging;
+    std::vector<GLsync>        fences;
+
+    unsigned int segment;
+    GLintptr     head;
+    GLintptr     flushed;
+};
+
+#endif // !__UNIFORM_RING_BUFFER_HPP_INCLUDED__
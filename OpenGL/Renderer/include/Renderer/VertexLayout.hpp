@@ -0,0 +1,81 @@
+#ifndef __VERTEX_LAYOUT_HPP_INCLUDED__
+#define __VERTEX_LAYOUT_HPP_INCLUDED__
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// How an attribute is stored in the vertex. The compact formats trade precision for size:
+//
+//   Half4           positions, 8 bytes (the 4th half pads to the 4 byte alignment).
+//   Snorm16x4       normals / tangents, 8 bytes.
+//   Octahedral16    unit normals folded onto two snorm16 values, 4 bytes; decode with
+//                   octahedral.glsl in the vertex shader.
+//   Unorm8x4        colors, 4 bytes.
+//   Unorm16x2       UVs in [0, 1], 4 bytes.
+//   Half2           UVs that tile outside [0, 1], 4 bytes.
+//
+// Raw is an attribute added by GL type, only GL_FLOAT ones can be encoded by Mesh.
+// --------------------------------------------------------------------------------------
+enum class VertexFormat
+{
+    Raw,
+    Float1,
+    Float2,
+    Float3,
+    Float4,
+    Half2,
+    Half4,
+    Snorm16x2,
+    Snorm16x4,
+    Unorm16x2,
+    Unorm16x4,
+    Octahedral16,
+    Snorm8x4,
+    Unorm8x4
+};
+
+struct VertexAttribute
+{
+    GLuint       location;
+    GLint        components;
+    GLenum       type;
+    GLboolean    normalized;
+    GLuint       offset;
+    VertexFormat format;
+};
+
+// Interleaved vertex format: attributes are packed in the order they are added.
+// ----------------------------------------------------------------------------
+class VertexLayout
+{
+public:
+    VertexLayout();
+
+    VertexLayout& add(GLuint location, VertexFormat format);
+    VertexLayout& add(GLuint location, GLint components, GLenum type, GLboolean normalized = GL_FALSE);
+
+    GLsizei stride() const { return vertexSize; }
+    const std::vector<VertexAttribute>& attributes() const { return attributeList; }
+
+    // nullptr when nothing is bound to 'location'.
+    const VertexAttribute* find(GLuint location) const;
+
+    // Records the attributes into the bound vertex array, reading from the bound GL_ARRAY_BUFFER.
+    void apply() const;
+
+    bool operator==(const VertexLayout &other) const;
+    bool operator!=(const VertexLayout &other) const { return !(*this == other); }
+
+private:
+    VertexLayout& add(GLuint location, GLint components, GLenum type, GLboolean normalized, VertexFormat format);
+
+private:
+    std::vector<VertexAttribute> attributeList;
+    GLsizei                      vertexSize;
+};
+
+// Size in bytes of one component of 'type'.
+GLsizei vertexTypeSize(GLenum type);
+
+#endif // !__VERTEX_LAYOUT_HPP_INCLUDED__
@@ -0,0 +1,432 @@
+#include "Renderer/BlockCompression.hpp"
+
+#include "Renderer/ThreadPool.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+    // Color endpoints.
+    // ----------------
+    std::uint16_t packColor(const glm::vec3 &color)
+    {
+        glm::vec3 c = glm::clamp(color, 0.0f, 255.0f);
+        int r = (int)(c.r * 31.0f / 255.0f + 0.5f);
+        int g = (int)(c.g * 63.0f / 255.0f + 0.5f);
+        int b = (int)(c.b * 31.0f / 255.0f + 0.5f);
+        return (std::uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    glm::vec3 unpackColor(std::uint16_t color)
+    {
+        int r = (color >> 11) & 31;
+        int g = (color >> 5) & 63;
+        int b = color & 31;
+        return glm::vec3((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+    }
+
+    // Palette and indices for a pair of endpoints; returns the squared error over the texels used.
+    // Without 'fourColors' entry 3 is transparent and never matched here.
+    float fitIndices(const glm::vec3* colors, const bool* used, std::uint16_t c0, std::uint16_t c1, bool fourColors, std::uint32_t &indices)
+    {
+        glm::vec3 palette[4];
+        palette[0] = unpackColor(c0);
+        palette[1] = unpackColor(c1);
+        if(fourColors)
+        {
+            palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+            palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+        }
+        else
+            palette[2] = (palette[0] + palette[1]) * 0.5f;
+
+        const int entries = fourColors ? 4 : 3;
+        float error = 0.0f;
+        indices = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            if(!used[i])
+            {
+                indices |= 3u << (i * 2);
+                continue;
+            }
+
+            int   best     = 0;
+            float bestDist = 1e30f;
+            for(int e = 0; e < entries; ++e)
+            {
+                glm::vec3 d = colors[i] - palette[e];
+                float dist = glm::dot(d, d);
+                if(dist < bestDist)
+                {
+                    bestDist = dist;
+                    best     = e;
+                }
+            }
+            indices |= (std::uint32_t)best << (i * 2);
+            error   += bestDist;
+        }
+        return error;
+    }
+
+    // Endpoints from the principal axis of the colors, inset by half a palette step.
+    void rangeFit(const glm::vec3* colors, const bool* used, glm::vec3 &start, glm::vec3 &end)
+    {
+        glm::vec3 mean(0.0f);
+        float     count = 0.0f;
+        for(int i = 0; i < 16; ++i)
+        {
+            if(used[i])
+            {
+                mean  += colors[i];
+                count += 1.0f;
+            }
+        }
+        mean /= count;
+
+        float cov[6] = {};
+        for(int i = 0; i < 16; ++i)
+        {
+            if(!used[i])
+                continue;
+            glm::vec3 d = colors[i] - mean;
+            cov[0] += d.r * d.r; cov[1] += d.r * d.g; cov[2] += d.r * d.b;
+            cov[3] += d.g * d.g; cov[4] += d.g * d.b; cov[5] += d.b * d.b;
+        }
+
+        // Power iteration; a handful of steps is plenty for picking a direction.
+        glm::vec3 axis(1.0f, 1.0f, 1.0f);
+        for(int iteration = 0; iteration < 8; ++iteration)
+        {
+            glm::vec3 next(cov[0] * axis.r + cov[1] * axis.g + cov[2] * axis.b,
+                           cov[1] * axis.r + cov[3] * axis.g + cov[4] * axis.b,
+                           cov[2] * axis.r + cov[4] * axis.g + cov[5] * axis.b);
+            float length = glm::length(next);
+            if(length < 1e-6f)
+                break;
+            axis = next / length;
+        }
+
+        float low = 1e30f, high = -1e30f;
+        for(int i = 0; i < 16; ++i)
+        {
+            if(!used[i])
+                continue;
+            float t = glm::dot(colors[i] - mean, axis);
+            low  = std::min(low, t);
+            high = std::max(high, t);
+        }
+
+        float inset = (high - low) / 16.0f;
+        start = mean + axis * (high - inset);
+        end   = mean + axis * (low + inset);
+    }
+
+    // Best endpoints for fixed indices by least squares; false when the system is singular.
+    bool refine(const glm::vec3* colors, const bool* used, std::uint32_t indices, bool fourColors, glm::vec3 &start, glm::vec3 &end)
+    {
+        static const float weights4[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        static const float weights3[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+        const float* weights = fourColors ? weights4 : weights3;
+
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        glm::vec3 ax(0.0f), bx(0.0f);
+        for(int i = 0; i < 16; ++i)
+        {
+            if(!used[i])
+                continue;
+            float a = weights[(indices >> (i * 2)) & 3];
+            float b = 1.0f - a;
+            aa += a * a; ab += a * b; bb += b * b;
+            ax += colors[i] * a;
+            bx += colors[i] * b;
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if(std::fabs(determinant) < 1e-6f)
+            return false;
+
+        start = (ax * bb - bx * ab) / determinant;
+        end   = (bx * aa - ax * ab) / determinant;
+        return true;
+    }
+
+    void writeColorBlock(unsigned char* block, std::uint16_t c0, std::uint16_t c1, std::uint32_t indices)
+    {
+        block[0] = (unsigned char)(c0 & 0xFF); block[1] = (unsigned char)(c0 >> 8);
+        block[2] = (unsigned char)(c1 & 0xFF); block[3] = (unsigned char)(c1 >> 8);
+        for(int i = 0; i < 4; ++i)
+            block[4 + i] = (unsigned char)(indices >> (i * 8));
+    }
+
+    // 'allowTransparent' is false inside BC3, whose color block always decodes in 4 color mode.
+    void compressColor(const unsigned char* texels, unsigned char* block, bool allowTransparent)
+    {
+        glm::vec3 colors[16];
+        bool      used[16];
+        bool      transparent = false;
+        int       usedCount   = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            colors[i] = glm::vec3(texels[i * 4 + 0], texels[i * 4 + 1], texels[i * 4 + 2]);
+            used[i]   = !allowTransparent || texels[i * 4 + 3] >= 128;
+            transparent |= !used[i];
+            usedCount   += used[i] ? 1 : 0;
+        }
+
+        if(usedCount == 0)
+        {
+            writeColorBlock(block, 0, 0, 0xFFFFFFFFu);
+            return;
+        }
+
+        const bool fourColors = !transparent;
+
+        glm::vec3 start, end;
+        rangeFit(colors, used, start, end);
+
+        std::uint16_t bestC0 = 0, bestC1 = 0;
+        std::uint32_t bestIndices = 0;
+        float         bestError   = 1e30f;
+
+        // Range fit, then one least squares pass on its indices; keep whichever is better.
+        for(int pass = 0; pass < 2; ++pass)
+        {
+            if(pass == 1 && !refine(colors, used, bestIndices, fourColors, start, end))
+                break;
+
+            std::uint16_t c0 = packColor(start);
+            std::uint16_t c1 = packColor(end);
+
+            // The order of the endpoints selects the mode: c0 > c1 is 4 color, c0 <= c1 3 color.
+            if(fourColors ? c0 < c1 : c0 > c1)
+                std::swap(c0, c1);
+
+            // Equal endpoints decode in 3 color mode, where index 3 would be transparent.
+            std::uint32_t indices;
+            float error = fitIndices(colors, used, c0, c1, fourColors && c0 != c1, indices);
+
+            if(error < bestError)
+            {
+                bestError   = error;
+                bestC0      = c0;
+                bestC1      = c1;
+                bestIndices = indices;
+            }
+        }
+
+        writeColorBlock(block, bestC0, bestC1, bestIndices);
+    }
+
+    // Alpha: 8 interpolated values (a0 > a1), or 6 plus exact 0 and 255 (a0 <= a1).
+    // -------------------------------------------------------------------------------
+    float fitAlpha(const unsigned char* texels, int a0, int a1, std::uint64_t &indices)
+    {
+        int palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        if(a0 > a1)
+        {
+            for(int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+        }
+        else
+        {
+            for(int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        float error = 0.0f;
+        indices = 0;
+        for(int i = 0; i < 16; ++i)
+        {
+            int alpha = texels[i * 4 + 3];
+            int best = 0, bestDist = 256 * 256;
+            for(int e = 0; e < 8; ++e)
+            {
+                int dist = (alpha - palette[e]) * (alpha - palette[e]);
+                if(dist < bestDist)
+                {
+                    bestDist = dist;
+                    best     = e;
+                }
+            }
+            indices |= (std::uint64_t)best << (i * 3);
+            error   += (float)bestDist;
+        }
+        return error;
+    }
+
+    void compressAlpha(const unsigned char* texels, unsigned char* block)
+    {
+        int low = 255, high = 0;            // All texels.
+        int innerLow = 255, innerHigh = 0;  // Without 0 and 255, which the 6 value mode has for free.
+        for(int i = 0; i < 16; ++i)
+        {
+            int alpha = texels[i * 4 + 3];
+            low  = std::min(low, alpha);
+            high = std::max(high, alpha);
+            if(alpha != 0 && alpha != 255)
+            {
+                innerLow  = std::min(innerLow, alpha);
+                innerHigh = std::max(innerHigh, alpha);
+            }
+        }
+
+        int a0 = high, a1 = low;
+        std::uint64_t indices;
+        float error = fitAlpha(texels, a0, a1, indices);
+
+        if(innerLow <= innerHigh && (low == 0 || high == 255))
+        {
+            std::uint64_t sixIndices;
+            float sixError = fitAlpha(texels, innerLow, innerHigh, sixIndices);
+            if(sixError < error)
+            {
+                a0      = innerLow;
+                a1      = innerHigh;
+                indices = sixIndices;
+            }
+        }
+
+        block[0] = (unsigned char)a0;
+        block[1] = (unsigned char)a1;
+        for(int i = 0; i < 6; ++i)
+            block[2 + i] = (unsigned char)(indices >> (i * 8));
+    }
+
+    void compressRows(const Image &image, BlockFormat format, unsigned char* out, GLsizei firstRow, GLsizei lastRow)
+    {
+        const GLsizei     blocksWide = (image.width + 3) / 4;
+        const std::size_t bytes      = blockSize(format);
+
+        unsigned char texels[16 * 4];
+        for(GLsizei by = firstRow; by < lastRow; ++by)
+        {
+            for(GLsizei bx = 0; bx < blocksWide; ++bx)
+            {
+                for(int y = 0; y < 4; ++y)
+                {
+                    GLsizei sy = std::min(by * 4 + y, image.height - 1);
+                    for(int x = 0; x < 4; ++x)
+                    {
+                        GLsizei sx = std::min(bx * 4 + x, image.width - 1);
+                        std::memcpy(&texels[(y * 4 + x) * 4], &image.pixels[((std::size_t)sy * image.width + sx) * 4], 4);
+                    }
+                }
+
+                unsigned char* block = out + ((std::size_t)by * blocksWide + bx) * bytes;
+                if(format == BlockFormat::BC1)
+                    compressBlockBC1(texels, block);
+                else
+                    compressBlockBC3(texels, block);
+            }
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+std::size_t blockSize(BlockFormat format)
+{
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t compressedSize(BlockFormat format, GLsizei width, GLsizei height)
+{
+    return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * blockSize(format);
+}
+
+GLenum compressedInternalFormat(BlockFormat format, bool srgb)
+{
+    if(format == BlockFormat::BC1)
+        return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+BlockFormat chooseBlockFormat(const Image &image)
+{
+    for(std::size_t i = 3; i < image.pixels.size(); i += 4)
+    {
+        if(image.pixels[i] != 255)
+            return BlockFormat::BC3;
+    }
+    return BlockFormat::BC1;
+}
+
+void compressBlockBC1(const unsigned char* texels, unsigned char* block)
+{
+    compressColor(texels, block, true);
+}
+
+void compressBlockBC3(const unsigned char* texels, unsigned char* block)
+{
+    compressAlpha(texels, block);
+    compressColor(texels, block + 8, false);
+}
+
+void compressImage(const Image &image, BlockFormat format, CompressedImage &result, ThreadPool* pool)
+{
+    result.width  = image.width;
+    result.height = image.height;
+    result.data.resize(compressedSize(format, image.width, image.height));
+
+    const GLsizei blocksHigh = (image.height + 3) / 4;
+    unsigned char* out = result.data.data();
+
+    if(!pool || pool->size() < 2 || blocksHigh < 2)
+    {
+        compressRows(image, format, out, 0, blocksHigh);
+        return;
+    }
+
+    // A few jobs per thread so uneven blocks still balance out. The caller works through them too and
+    // then only waits for the jobs other threads have taken, so calling from a job of 'pool' is fine.
+    struct RowJobs
+    {
+        std::atomic<GLsizei>    next;
+        GLsizei                 finished;
+        std::mutex              mutex;
+        std::condition_variable done;
+    };
+
+    const GLsizei perJob   = (blocksHigh + (GLsizei)pool->size() * 4 - 1) / ((GLsizei)pool->size() * 4);
+    const GLsizei jobCount = (blocksHigh + perJob - 1) / perJob;
+
+    // Shared: a helper may only get to run after the call has returned, and then finds nothing left.
+    std::shared_ptr<RowJobs> rows = std::make_shared<RowJobs>();
+    rows->next     = 0;
+    rows->finished = 0;
+
+    const Image* source = &image;
+    std::function<void()> work = [rows, source, format, out, perJob, jobCount, blocksHigh]()
+    {
+        for(GLsizei job = rows->next++; job < jobCount; job = rows->next++)
+        {
+            GLsizei first = job * perJob;
+            compressRows(*source, format, out, first, std::min(first + perJob, blocksHigh));
+
+            std::lock_guard<std::mutex> lock(rows->mutex);
+            if(++rows->finished == jobCount)
+                rows->done.notify_all();
+        }
+    };
+
+    const unsigned int helpers = std::min<unsigned int>(pool->size(), (unsigned int)jobCount - 1);
+    for(unsigned int i = 0; i < helpers; ++i)
+        pool->submit(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(rows->mutex);
+    rows->done.wait(lock, [&rows, jobCount]() { return rows->finished == jobCount; });
+}
@@ -0,0 +1,331 @@
+#include "Renderer/DrawQueue.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/InstanceBatcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const std::uint64_t NAME_MASK  = 0xFFF;
+    const std::uint64_t DEPTH_MASK = (1u << 23) - 1;
+
+    std::uint64_t quantizeDepth(float depth)
+    {
+        depth = std::min(std::max(depth, 0.0f), 1.0f);
+        return (std::uint64_t)(depth * (float)DEPTH_MASK) & DEPTH_MASK;
+    }
+
+    std::size_t indexSize(GLenum indexType)
+    {
+        switch(indexType)
+        {
+        case GL_UNSIGNED_BYTE:  return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        default:                return 4;
+        }
+    }
+
+    // gl_DrawIDARB, which the draws of a multi draw need to find their element in the Draws array.
+    bool hasShaderDrawParameters()
+    {
+        GLint extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+
+        for(GLint i = 0; i < extensions; ++i)
+        {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+            if(std::strcmp(name, "GL_ARB_shader_draw_parameters") == 0)
+                return true;
+        }
+        return false;
+    }
+}
+
+DrawPacket::DrawPacket()
+    : program(0), vertexArray(0), texture(0),
+      mode(GL_TRIANGLES), count(0), indexType(GL_UNSIGNED_INT), firstIndex(0), baseVertex(0),
+      instanceCount(1), baseInstance(0), instanceBuffer(0), instanceLocation(0),
+      depth(0.0f), layer(0), blended(false)
+{
+    block.object.model        = glm::mat4(1.0f);
+    block.object.normalMatrix = glm::mat4(1.0f);
+    block.material.color      = glm::vec4(1.0f);
+    block.material.parameters = glm::vec4(0.0f);
+}
+
+// ------------------------------------------------------------------------
+void radixSort(DrawSortEntry* entries, DrawSortEntry* scratch, std::size_t count)
+{
+    // One read of the keys builds the histograms of all 8 passes.
+    std::uint32_t histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        std::uint64_t key = entries[i].key;
+        for(int pass = 0; pass < 8; ++pass)
+            ++histograms[pass][(key >> (pass * 8)) & 0xFF];
+    }
+
+    DrawSortEntry* source      = entries;
+    DrawSortEntry* destination = scratch;
+
+    for(int pass = 0; pass < 8; ++pass)
+    {
+        std::uint32_t* histogram = histograms[pass];
+
+        // Every key has the same byte here, the pass would not move anything.
+        if(count == 0 || histogram[(source[0].key >> (pass * 8)) & 0xFF] == count)
+            continue;
+
+        std::uint32_t offset = 0;
+        for(int digit = 0; digit < 256; ++digit)
+        {
+            std::uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            const DrawSortEntry &entry = source[i];
+            destination[histogram[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+        }
+
+        std::swap(source, destination);
+    }
+
+    if(source != entries)
+        std::memcpy(entries, source, count * sizeof(DrawSortEntry));
+}
+
+// ------------------------------------------------------------------------
+DrawQueue::DrawQueue(std::size_t capacity)
+    : sorted(true), multiDrawSupported(GLAD_GL_VERSION_4_3 && hasShaderDrawParameters()), multiDraw(multiDrawSupported)
+{
+    packets.reserve(capacity);
+    entries.reserve(capacity);
+    scratch.reserve(capacity);
+
+    std::memset(&lastStats, 0, sizeof(lastStats));
+}
+
+void DrawQueue::setMultiDrawIndirect(bool enabled)
+{
+    multiDraw = enabled && multiDrawSupported;
+}
+
+std::uint64_t DrawQueue::makeKey(const DrawPacket &packet)
+{
+    std::uint64_t layer   = (std::uint64_t)(packet.layer & 0xF) << 60;
+    std::uint64_t program = packet.program & NAME_MASK;
+    std::uint64_t vao     = packet.vertexArray & NAME_MASK;
+    std::uint64_t texture = packet.texture & NAME_MASK;
+    std::uint64_t depth   = quantizeDepth(packet.depth);
+
+    if(!packet.blended)
+        return layer | (program << 47) | (vao << 35) | (texture << 23) | depth;
+
+    return layer | (1ull << 59) | ((DEPTH_MASK - depth) << 36) | (program << 24) | (vao << 12) | texture;
+}
+
+void DrawQueue::push(const DrawPacket &packet)
+{
+    DrawSortEntry entry = { makeKey(packet), (std::uint32_t)packets.size() };
+    entries.push_back(entry);
+    packets.push_back(packet);
+    sorted = false;
+}
+
+void DrawQueue::clear()
+{
+    packets.clear();
+    entries.clear();
+    sorted = true;
+}
+
+void DrawQueue::sort()
+{
+    if(sorted)
+        return;
+
+    scratch.resize(entries.size());
+    radixSort(entries.data(), scratch.data(), entries.size());
+    sorted = true;
+}
+
+// ------------------------------------------------------------------------
+void DrawQueue::submit(GLStateCache &state, UniformRingBuffer* uniforms)
+{
+    sort();
+
+    blockArrays.clear();
+    if(uniforms != nullptr)
+        writeBlocks(*uniforms);
+
+    buildRuns(multiDraw && uniforms != nullptr);
+
+    // All indirect commands of the frame in one ring allocation; on failure the runs are drawn packet by packet.
+    UniformAllocation indirect = { 0, 0, nullptr };
+    if(!commands.empty())
+    {
+        indirect = uniforms->allocate((GLsizeiptr)(commands.size() * sizeof(DrawElementsIndirectCommand)));
+        if(indirect.isValid())
+        {
+            std::memcpy(indirect.data, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+            state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, uniforms->handle());
+        }
+    }
+
+    if(uniforms != nullptr)
+        uniforms->flush();
+
+    DrawQueueStats stats;
+    std::memset(&stats, 0, sizeof(stats));
+
+    // Count against what the previous run used; the state cache filters the calls themselves.
+    const DrawPacket* previous = nullptr;
+
+    for(std::size_t r = 0; r < runs.size(); ++r)
+    {
+        const Run        &run    = runs[r];
+        const DrawPacket &packet = packets[entries[run.first].packet];
+
+        if(!previous || previous->program != packet.program)
+            ++stats.programChanges;
+        if(!previous || previous->vertexArray != packet.vertexArray)
+            ++stats.vertexArrayChanges;
+        if(!previous || previous->texture != packet.texture)
+            ++stats.textureChanges;
+        previous = &packet;
+
+        applyState(state, packet);
+        stats.draws += (unsigned int)(run.last - run.first);
+
+        // Runs never cross an array, so the whole run reads the one bound here.
+        const std::size_t array = run.first / DRAW_BLOCK_CAPACITY;
+        if(array < blockArrays.size() && blockArrays[array].isValid())
+            uniforms->bind(DRAW_BLOCK_BINDING, blockArrays[array]);
+
+        if(run.last - run.first > 1 && indirect.isValid())
+        {
+            // The draws of the run add their gl_DrawIDARB to the first one's element.
+            glVertexAttribI1ui(DRAW_INDEX_LOCATION, (GLuint)(run.first % DRAW_BLOCK_CAPACITY));
+            const GLintptr offset = indirect.offset + (GLintptr)(run.command * sizeof(DrawElementsIndirectCommand));
+            glMultiDrawElementsIndirect(packet.mode, packet.indexType, (const void*)offset, (GLsizei)(run.last - run.first), 0);
+            ++stats.drawCalls;
+            ++stats.multiDraws;
+            continue;
+        }
+
+        for(std::size_t i = run.first; i < run.last; ++i)
+        {
+            glVertexAttribI1ui(DRAW_INDEX_LOCATION, (GLuint)(i % DRAW_BLOCK_CAPACITY));
+            draw(state, packets[entries[i].packet]);
+            ++stats.drawCalls;
+        }
+    }
+
+    lastStats = stats;
+}
+
+// ------------------------------------------------------------------------
+// Per-draw data doesn't matter, it is indexed. The index type and instance attributes have to match
+// for the packets to be one glMultiDrawElementsIndirect call.
+bool DrawQueue::sameState(const DrawPacket &a, const DrawPacket &b)
+{
+    return a.program == b.program && a.vertexArray == b.vertexArray && a.texture == b.texture
+        && a.blended == b.blended && a.mode == b.mode && a.indexType == b.indexType
+        && a.instanceBuffer == b.instanceBuffer && a.instanceLocation == b.instanceLocation;
+}
+
+// Copies the blocks of the sorted packets into Draws arrays of DRAW_BLOCK_CAPACITY elements. Each array is
+// allocated at its full declared size, which the bound range has to cover, even when the last one is only partly used.
+void DrawQueue::writeBlocks(UniformRingBuffer &uniforms)
+{
+    for(std::size_t first = 0; first < entries.size(); first += DRAW_BLOCK_CAPACITY)
+    {
+        UniformAllocation array = uniforms.allocate(DRAW_BLOCK_CAPACITY * sizeof(DrawBlock));
+        blockArrays.push_back(array);
+        if(!array.isValid())
+            continue;
+
+        DrawBlock* blocks = static_cast<DrawBlock*>(array.data);
+        std::size_t last = std::min(first + DRAW_BLOCK_CAPACITY, entries.size());
+        for(std::size_t i = first; i < last; ++i)
+            blocks[i - first] = packets[entries[i].packet].block;
+    }
+}
+
+// Splits the sorted packets into runs of identical state within one Draws array, and writes indirect commands for the runs that get multi drawn.
+void DrawQueue::buildRuns(bool multiDrawRuns)
+{
+    runs.clear();
+    commands.clear();
+
+    for(std::size_t first = 0; first < entries.size(); )
+    {
+        const DrawPacket &packet = packets[entries[first].packet];
+
+        std::size_t last = first + 1;
+        while(last < entries.size() && last % DRAW_BLOCK_CAPACITY != 0 && sameState(packet, packets[entries[last].packet]))
+            ++last;
+
+        Run run = { first, last, commands.size() };
+        runs.push_back(run);
+
+        if(multiDrawRuns && last - first > 1)
+        {
+            for(std::size_t i = first; i < last; ++i)
+            {
+                const DrawPacket &member = packets[entries[i].packet];
+                DrawElementsIndirectCommand command = { (GLuint)member.count, (GLuint)member.instanceCount, member.firstIndex, member.baseVertex, member.baseInstance };
+                commands.push_back(command);
+            }
+        }
+
+        first = last;
+    }
+}
+
+void DrawQueue::applyState(GLStateCache &state, const DrawPacket &packet)
+{
+    state.useProgram(packet.program);
+    state.bindVertexArray(packet.vertexArray);
+    // Also for 0, or the previous packet's texture would stay bound.
+    state.bindTexture(0, GL_TEXTURE_2D, packet.texture);
+
+    state.setEnabled(GL_BLEND, packet.blended);
+    state.depthMask(packet.blended ? GL_FALSE : GL_TRUE);
+    if(packet.blended)
+        state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void DrawQueue::draw(GLStateCache &state, const DrawPacket &packet)
+{
+    const void* offset = (const void*)(std::uintptr_t)(packet.firstIndex * indexSize(packet.indexType));
+    if(packet.instanceBuffer != 0)
+    {
+        if(GLAD_GL_VERSION_4_2)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(packet.mode, packet.count, packet.indexType, offset, packet.instanceCount, packet.baseVertex, packet.baseInstance);
+        }
+        else
+        {
+            // No base instance before GL 4.2, point the instance attributes at this batch instead.
+            state.bindBuffer(GL_ARRAY_BUFFER, packet.instanceBuffer);
+            InstanceBatcher::pointAttributes(packet.instanceLocation, packet.baseInstance);
+            glDrawElementsInstancedBaseVertex(packet.mode, packet.count, packet.indexType, offset, packet.instanceCount, packet.baseVertex);
+        }
+    }
+    else if(packet.baseVertex != 0)
+    {
+        glDrawElementsBaseVertex(packet.mode, packet.count, packet.indexType, offset, packet.baseVertex);
+    }
+    else
+    {
+        glDrawElements(packet.mode, packet.count, packet.indexType, offset);
+    }
+}
@@ -0,0 +1,407 @@
+#include "Renderer/GLStateCache.hpp"
+
+namespace
+{
+    thread_local GLStateCache* currentCache = nullptr;
+}
+
+GLStateCache::GLStateCache()
+{
+    frame.issued           = 0;
+    frame.filtered         = 0;
+    previousFrame.issued   = 0;
+    previousFrame.filtered = 0;
+
+    invalidate();
+}
+
+GLStateCache* GLStateCache::current()
+{
+    return currentCache;
+}
+
+void GLStateCache::makeCurrent()
+{
+    currentCache = this;
+}
+
+void GLStateCache::clearCurrent()
+{
+    currentCache = nullptr;
+}
+
+void GLStateCache::invalidate()
+{
+    program     = UNKNOWN;
+    vertexArray = UNKNOWN;
+    for(int i = 0; i < BUFFER_TARGET_COUNT; ++i)
+        buffers[i] = UNKNOWN;
+    for(int i = 0; i < 2; ++i)
+        for(unsigned int j = 0; j < MAX_BUFFER_BINDINGS; ++j)
+            ranges[i][j].buffer = UNKNOWN;
+
+    activeUnit = UNKNOWN;
+    for(unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        for(int j = 0; j < TEXTURE_TARGET_COUNT; ++j)
+            textures[i][j] = UNKNOWN;
+        samplers[i] = UNKNOWN;
+    }
+
+    for(int i = 0; i < CAPABILITY_COUNT; ++i)
+        enabled[i] = -1;
+    for(int i = 0; i < 4; ++i)
+        blendFuncs[i] = UNKNOWN;
+    blendEquations[0] = UNKNOWN;
+    blendEquations[1] = UNKNOWN;
+    depthFunction = UNKNOWN;
+    depthWrite    = -1;
+    scissorKnown  = false;
+    viewportKnown = false;
+}
+
+void GLStateCache::beginFrame()
+{
+    previousFrame  = frame;
+    frame.issued   = 0;
+    frame.filtered = 0;
+}
+
+// ------------------------------------------------------------------------
+void GLStateCache::useProgram(GLuint program)
+{
+    if(redundant(this->program == program))
+        return;
+
+    glUseProgram(program);
+    this->program = program;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray)
+{
+    if(redundant(this->vertexArray == vertexArray))
+        return;
+
+    glBindVertexArray(vertexArray);
+    this->vertexArray = vertexArray;
+
+    // The element buffer binding belongs to the vertex array.
+    buffers[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = bufferTarget(target);
+    if(slot < 0)
+    {
+        redundant(false);
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if(redundant(buffers[slot] == buffer))
+        return;
+
+    glBindBuffer(target, buffer);
+    buffers[slot] = buffer;
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // A whole buffer binding can't be told apart from a range by its size alone, track it as size 0.
+    int slot = indexedTarget(target);
+    if(slot >= 0 && index < MAX_BUFFER_BINDINGS)
+    {
+        BufferRange &range = ranges[slot][index];
+        if(redundant(range.buffer == buffer && range.offset == 0 && range.size == 0))
+            return;
+
+        range.buffer = buffer;
+        range.offset = 0;
+        range.size   = 0;
+    }
+    else
+    {
+        redundant(false);
+    }
+
+    glBindBufferBase(target, index, buffer);
+
+    // Also binds the generic target.
+    slot = bufferTarget(target);
+    if(slot >= 0)
+        buffers[slot] = buffer;
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    int slot = indexedTarget(target);
+    if(slot >= 0 && index < MAX_BUFFER_BINDINGS)
+    {
+        BufferRange &range = ranges[slot][index];
+        if(redundant(range.buffer == buffer && range.offset == offset && range.size == size))
+            return;
+
+        range.buffer = buffer;
+        range.offset = offset;
+        range.size   = size;
+    }
+    else
+    {
+        redundant(false);
+    }
+
+    glBindBufferRange(target, index, buffer, offset, size);
+
+    slot = bufferTarget(target);
+    if(slot >= 0)
+        buffers[slot] = buffer;
+}
+
+void GLStateCache::activeTexture(GLenum texture)
+{
+    if(redundant(activeUnit == texture))
+        return;
+
+    glActiveTexture(texture);
+    activeUnit = texture;
+}
+
+void GLStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = textureTarget(target);
+    if(slot < 0 || unit >= MAX_TEXTURE_UNITS)
+    {
+        activeTexture(GL_TEXTURE0 + unit);
+        redundant(false);
+        glBindTexture(target, texture);
+        return;
+    }
+
+    if(redundant(textures[unit][slot] == texture))
+        return;
+
+    activeTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, texture);
+    textures[unit][slot] = texture;
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler)
+{
+    if(unit < MAX_TEXTURE_UNITS)
+    {
+        if(redundant(samplers[unit] == sampler))
+            return;
+        samplers[unit] = sampler;
+    }
+    else
+    {
+        redundant(false);
+    }
+
+    glBindSampler(unit, sampler);
+}
+
+// ------------------------------------------------------------------------
+void GLStateCache::setEnabled(GLenum capability, bool enabled)
+{
+    int slot = GLStateCache::capability(capability);
+    if(slot >= 0)
+    {
+        if(redundant(this->enabled[slot] == (enabled ? 1 : 0)))
+            return;
+        this->enabled[slot] = enabled ? 1 : 0;
+    }
+    else
+    {
+        redundant(false);
+    }
+
+    if(enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+}
+
+void GLStateCache::blendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha, GLenum destinationAlpha)
+{
+    if(redundant(blendFuncs[0] == sourceRgb && blendFuncs[1] == destinationRgb && blendFuncs[2] == sourceAlpha && blendFuncs[3] == destinationAlpha))
+        return;
+
+    glBlendFuncSeparate(sourceRgb, destinationRgb, sourceAlpha, destinationAlpha);
+    blendFuncs[0] = sourceRgb;
+    blendFuncs[1] = destinationRgb;
+    blendFuncs[2] = sourceAlpha;
+    blendFuncs[3] = destinationAlpha;
+}
+
+void GLStateCache::blendEquationSeparate(GLenum modeRgb, GLenum modeAlpha)
+{
+    if(redundant(blendEquations[0] == modeRgb && blendEquations[1] == modeAlpha))
+        return;
+
+    glBlendEquationSeparate(modeRgb, modeAlpha);
+    blendEquations[0] = modeRgb;
+    blendEquations[1] = modeAlpha;
+}
+
+void GLStateCache::depthFunc(GLenum function)
+{
+    if(redundant(depthFunction == function))
+        return;
+
+    glDepthFunc(function);
+    depthFunction = function;
+}
+
+void GLStateCache::depthMask(GLboolean mask)
+{
+    if(redundant(depthWrite == (mask ? 1 : 0)))
+        return;
+
+    glDepthMask(mask);
+    depthWrite = mask ? 1 : 0;
+}
+
+void GLStateCache::scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if(redundant(scissorKnown && scissorBox[0] == x && scissorBox[1] == y && scissorBox[2] == width && scissorBox[3] == height))
+        return;
+
+    glScissor(x, y, width, height);
+    scissorBox[0] = x;
+    scissorBox[1] = y;
+    scissorBox[2] = width;
+    scissorBox[3] = height;
+    scissorKnown  = true;
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if(redundant(viewportKnown && viewportBox[0] == x && viewportBox[1] == y && viewportBox[2] == width && viewportBox[3] == height))
+        return;
+
+    glViewport(x, y, width, height);
+    viewportBox[0] = x;
+    viewportBox[1] = y;
+    viewportBox[2] = width;
+    viewportBox[3] = height;
+    viewportKnown  = true;
+}
+
+// ------------------------------------------------------------------------
+void GLStateCache::programDeleted(GLuint program)
+{
+    // Deleting the program in use only flags it, it stays bound until something else is used.
+    if(this->program == program)
+        this->program = UNKNOWN;
+}
+
+void GLStateCache::vertexArrayDeleted(GLuint vertexArray)
+{
+    if(this->vertexArray == vertexArray)
+    {
+        this->vertexArray = 0;
+        buffers[ELEMENT_ARRAY_BUFFER] = UNKNOWN;
+    }
+}
+
+void GLStateCache::bufferDeleted(GLuint buffer)
+{
+    for(int i = 0; i < BUFFER_TARGET_COUNT; ++i)
+    {
+        if(buffers[i] == buffer)
+            buffers[i] = 0;
+    }
+    for(int i = 0; i < 2; ++i)
+    {
+        for(unsigned int j = 0; j < MAX_BUFFER_BINDINGS; ++j)
+        {
+            if(ranges[i][j].buffer == buffer)
+                ranges[i][j].buffer = UNKNOWN;
+        }
+    }
+}
+
+void GLStateCache::textureDeleted(GLuint texture)
+{
+    for(unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        for(int j = 0; j < TEXTURE_TARGET_COUNT; ++j)
+        {
+            if(textures[i][j] == texture)
+                textures[i][j] = 0;
+        }
+    }
+}
+
+void GLStateCache::samplerDeleted(GLuint sampler)
+{
+    for(unsigned int i = 0; i < MAX_TEXTURE_UNITS; ++i)
+    {
+        if(samplers[i] == sampler)
+            samplers[i] = 0;
+    }
+}
+
+// ------------------------------------------------------------------------
+bool GLStateCache::redundant(bool unchanged)
+{
+    if(unchanged)
+        ++frame.filtered;
+    else
+        ++frame.issued;
+    return unchanged;
+}
+
+int GLStateCache::bufferTarget(GLenum target)
+{
+    switch(target)
+    {
+    case GL_ARRAY_BUFFER:          return ARRAY_BUFFER;
+    case GL_ELEMENT_ARRAY_BUFFER:  return ELEMENT_ARRAY_BUFFER;
+    case GL_UNIFORM_BUFFER:        return UNIFORM_BUFFER;
+    case GL_SHADER_STORAGE_BUFFER: return SHADER_STORAGE_BUFFER;
+    case GL_DRAW_INDIRECT_BUFFER:  return DRAW_INDIRECT_BUFFER;
+    case GL_PIXEL_PACK_BUFFER:     return PIXEL_PACK_BUFFER;
+    case GL_PIXEL_UNPACK_BUFFER:   return PIXEL_UNPACK_BUFFER;
+    case GL_COPY_READ_BUFFER:      return COPY_READ_BUFFER;
+    case GL_COPY_WRITE_BUFFER:     return COPY_WRITE_BUFFER;
+    default:                       return -1;
+    }
+}
+
+int GLStateCache::indexedTarget(GLenum target)
+{
+    switch(target)
+    {
+    case GL_UNIFORM_BUFFER:        return 0;
+    case GL_SHADER_STORAGE_BUFFER: return 1;
+    default:                       return -1;
+    }
+}
+
+int GLStateCache::textureTarget(GLenum target)
+{
+    switch(target)
+    {
+    case GL_TEXTURE_2D:       return TEXTURE_2D;
+    case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+    case GL_TEXTURE_3D:       return TEXTURE_3D;
+    case GL_TEXTURE_CUBE_MAP: return TEXTURE_CUBE_MAP;
+    default:                  return -1;
+    }
+}
+
+int GLStateCache::capability(GLenum capability)
+{
+    switch(capability)
+    {
+    case GL_BLEND:        return BLEND;
+    case GL_CULL_FACE:    return CULL_FACE;
+    case GL_DEPTH_TEST:   return DEPTH_TEST;
+    case GL_SCISSOR_TEST: return SCISSOR_TEST;
+    case GL_STENCIL_TEST: return STENCIL_TEST;
+    default:              return -1;
+    }
+}
@@ -0,0 +1,224 @@
+#include "Renderer/GeometryArena.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+RangeAllocator::RangeAllocator(GLuint capacity)
+    : total(0), inUse(0)
+{
+    grow(capacity);
+}
+
+GLuint RangeAllocator::allocate(GLuint size)
+{
+    if(size == 0)
+        return INVALID;
+
+    for(std::map<GLuint, GLuint>::iterator range = freeRanges.begin(); range != freeRanges.end(); ++range)
+    {
+        if(range->second < size)
+            continue;
+
+        GLuint offset    = range->first;
+        GLuint remaining = range->second - size;
+        freeRanges.erase(range);
+        if(remaining > 0)
+            freeRanges[offset + size] = remaining;
+
+        inUse += size;
+        return offset;
+    }
+    return INVALID;
+}
+
+void RangeAllocator::release(GLuint offset, GLuint size)
+{
+    if(size == 0)
+        return;
+    inUse -= size;
+
+    std::map<GLuint, GLuint>::iterator next = freeRanges.lower_bound(offset);
+
+    // Merge with the free range right after, then the one right before.
+    if(next != freeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    if(next != freeRanges.begin())
+    {
+        std::map<GLuint, GLuint>::iterator previous = next;
+        --previous;
+        if(previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+void RangeAllocator::grow(GLuint capacity)
+{
+    if(capacity <= total)
+        return;
+
+    GLuint added = capacity - total;
+    GLuint start = total;
+    total  = capacity;
+    inUse += added;
+    release(start, added);
+}
+
+// ------------------------------------------------------------------------
+GeometryArena::GeometryArena(GLStateCache &state, const VertexLayout &layout, GLuint vertexCapacity, GLuint indexCapacity)
+    : state(state), vertexLayout(layout), vao(0), vertexBuffer(0), indexBuffer(0),
+      vertices(vertexCapacity), indices(indexCapacity)
+{
+    glGenVertexArrays(1, &vao);
+    createVertexBuffer(vertexCapacity);
+    createIndexBuffer(indexCapacity);
+}
+
+GeometryArena::~GeometryArena()
+{
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+
+    state.vertexArrayDeleted(vao);
+    state.bufferDeleted(vertexBuffer);
+    state.bufferDeleted(indexBuffer);
+}
+
+// Allocate a buffer and point the vertex array at it; the old buffer (if any) is left to the caller.
+void GeometryArena::createVertexBuffer(GLuint capacity)
+{
+    glGenBuffers(1, &vertexBuffer);
+
+    state.bindVertexArray(vao);
+    state.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * vertexLayout.stride(), nullptr, GL_STATIC_DRAW);
+    vertexLayout.apply();
+}
+
+void GeometryArena::createIndexBuffer(GLuint capacity)
+{
+    glGenBuffers(1, &indexBuffer);
+
+    state.bindVertexArray(vao);
+    state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+}
+
+// ------------------------------------------------------------------------
+MeshRange GeometryArena::allocate(GLuint vertexCount, GLuint indexCount)
+{
+    MeshRange range = { 0, 0, 0, 0 };
+
+    GLuint baseVertex = vertices.allocate(vertexCount);
+    if(baseVertex == RangeAllocator::INVALID)
+    {
+        growVertices(vertexCount);
+        baseVertex = vertices.allocate(vertexCount);
+    }
+
+    GLuint firstIndex = indices.allocate(indexCount);
+    if(firstIndex == RangeAllocator::INVALID)
+    {
+        growIndices(indexCount);
+        firstIndex = indices.allocate(indexCount);
+    }
+
+    if(baseVertex == RangeAllocator::INVALID || firstIndex == RangeAllocator::INVALID)
+    {
+        std::cout << "ERROR::GEOMETRY_ARENA::ALLOCATION_FAILED " << vertexCount << " vertices, " << indexCount << " indices" << std::endl;
+        if(baseVertex != RangeAllocator::INVALID)
+            vertices.release(baseVertex, vertexCount);
+        if(firstIndex != RangeAllocator::INVALID)
+            indices.release(firstIndex, indexCount);
+        return range;
+    }
+
+    range.baseVertex  = baseVertex;
+    range.vertexCount = vertexCount;
+    range.firstIndex  = firstIndex;
+    range.indexCount  = indexCount;
+    return range;
+}
+
+void GeometryArena::release(const MeshRange &range)
+{
+    if(!range.isValid())
+        return;
+
+    vertices.release(range.baseVertex, range.vertexCount);
+    indices.release(range.firstIndex, range.indexCount);
+}
+
+MeshRange GeometryArena::add(const void* vertexData, GLuint vertexCount, const GLuint* indexData, GLuint indexCount)
+{
+    MeshRange range = allocate(vertexCount, indexCount);
+    if(range.isValid())
+        upload(range, vertexData, indexData);
+    return range;
+}
+
+void GeometryArena::upload(const MeshRange &range, const void* vertexData, const GLuint* indexData)
+{
+    // The copy targets leave the vertex array's bindings alone.
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)range.baseVertex * vertexLayout.stride(), (GLsizeiptr)range.vertexCount * vertexLayout.stride(), vertexData);
+
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)range.firstIndex * sizeof(GLuint), (GLsizeiptr)range.indexCount * sizeof(GLuint), indexData);
+}
+
+DrawPacket GeometryArena::packet(const MeshRange &range) const
+{
+    DrawPacket packet;
+    packet.vertexArray = vao;
+    packet.mode        = GL_TRIANGLES;
+    packet.count       = (GLsizei)range.indexCount;
+    packet.indexType   = GL_UNSIGNED_INT;
+    packet.firstIndex  = range.firstIndex;
+    packet.baseVertex  = (GLint)range.baseVertex;
+    return packet;
+}
+
+// ------------------------------------------------------------------------
+// Only the buffer that ran out is replaced. The new space is appended at the end, so it alone has to fit the request.
+void GeometryArena::growVertices(GLuint needed)
+{
+    GLuint capacity = vertices.capacity();
+    GLuint grown    = std::max(capacity * 2, capacity + needed);
+
+    GLuint oldBuffer = vertexBuffer;
+    createVertexBuffer(grown);
+    replaceBuffer(oldBuffer, vertexBuffer, (GLsizeiptr)capacity * vertexLayout.stride());
+    vertices.grow(grown);
+}
+
+void GeometryArena::growIndices(GLuint needed)
+{
+    GLuint capacity = indices.capacity();
+    GLuint grown    = std::max(capacity * 2, capacity + needed);
+
+    GLuint oldBuffer = indexBuffer;
+    createIndexBuffer(grown);
+    replaceBuffer(oldBuffer, indexBuffer, (GLsizeiptr)capacity * sizeof(GLuint));
+    indices.grow(grown);
+}
+
+// Copies the old contents over on the GPU, then deletes the old buffer.
+void GeometryArena::replaceBuffer(GLuint oldBuffer, GLuint newBuffer, GLsizeiptr size)
+{
+    state.bindBuffer(GL_COPY_READ_BUFFER, oldBuffer);
+    state.bindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, size);
+
+    glDeleteBuffers(1, &oldBuffer);
+    state.bufferDeleted(oldBuffer);
+}
@@ -0,0 +1,238 @@
+#include "Renderer/Image.hpp"
+
+#include "Renderer/MappedFile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    // Rows come out of both formats top first unless flagged otherwise; GL wants the bottom first.
+    void flipRows(Image &image)
+    {
+        const std::size_t rowSize = (std::size_t)image.width * 4;
+        std::vector<unsigned char> row(rowSize);
+        for(GLsizei top = 0, bottom = image.height - 1; top < bottom; ++top, --bottom)
+        {
+            unsigned char* a = &image.pixels[top * rowSize];
+            unsigned char* b = &image.pixels[bottom * rowSize];
+            std::memcpy(row.data(), a, rowSize);
+            std::memcpy(a, b, rowSize);
+            std::memcpy(b, row.data(), rowSize);
+        }
+    }
+
+    // One TGA pixel (BGR(A) or gray) to RGBA.
+    void expandPixel(const unsigned char* in, int bytes, unsigned char* out)
+    {
+        if(bytes == 1)
+        {
+            out[0] = out[1] = out[2] = in[0];
+            out[3] = 255;
+            return;
+        }
+        out[0] = in[2];
+        out[1] = in[1];
+        out[2] = in[0];
+        out[3] = bytes == 4 ? in[3] : 255;
+    }
+
+    bool decodeTga(const unsigned char* data, std::size_t size, Image &image)
+    {
+        const std::size_t HEADER_SIZE = 18;
+        if(size < HEADER_SIZE)
+            return false;
+
+        int imageType    = data[2];
+        int width        = data[12] | (data[13] << 8);
+        int height       = data[14] | (data[15] << 8);
+        int bytes        = data[16] / 8;
+        bool topFirst    = (data[17] & 0x20) != 0;
+        bool compressed  = imageType == 10 || imageType == 11;
+
+        if(data[1] != 0 || (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11)
+            || (bytes != 1 && bytes != 3 && bytes != 4) || width == 0 || height == 0)
+            return false;
+
+        // The ID field is skipped; it has to end inside the file too.
+        if(size < HEADER_SIZE + data[0])
+            return false;
+
+        const unsigned char* in  = data + HEADER_SIZE + data[0];
+        const unsigned char* end = data + size;
+
+        image = Image(width, height);
+        unsigned char* out       = image.pixels.data();
+        unsigned char* outEnd    = out + image.size();
+
+        if(!compressed)
+        {
+            if((std::size_t)(end - in) < (std::size_t)width * height * bytes)
+                return false;
+            for(; out < outEnd; out += 4, in += bytes)
+                expandPixel(in, bytes, out);
+        }
+        else
+        {
+            // Packets: a header byte, then one pixel repeated (bit 7 set) or a run of literal pixels.
+            while(out < outEnd)
+            {
+                if(in >= end)
+                    return false;
+                int  count    = (*in & 0x7F) + 1;
+                bool repeated = (*in & 0x80) != 0;
+                ++in;
+
+                std::size_t needed = repeated ? bytes : (std::size_t)count * bytes;
+                if((std::size_t)(end - in) < needed || (std::size_t)(outEnd - out) < (std::size_t)count * 4)
+                    return false;
+
+                for(int i = 0; i < count; ++i, out += 4)
+                    expandPixel(repeated ? in : in + i * bytes, bytes, out);
+                in += needed;
+            }
+        }
+
+        if(topFirst)
+            flipRows(image);
+        return true;
+    }
+
+    // Next whitespace separated number of a PNM header, skipping '#' comments.
+    bool readHeaderNumber(const unsigned char* &in, const unsigned char* end, int &value)
+    {
+        while(in < end && (std::isspace(*in) || *in == '#'))
+        {
+            if(*in == '#')
+                while(in < end && *in != '\n')
+                    ++in;
+            else
+                ++in;
+        }
+
+        if(in >= end || !std::isdigit(*in))
+            return false;
+
+        value = 0;
+        while(in < end && std::isdigit(*in) && value < 65536)
+            value = value * 10 + (*in++ - '0');
+        return true;
+    }
+
+    bool decodePnm(const unsigned char* data, std::size_t size, Image &image)
+    {
+        if(size < 2 || data[0] != 'P' || (data[1] != '5' && data[1] != '6'))
+            return false;
+
+        const int channels = data[1] == '6' ? 3 : 1;
+        const unsigned char* in  = data + 2;
+        const unsigned char* end = data + size;
+
+        int width, height, maximum;
+        if(!readHeaderNumber(in, end, width) || !readHeaderNumber(in, end, height) || !readHeaderNumber(in, end, maximum))
+            return false;
+        if(width == 0 || height == 0 || maximum == 0 || maximum > 255 || in >= end)
+            return false;
+        ++in;  // The single whitespace before the pixels.
+
+        if((std::size_t)(end - in) < (std::size_t)width * height * channels)
+            return false;
+
+        image = Image(width, height);
+        unsigned char* out = image.pixels.data();
+        for(std::size_t i = 0; i < (std::size_t)width * height; ++i, out += 4, in += channels)
+        {
+            for(int c = 0; c < 3; ++c)
+                out[c] = (unsigned char)(in[channels == 3 ? c : 0] * 255 / maximum);
+            out[3] = 255;
+        }
+
+        flipRows(image);
+        return true;
+    }
+}
+
+// ------------------------------------------------------------------------
+bool decodeImage(const unsigned char* data, std::size_t size, Image &image)
+{
+    if(size >= 2 && data[0] == 'P')
+        return decodePnm(data, size, image);
+    return decodeTga(data, size, image);
+}
+
+bool loadImage(const std::string &path, Image &image)
+{
+    MappedFile file;
+    if(!file.open(path))
+        return false;
+
+    if(!decodeImage(file.data(), file.size(), image))
+    {
+        std::cout << "ERROR::IMAGE::UNSUPPORTED_FORMAT " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool writeImage(const std::string &path, const Image &image)
+{
+    unsigned char header[18] = { 0 };
+    header[2]  = 2;                     // Uncompressed true color.
+    header[12] = (unsigned char)(image.width & 0xFF);
+    header[13] = (unsigned char)(image.width >> 8);
+    header[14] = (unsigned char)(image.height & 0xFF);
+    header[15] = (unsigned char)(image.height >> 8);
+    header[16] = 32;
+    header[17] = 8;                     // 8 alpha bits, bottom row first.
+
+    std::vector<unsigned char> bgra(image.pixels);
+    for(std::size_t i = 0; i < bgra.size(); i += 4)
+        std::swap(bgra[i], bgra[i + 2]);
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write((const char*)header, sizeof(header));
+    out.write((const char*)bgra.data(), (std::streamsize)bgra.size());
+    if(!out)
+    {
+        std::cout << "ERROR::IMAGE::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ImageDifference compareImages(const Image &a, const Image &b, int tolerance)
+{
+    ImageDifference difference = { a.width == b.width && a.height == b.height, 0, 0, 0.0 };
+    if(!difference.sameSize)
+    {
+        difference.maxDifference   = 255;
+        difference.differingPixels = (std::size_t)std::max(a.width * a.height, b.width * b.height);
+        return difference;
+    }
+
+    double squaredError = 0.0;
+    for(std::size_t i = 0; i < a.pixels.size(); i += 4)
+    {
+        int pixelDifference = 0;
+        for(int c = 0; c < 4; ++c)
+        {
+            int d = std::abs((int)a.pixels[i + c] - (int)b.pixels[i + c]);
+            pixelDifference = std::max(pixelDifference, d);
+            squaredError   += (double)d * d;
+        }
+        difference.maxDifference = std::max(difference.maxDifference, pixelDifference);
+        if(pixelDifference > tolerance)
+            ++difference.differingPixels;
+    }
+
+    difference.psnr = squaredError > 0.0
+        ? 10.0 * std::log10(255.0 * 255.0 * a.pixels.size() / squaredError)
+        : std::numeric_limits<double>::infinity();
+    return difference;
+}
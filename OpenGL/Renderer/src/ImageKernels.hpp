@@ -0,0 +1,37 @@
+#ifndef __IMAGE_KERNELS_HPP_INCLUDED__
+#define __IMAGE_KERNELS_HPP_INCLUDED__
+
+#include <cstdint>
+
+// Row kernels behind ImageProcessing.cpp, one set per instruction set. Private to the Renderer;
+// nothing inline lives here because the AVX2 set is compiled with different code generation.
+//
+// Box:      out[x] = (a[2x] + a[2x+1] + b[2x] + b[2x+1] + 2) >> 2, per channel, for x < count.
+// Kaiser:   out = clamp((sum w[k] * in[k] + 8192) >> 14, 0, 32767) over the 8 taps.
+//           Horizontal: in[k] is pixel 2x - 3 + k of 'row'; only called where no tap is clamped.
+//           Vertical:   in[k] is element i of rows[k], for every element i < count.
+// Pack:     RGBA8 -> 16-bit, count pixels; each channel c becomes (t + (t >> 8)) >> 8 with
+//           t = c * levels + 128, which is c * levels / 255 rounded to nearest for 8-bit c.
+// Every kernel returns how many outputs it produced; the caller finishes the rest with scalar code.
+// ---------------------------------------------------------------------------------------------
+namespace ImageKernels
+{
+    const int KAISER_TAPS  = 8;
+    const int KAISER_SHIFT = 14;
+
+    int boxRowSSE2(const std::uint16_t* a, const std::uint16_t* b, std::uint16_t* out, int count);
+    int kaiserRowSSE2(const std::uint16_t* row, const std::int16_t* weights, std::uint16_t* out, int first, int last);
+    int kaiserColumnSSE2(const std::uint16_t* const* rows, const std::int16_t* weights, std::uint16_t* out, int count);
+    int packRGB565SSE2(const std::uint8_t* pixels, std::uint16_t* out, int count);
+    int packRGBA4SSE2(const std::uint8_t* pixels, std::uint16_t* out, int count);
+
+    int boxRowAVX2(const std::uint16_t* a, const std::uint16_t* b, std::uint16_t* out, int count);
+    int kaiserRowAVX2(const std::uint16_t* row, const std::int16_t* weights, std::uint16_t* out, int first, int last);
+    int kaiserColumnAVX2(const std::uint16_t* const* rows, const std::int16_t* weights, std::uint16_t* out, int count);
+    int packRGB565AVX2(const std::uint8_t* pixels, std::uint16_t* out, int count);
+    int packRGBA4AVX2(const std::uint8_t* pixels, std::uint16_t* out, int count);
+
+    bool avx2Compiled();
+}
+
+#endif // !__IMAGE_KERNELS_HPP_INCLUDED__
@@ -0,0 +1,171 @@
+#include "ImageKernels.hpp"
+
+// Built with AVX2 code generation (see CMakeLists.txt) and only called after the CPU check in
+// ImageProcessing.cpp, so nothing here may be shared with other translation units: intrinsics only.
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+namespace ImageKernels
+{
+#if defined(__AVX2__)
+    namespace
+    {
+        __m256i weightPair(const std::int16_t* weights, int pair)
+        {
+            int both = (int)(std::uint16_t)weights[pair * 2] | ((int)(std::uint16_t)weights[pair * 2 + 1] << 16);
+            return _mm256_set1_epi32(both);
+        }
+
+        __m256i roundKaiser(__m256i accumulator)
+        {
+            return _mm256_srai_epi32(_mm256_add_epi32(accumulator, _mm256_set1_epi32(1 << (KAISER_SHIFT - 1))), KAISER_SHIFT);
+        }
+
+        // Per 128-bit lane: two pixels to one packed value each, in 32-bit elements 0 and 1.
+        __m256i packPairs(__m256i pixels, __m256i levels, __m256i shifts)
+        {
+            __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, levels), _mm256_set1_epi16(128));
+            __m256i q = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+
+            __m256i sums = _mm256_madd_epi16(q, shifts);
+            sums = _mm256_add_epi32(sums, _mm256_srli_epi64(sums, 32));
+            return _mm256_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        int pack(const std::uint8_t* pixels, std::uint16_t* out, int count, __m256i levels, __m256i shifts)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i bias = _mm256_set1_epi32(32768);
+            const __m256i sign = _mm256_set1_epi16((short)0x8000);
+
+            int i = 0;
+            for(; i + 8 <= count; i += 8)
+            {
+                __m256i source = _mm256_loadu_si256((const __m256i*)(pixels + i * 4));
+
+                // Lane 0 holds pixels 0-3, lane 1 pixels 4-7.
+                __m256i low  = packPairs(_mm256_unpacklo_epi8(source, zero), levels, shifts);
+                __m256i high = packPairs(_mm256_unpackhi_epi8(source, zero), levels, shifts);
+                __m256i both = _mm256_sub_epi32(_mm256_unpacklo_epi64(low, high), bias);
+
+                __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(both, both), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm_storeu_si128((__m128i*)(out + i), _mm256_castsi256_si128(_mm256_xor_si256(packed, sign)));
+            }
+            return i;
+        }
+    }
+
+    bool avx2Compiled()
+    {
+        return true;
+    }
+
+    int boxRowAVX2(const std::uint16_t* a, const std::uint16_t* b, std::uint16_t* out, int count)
+    {
+        const __m256i zero  = _mm256_setzero_si256();
+        const __m256i round = _mm256_set1_epi32(2);
+
+        int x = 0;
+        for(; x + 4 <= count; x += 4)
+        {
+            // Each load covers two output pixels, one per 128-bit lane.
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)(a + x * 8));
+            __m256i a1 = _mm256_loadu_si256((const __m256i*)(a + x * 8 + 16));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)(b + x * 8));
+            __m256i b1 = _mm256_loadu_si256((const __m256i*)(b + x * 8 + 16));
+
+            __m256i s0 = _mm256_add_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(a0, zero), _mm256_unpackhi_epi16(a0, zero)),
+                                          _mm256_add_epi32(_mm256_unpacklo_epi16(b0, zero), _mm256_unpackhi_epi16(b0, zero)));
+            __m256i s1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(a1, zero), _mm256_unpackhi_epi16(a1, zero)),
+                                          _mm256_add_epi32(_mm256_unpacklo_epi16(b1, zero), _mm256_unpackhi_epi16(b1, zero)));
+
+            s0 = _mm256_srli_epi32(_mm256_add_epi32(s0, round), 2);
+            s1 = _mm256_srli_epi32(_mm256_add_epi32(s1, round), 2);
+
+            // packs works per lane: (x, x + 2 | x + 1, x + 3) back into order.
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(s0, s1), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)(out + x * 4), packed);
+        }
+        return x;
+    }
+
+    int kaiserRowAVX2(const std::uint16_t* row, const std::int16_t* weights, std::uint16_t* out, int first, int last)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i pairs[KAISER_TAPS / 2];
+        for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            pairs[j] = weightPair(weights, j);
+
+        int x = first;
+        for(; x + 2 <= last; x += 2)
+        {
+            // Lane 0 computes output x, lane 1 output x + 1, whose taps start two pixels later.
+            const std::uint16_t* taps = row + (x * 2 - 3) * 4;
+
+            __m256i accumulator = zero;
+            for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            {
+                __m128i lower = _mm_loadu_si128((const __m128i*)(taps + j * 8));
+                __m128i upper = _mm_loadu_si128((const __m128i*)(taps + j * 8 + 8));
+                __m256i both  = _mm256_inserti128_si256(_mm256_castsi128_si256(lower), upper, 1);
+                __m256i mixed = _mm256_unpacklo_epi16(both, _mm256_srli_si256(both, 8));
+                accumulator = _mm256_add_epi32(accumulator, _mm256_madd_epi16(mixed, pairs[j]));
+            }
+
+            __m256i result = roundKaiser(accumulator);
+            result = _mm256_max_epi16(_mm256_packs_epi32(result, result), zero);
+            result = _mm256_permute4x64_epi64(result, _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm256_castsi256_si128(result));
+        }
+        return x - first;
+    }
+
+    int kaiserColumnAVX2(const std::uint16_t* const* rows, const std::int16_t* weights, std::uint16_t* out, int count)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i pairs[KAISER_TAPS / 2];
+        for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            pairs[j] = weightPair(weights, j);
+
+        int i = 0;
+        for(; i + 16 <= count; i += 16)
+        {
+            __m256i low  = zero;
+            __m256i high = zero;
+            for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            {
+                __m256i a = _mm256_loadu_si256((const __m256i*)(rows[j * 2] + i));
+                __m256i b = _mm256_loadu_si256((const __m256i*)(rows[j * 2 + 1] + i));
+                low  = _mm256_add_epi32(low,  _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), pairs[j]));
+                high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), pairs[j]));
+            }
+
+            // unpack and packs both work per lane, so the elements come out in order.
+            __m256i result = _mm256_packs_epi32(roundKaiser(low), roundKaiser(high));
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_max_epi16(result, zero));
+        }
+        return i;
+    }
+
+    int packRGB565AVX2(const std::uint8_t* pixels, std::uint16_t* out, int count)
+    {
+        return pack(pixels, out, count, _mm256_set_epi16(0, 31, 63, 31, 0, 31, 63, 31, 0, 31, 63, 31, 0, 31, 63, 31),
+                                        _mm256_set_epi16(0, 1, 32, 2048, 0, 1, 32, 2048, 0, 1, 32, 2048, 0, 1, 32, 2048));
+    }
+
+    int packRGBA4AVX2(const std::uint8_t* pixels, std::uint16_t* out, int count)
+    {
+        return pack(pixels, out, count, _mm256_set1_epi16(15),
+                                        _mm256_set_epi16(1, 16, 256, 4096, 1, 16, 256, 4096, 1, 16, 256, 4096, 1, 16, 256, 4096));
+    }
+#else
+    bool avx2Compiled() { return false; }
+
+    int boxRowAVX2(const std::uint16_t*, const std::uint16_t*, std::uint16_t*, int) { return 0; }
+    int kaiserRowAVX2(const std::uint16_t*, const std::int16_t*, std::uint16_t*, int, int) { return 0; }
+    int kaiserColumnAVX2(const std::uint16_t* const*, const std::int16_t*, std::uint16_t*, int) { return 0; }
+    int packRGB565AVX2(const std::uint8_t*, std::uint16_t*, int) { return 0; }
+    int packRGBA4AVX2(const std::uint8_t*, std::uint16_t*, int) { return 0; }
+#endif
+}
@@ -0,0 +1,160 @@
+#include "ImageKernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define IMAGE_KERNELS_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace ImageKernels
+{
+#ifdef IMAGE_KERNELS_SSE2
+    namespace
+    {
+        // Tap pair (w[2j], w[2j + 1]) repeated, to multiply channel interleaved pixel pairs with madd.
+        __m128i weightPair(const std::int16_t* weights, int pair)
+        {
+            return _mm_set_epi16(weights[pair * 2 + 1], weights[pair * 2], weights[pair * 2 + 1], weights[pair * 2],
+                                 weights[pair * 2 + 1], weights[pair * 2], weights[pair * 2 + 1], weights[pair * 2]);
+        }
+
+        // Four int32 accumulators to rounded, clamped 15-bit values.
+        __m128i roundKaiser(__m128i accumulator)
+        {
+            return _mm_srai_epi32(_mm_add_epi32(accumulator, _mm_set1_epi32(1 << (KAISER_SHIFT - 1))), KAISER_SHIFT);
+        }
+
+        // Two pixels of 8-bit RGBA to one 16-bit value each, in lanes 0 and 1 of the result.
+        __m128i packPair(__m128i pixels, __m128i levels, __m128i shifts)
+        {
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels, levels), _mm_set1_epi16(128));
+            __m128i q = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+
+            // Shifting is a multiply and the channels don't overlap, so the sum of a pixel is its packed value.
+            __m128i sums = _mm_madd_epi16(q, shifts);
+            sums = _mm_add_epi32(sums, _mm_srli_epi64(sums, 32));
+            return _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        int pack(const std::uint8_t* pixels, std::uint16_t* out, int count, __m128i levels, __m128i shifts)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi32(32768);
+            const __m128i sign = _mm_set1_epi16((short)0x8000);
+
+            int i = 0;
+            for(; i + 8 <= count; i += 8)
+            {
+                __m128i first  = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+                __m128i second = _mm_loadu_si128((const __m128i*)(pixels + i * 4 + 16));
+
+                __m128i p01 = packPair(_mm_unpacklo_epi8(first, zero), levels, shifts);
+                __m128i p23 = packPair(_mm_unpackhi_epi8(first, zero), levels, shifts);
+                __m128i p45 = packPair(_mm_unpacklo_epi8(second, zero), levels, shifts);
+                __m128i p67 = packPair(_mm_unpackhi_epi8(second, zero), levels, shifts);
+
+                // Values are up to 65535: bias into the signed range so packs doesn't saturate, then flip back.
+                __m128i low  = _mm_sub_epi32(_mm_unpacklo_epi64(p01, p23), bias);
+                __m128i high = _mm_sub_epi32(_mm_unpacklo_epi64(p45, p67), bias);
+                _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(_mm_packs_epi32(low, high), sign));
+            }
+            return i;
+        }
+    }
+
+    int boxRowSSE2(const std::uint16_t* a, const std::uint16_t* b, std::uint16_t* out, int count)
+    {
+        const __m128i zero  = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi32(2);
+
+        int x = 0;
+        for(; x + 2 <= count; x += 2)
+        {
+            // One load per row covers the two source pixels of one output pixel.
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(a + x * 8));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(a + x * 8 + 8));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(b + x * 8));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(b + x * 8 + 8));
+
+            __m128i s0 = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(a0, zero), _mm_unpackhi_epi16(a0, zero)),
+                                       _mm_add_epi32(_mm_unpacklo_epi16(b0, zero), _mm_unpackhi_epi16(b0, zero)));
+            __m128i s1 = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(a1, zero), _mm_unpackhi_epi16(a1, zero)),
+                                       _mm_add_epi32(_mm_unpacklo_epi16(b1, zero), _mm_unpackhi_epi16(b1, zero)));
+
+            s0 = _mm_srli_epi32(_mm_add_epi32(s0, round), 2);
+            s1 = _mm_srli_epi32(_mm_add_epi32(s1, round), 2);
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packs_epi32(s0, s1));
+        }
+        return x;
+    }
+
+    int kaiserRowSSE2(const std::uint16_t* row, const std::int16_t* weights, std::uint16_t* out, int first, int last)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i pairs[KAISER_TAPS / 2];
+        for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            pairs[j] = weightPair(weights, j);
+
+        int x = first;
+        for(; x < last; ++x)
+        {
+            const std::uint16_t* taps = row + (x * 2 - 3) * 4;
+
+            __m128i accumulator = zero;
+            for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            {
+                // Pixels 2j and 2j + 1, interleaved channel by channel.
+                __m128i both = _mm_loadu_si128((const __m128i*)(taps + j * 8));
+                __m128i mixed = _mm_unpacklo_epi16(both, _mm_srli_si128(both, 8));
+                accumulator = _mm_add_epi32(accumulator, _mm_madd_epi16(mixed, pairs[j]));
+            }
+
+            __m128i result = roundKaiser(accumulator);
+            result = _mm_max_epi16(_mm_packs_epi32(result, result), zero);
+            _mm_storel_epi64((__m128i*)(out + x * 4), result);
+        }
+        return x - first;
+    }
+
+    int kaiserColumnSSE2(const std::uint16_t* const* rows, const std::int16_t* weights, std::uint16_t* out, int count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i pairs[KAISER_TAPS / 2];
+        for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            pairs[j] = weightPair(weights, j);
+
+        int i = 0;
+        for(; i + 8 <= count; i += 8)
+        {
+            __m128i low  = zero;
+            __m128i high = zero;
+            for(int j = 0; j < KAISER_TAPS / 2; ++j)
+            {
+                __m128i a = _mm_loadu_si128((const __m128i*)(rows[j * 2] + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(rows[j * 2 + 1] + i));
+                low  = _mm_add_epi32(low,  _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pairs[j]));
+                high = _mm_add_epi32(high, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pairs[j]));
+            }
+
+            __m128i result = _mm_packs_epi32(roundKaiser(low), roundKaiser(high));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_max_epi16(result, zero));
+        }
+        return i;
+    }
+
+    int packRGB565SSE2(const std::uint8_t* pixels, std::uint16_t* out, int count)
+    {
+        return pack(pixels, out, count, _mm_set_epi16(0, 31, 63, 31, 0, 31, 63, 31), _mm_set_epi16(0, 1, 32, 2048, 0, 1, 32, 2048));
+    }
+
+    int packRGBA4SSE2(const std::uint8_t* pixels, std::uint16_t* out, int count)
+    {
+        return pack(pixels, out, count, _mm_set1_epi16(15), _mm_set_epi16(1, 16, 256, 4096, 1, 16, 256, 4096));
+    }
+#else
+    int boxRowSSE2(const std::uint16_t*, const std::uint16_t*, std::uint16_t*, int) { return 0; }
+    int kaiserRowSSE2(const std::uint16_t*, const std::int16_t*, std::uint16_t*, int, int) { return 0; }
+    int kaiserColumnSSE2(const std::uint16_t* const*, const std::int16_t*, std::uint16_t*, int) { return 0; }
+    int packRGB565SSE2(const std::uint8_t*, std::uint16_t*, int) { return 0; }
+    int packRGBA4SSE2(const std::uint8_t*, std::uint16_t*, int) { return 0; }
+#endif
+}
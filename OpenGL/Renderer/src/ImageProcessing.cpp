@@ -0,0 +1,351 @@
+#include "Renderer/ImageProcessing.hpp"
+
+#include "ImageKernels.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define IMAGE_PROCESSING_X86_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define IMAGE_PROCESSING_X86_GCC
+#endif
+
+namespace
+{
+    const int LINEAR_MAX = 32767;
+
+    // Conversions in and out of the 15-bit linear range. Built once, shared by every SIMD level,
+    // which is what keeps their results identical.
+    // --------------------------------------------------------------------------------------
+    struct ConversionTables
+    {
+        std::uint16_t srgbToLinear[256];
+        std::uint16_t unormToLinear[256];
+        std::uint8_t  linearToSrgb[LINEAR_MAX + 1];
+        std::uint8_t  linearToUnorm[LINEAR_MAX + 1];
+
+        ConversionTables()
+        {
+            for(int c = 0; c < 256; ++c)
+            {
+                double value = c / 255.0;
+                double linear = value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+                srgbToLinear[c]  = (std::uint16_t)std::floor(linear * LINEAR_MAX + 0.5);
+                unormToLinear[c] = (std::uint16_t)((c * LINEAR_MAX + 127) / 255);
+            }
+            for(int v = 0; v <= LINEAR_MAX; ++v)
+            {
+                double linear = (double)v / LINEAR_MAX;
+                double value  = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+                linearToSrgb[v]  = (std::uint8_t)std::floor(std::min(std::max(value, 0.0), 1.0) * 255.0 + 0.5);
+                linearToUnorm[v] = (std::uint8_t)((v * 255 + LINEAR_MAX / 2) / LINEAR_MAX);
+            }
+        }
+    };
+
+    const ConversionTables& tables()
+    {
+        static const ConversionTables instance;
+        return instance;
+    }
+
+    // 8 taps of a Kaiser windowed sinc (beta 4) halving the resolution, centred between source
+    // pixels 2x and 2x + 1, in 1.14 fixed point summing to exactly 1.
+    // ----------------------------------------------------------------------------------------
+    struct KaiserWeights
+    {
+        std::int16_t taps[ImageKernels::KAISER_TAPS];
+
+        static double besselI0(double x)
+        {
+            double sum  = 1.0;
+            double term = 1.0;
+            for(int k = 1; k < 32; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum  += term;
+            }
+            return sum;
+        }
+
+        KaiserWeights()
+        {
+            const double PI   = 3.14159265358979323846;
+            const double BETA = 4.0;
+            const int    ONE  = 1 << ImageKernels::KAISER_SHIFT;
+
+            double weights[ImageKernels::KAISER_TAPS];
+            double total = 0.0;
+            for(int k = 0; k < ImageKernels::KAISER_TAPS; ++k)
+            {
+                double distance = k - 3.5;               // In source pixels.
+                double x        = distance * 0.5;        // In destination pixels.
+                double sinc     = std::sin(PI * x) / (PI * x);
+                double t        = distance / 4.0;
+                double window   = besselI0(BETA * std::sqrt(1.0 - t * t)) / besselI0(BETA);
+                weights[k] = sinc * window;
+                total     += weights[k];
+            }
+
+            int sum = 0;
+            for(int k = 0; k < ImageKernels::KAISER_TAPS; ++k)
+            {
+                taps[k] = (std::int16_t)std::floor(weights[k] / total * ONE + 0.5);
+                sum    += taps[k];
+            }
+            // Rounding leftovers go to the centre taps so flat areas stay exactly flat.
+            taps[3] = (std::int16_t)(taps[3] + (ONE - sum) / 2);
+            taps[4] = (std::int16_t)(taps[4] + (ONE - sum) - (ONE - sum) / 2);
+        }
+    };
+
+    const std::int16_t* kaiserWeights()
+    {
+        static const KaiserWeights instance;
+        return instance.taps;
+    }
+
+    SimdLevel detectSimdLevel()
+    {
+#if defined(IMAGE_PROCESSING_X86_MSVC)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if(ImageKernels::avx2Compiled() && osSavesAvx && (info[1] & (1 << 5)))
+            return SimdLevel::AVX2;
+        return SimdLevel::SSE2;
+#elif defined(IMAGE_PROCESSING_X86_GCC)
+        __builtin_cpu_init();
+        if(ImageKernels::avx2Compiled() && __builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    std::atomic<int>& activeLevel()
+    {
+        static std::atomic<int> level((int)supportedSimdLevel());
+        return level;
+    }
+
+    int clampIndex(int index, int size)
+    {
+        return std::min(std::max(index, 0), size - 1);
+    }
+
+    std::uint16_t roundKaiser(int accumulator)
+    {
+        int value = accumulator + (1 << (ImageKernels::KAISER_SHIFT - 1));
+        value = value < 0 ? 0 : value >> ImageKernels::KAISER_SHIFT;
+        return (std::uint16_t)std::min(value, LINEAR_MAX);
+    }
+}
+
+// ------------------------------------------------------------------------
+SimdLevel supportedSimdLevel()
+{
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel simdLevel()
+{
+    return (SimdLevel)activeLevel().load();
+}
+
+void setSimdLevel(SimdLevel level)
+{
+    activeLevel() = (int)std::min(level, supportedSimdLevel());
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch(level)
+    {
+    case SimdLevel::SSE2: return "SSE2";
+    case SimdLevel::AVX2: return "AVX2";
+    default:              return "scalar";
+    }
+}
+
+// ------------------------------------------------------------------------
+void toLinear(const Image &image, LinearImage &linear, bool srgb)
+{
+    const ConversionTables &lookup = tables();
+    const std::uint16_t* color = srgb ? lookup.srgbToLinear : lookup.unormToLinear;
+
+    linear = LinearImage(image.width, image.height);
+    for(std::size_t i = 0; i < image.pixels.size(); i += 4)
+    {
+        linear.pixels[i + 0] = color[image.pixels[i + 0]];
+        linear.pixels[i + 1] = color[image.pixels[i + 1]];
+        linear.pixels[i + 2] = color[image.pixels[i + 2]];
+        linear.pixels[i + 3] = lookup.unormToLinear[image.pixels[i + 3]];
+    }
+}
+
+void fromLinear(const LinearImage &linear, Image &image, bool srgb)
+{
+    const ConversionTables &lookup = tables();
+    const std::uint8_t* color = srgb ? lookup.linearToSrgb : lookup.linearToUnorm;
+
+    image = Image(linear.width, linear.height);
+    for(std::size_t i = 0; i < linear.pixels.size(); i += 4)
+    {
+        image.pixels[i + 0] = color[linear.pixels[i + 0]];
+        image.pixels[i + 1] = color[linear.pixels[i + 1]];
+        image.pixels[i + 2] = color[linear.pixels[i + 2]];
+        image.pixels[i + 3] = lookup.linearToUnorm[linear.pixels[i + 3]];
+    }
+}
+
+// ------------------------------------------------------------------------
+void downsampleBox(const LinearImage &source, LinearImage &result)
+{
+    result = LinearImage(std::max<GLsizei>(source.width / 2, 1), std::max<GLsizei>(source.height / 2, 1));
+
+    const SimdLevel   level   = simdLevel();
+    const std::size_t rowSize = (std::size_t)source.width * 4;
+
+    for(GLsizei y = 0; y < result.height; ++y)
+    {
+        const std::uint16_t* a   = &source.pixels[clampIndex(y * 2,     source.height) * rowSize];
+        const std::uint16_t* b   = &source.pixels[clampIndex(y * 2 + 1, source.height) * rowSize];
+        std::uint16_t*       out = &result.pixels[(std::size_t)y * result.width * 4];
+
+        // Without a second column every "pair" is the same pixel twice.
+        int x = 0;
+        if(source.width > 1)
+        {
+            if(level == SimdLevel::AVX2)
+                x = ImageKernels::boxRowAVX2(a, b, out, result.width);
+            else if(level == SimdLevel::SSE2)
+                x = ImageKernels::boxRowSSE2(a, b, out, result.width);
+        }
+
+        for(; x < result.width; ++x)
+        {
+            int x0 = clampIndex(x * 2,     source.width) * 4;
+            int x1 = clampIndex(x * 2 + 1, source.width) * 4;
+            for(int c = 0; c < 4; ++c)
+                out[x * 4 + c] = (std::uint16_t)((a[x0 + c] + a[x1 + c] + b[x0 + c] + b[x1 + c] + 2) >> 2);
+        }
+    }
+}
+
+void downsampleKaiser(const LinearImage &source, LinearImage &result)
+{
+    const SimdLevel     level   = simdLevel();
+    const std::int16_t* weights = kaiserWeights();
+    const int           TAPS    = ImageKernels::KAISER_TAPS;
+
+    // Horizontal pass: half the width, every row.
+    LinearImage half(std::max<GLsizei>(source.width / 2, 1), source.height);
+
+    // Outputs whose taps 2x - 3 ... 2x + 4 are all inside the row.
+    const int interiorFirst = 2;
+    const int interiorLast  = std::max(std::min((int)half.width, (source.width - 5) / 2 + 1), interiorFirst);
+
+    for(GLsizei y = 0; y < source.height; ++y)
+    {
+        const std::uint16_t* row = &source.pixels[(std::size_t)y * source.width * 4];
+        std::uint16_t*       out = &half.pixels[(std::size_t)y * half.width * 4];
+
+        int done = interiorFirst;
+        if(interiorLast > interiorFirst)
+        {
+            if(level == SimdLevel::AVX2)
+                done += ImageKernels::kaiserRowAVX2(row, weights, out, interiorFirst, interiorLast);
+            else if(level == SimdLevel::SSE2)
+                done += ImageKernels::kaiserRowSSE2(row, weights, out, interiorFirst, interiorLast);
+        }
+
+        for(int x = 0; x < half.width; ++x)
+        {
+            if(x >= interiorFirst && x < done)
+                continue;
+
+            for(int c = 0; c < 4; ++c)
+            {
+                int accumulator = 0;
+                for(int k = 0; k < TAPS; ++k)
+                    accumulator += weights[k] * row[clampIndex(x * 2 - 3 + k, source.width) * 4 + c];
+                out[x * 4 + c] = roundKaiser(accumulator);
+            }
+        }
+    }
+
+    // Vertical pass: half the height. Clamping whole rows makes every column an interior one.
+    result = LinearImage(half.width, std::max<GLsizei>(source.height / 2, 1));
+
+    const int rowElements = half.width * 4;
+    for(GLsizei y = 0; y < result.height; ++y)
+    {
+        const std::uint16_t* rows[ImageKernels::KAISER_TAPS];
+        for(int k = 0; k < TAPS; ++k)
+            rows[k] = &half.pixels[(std::size_t)clampIndex(y * 2 - 3 + k, half.height) * rowElements];
+
+        std::uint16_t* out = &result.pixels[(std::size_t)y * rowElements];
+
+        int i = 0;
+        if(level == SimdLevel::AVX2)
+            i = ImageKernels::kaiserColumnAVX2(rows, weights, out, rowElements);
+        else if(level == SimdLevel::SSE2)
+            i = ImageKernels::kaiserColumnSSE2(rows, weights, out, rowElements);
+
+        for(; i < rowElements; ++i)
+        {
+            int accumulator = 0;
+            for(int k = 0; k < TAPS; ++k)
+                accumulator += weights[k] * rows[k][i];
+            out[i] = roundKaiser(accumulator);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+void packRGB565(const Image &image, std::vector<std::uint16_t> &packed)
+{
+    const int count = image.width * image.height;
+    packed.resize(count);
+
+    int i = 0;
+    if(simdLevel() == SimdLevel::AVX2)
+        i = ImageKernels::packRGB565AVX2(image.pixels.data(), packed.data(), count);
+    else if(simdLevel() == SimdLevel::SSE2)
+        i = ImageKernels::packRGB565SSE2(image.pixels.data(), packed.data(), count);
+
+    // glm puts x in the low bits, GL_UNSIGNED_SHORT_5_6_5 wants red in the high ones.
+    for(; i < count; ++i)
+    {
+        const std::uint8_t* p = &image.pixels[i * 4];
+        packed[i] = glm::packUnorm1x5_1x6_1x5(glm::vec3(p[2], p[1], p[0]) / 255.0f);
+    }
+}
+
+void packRGBA4(const Image &image, std::vector<std::uint16_t> &packed)
+{
+    const int count = image.width * image.height;
+    packed.resize(count);
+
+    int i = 0;
+    if(simdLevel() == SimdLevel::AVX2)
+        i = ImageKernels::packRGBA4AVX2(image.pixels.data(), packed.data(), count);
+    else if(simdLevel() == SimdLevel::SSE2)
+        i = ImageKernels::packRGBA4SSE2(image.pixels.data(), packed.data(), count);
+
+    for(; i < count; ++i)
+    {
+        const std::uint8_t* p = &image.pixels[i * 4];
+        packed[i] = glm::packUnorm4x4(glm::vec4(p[3], p[2], p[1], p[0]) / 255.0f);
+    }
+}
@@ -0,0 +1,153 @@
+#include "Renderer/InstanceBatcher.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+InstanceBatcher::InstanceBatcher(std::size_t capacity)
+    : buffer(0), capacity(std::max<std::size_t>(capacity, 1))
+{
+    glGenBuffers(1, &buffer);
+
+    lastStats.instances     = 0;
+    lastStats.batches       = 0;
+    lastStats.bytesUploaded = 0;
+}
+
+InstanceBatcher::~InstanceBatcher()
+{
+    glDeleteBuffers(1, &buffer);
+    if(GLStateCache* state = GLStateCache::current())
+        state->bufferDeleted(buffer);
+}
+
+// ------------------------------------------------------------------------
+void InstanceBatcher::attach(GLStateCache &state, GLuint vertexArray, GLuint location)
+{
+    state.bindVertexArray(vertexArray);
+    state.bindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    pointAttributes(location, 0);
+    for(GLuint i = 0; i < LOCATION_COUNT; ++i)
+    {
+        glEnableVertexAttribArray(location + i);
+        glVertexAttribDivisor(location + i, 1);
+    }
+}
+
+void InstanceBatcher::pointAttributes(GLuint location, GLuint first)
+{
+    const GLsizei  stride = sizeof(InstanceData);
+    const GLintptr base   = (GLintptr)first * stride;
+
+    for(GLuint column = 0; column < 4; ++column)
+        glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(base + column * sizeof(glm::vec4)));
+    glVertexAttribPointer(location + 4, 4, GL_FLOAT, GL_FALSE, stride, (const void*)(base + offsetof(InstanceData, color)));
+}
+
+// ------------------------------------------------------------------------
+void InstanceBatcher::add(const DrawPacket &packet, const InstanceData &instance, GLuint location)
+{
+    Entry entry;
+    entry.packet                  = packet;
+    entry.packet.instanceLocation = location;
+    entry.instance                = instance;
+    entries.push_back(entry);
+}
+
+void InstanceBatcher::flush(GLStateCache &state, DrawQueue &queue)
+{
+    lastStats.instances     = (unsigned int)entries.size();
+    lastStats.batches       = 0;
+    lastStats.bytesUploaded = 0;
+
+    if(entries.empty())
+        return;
+
+    order.resize(entries.size());
+    for(std::size_t i = 0; i < entries.size(); ++i)
+        order[i] = &entries[i];
+    std::sort(order.begin(), order.end(), batchOrder);
+
+    // Each run of matching packets becomes one instanced packet over a contiguous range of 'upload'.
+    upload.clear();
+    for(std::size_t first = 0; first < order.size(); )
+    {
+        std::size_t last = first + 1;
+        while(last < order.size() && sameBatch(order[first]->packet, order[last]->packet))
+            ++last;
+
+        DrawPacket packet     = order[first]->packet;
+        packet.instanceCount  = (GLsizei)(last - first);
+        packet.baseInstance   = (GLuint)upload.size();
+        packet.instanceBuffer = buffer;
+
+        for(std::size_t i = first; i < last; ++i)
+        {
+            // Front most instance decides where the batch sorts.
+            packet.depth = std::min(packet.depth, order[i]->packet.depth);
+            upload.push_back(order[i]->instance);
+        }
+
+        queue.push(packet);
+        ++lastStats.batches;
+        first = last;
+    }
+
+    entries.clear();
+
+    // Static scenes flush the same instances every frame: the buffer already holds them, and as it isn't written
+    // the GPU can keep reading it.
+    if(upload.size() == uploaded.size() && std::memcmp(upload.data(), uploaded.data(), upload.size() * sizeof(InstanceData)) == 0)
+        return;
+
+    // Orphan last frame's data instead of waiting for the GPU to finish reading it.
+    while(capacity < upload.size())
+        capacity *= 2;
+
+    state.bindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, upload.size() * sizeof(InstanceData), upload.data());
+
+    lastStats.bytesUploaded = (unsigned int)(upload.size() * sizeof(InstanceData));
+    uploaded.swap(upload);
+}
+
+// ------------------------------------------------------------------------
+// A batch is one draw with one DrawBlock, so its packets must hold the same one; what differs per copy goes in InstanceData.
+bool InstanceBatcher::sameBatch(const DrawPacket &a, const DrawPacket &b)
+{
+    return !a.blended && !b.blended
+        && a.program == b.program && a.vertexArray == b.vertexArray && a.texture == b.texture
+        && std::memcmp(&a.block, &b.block, sizeof(DrawBlock)) == 0
+        && a.mode == b.mode && a.count == b.count && a.indexType == b.indexType
+        && a.firstIndex == b.firstIndex && a.baseVertex == b.baseVertex
+        && a.layer == b.layer && a.instanceLocation == b.instanceLocation;
+}
+
+bool InstanceBatcher::batchOrder(const Entry* a, const Entry* b)
+{
+    const DrawPacket &x = a->packet;
+    const DrawPacket &y = b->packet;
+
+    if(x.blended != y.blended)         return x.blended < y.blended;
+    if(x.layer != y.layer)             return x.layer < y.layer;
+    if(x.program != y.program)         return x.program < y.program;
+    if(x.vertexArray != y.vertexArray) return x.vertexArray < y.vertexArray;
+    if(x.texture != y.texture)         return x.texture < y.texture;
+    if(x.firstIndex != y.firstIndex)   return x.firstIndex < y.firstIndex;
+    if(x.count != y.count)             return x.count < y.count;
+    if(x.baseVertex != y.baseVertex)   return x.baseVertex < y.baseVertex;
+    if(int block = std::memcmp(&x.block, &y.block, sizeof(DrawBlock)))
+        return block < 0;
+    if(x.mode != y.mode)               return x.mode < y.mode;
+    if(x.indexType != y.indexType)     return x.indexType < y.indexType;
+    if(x.instanceLocation != y.instanceLocation) return x.instanceLocation < y.instanceLocation;
+
+    // Entries are contiguous, so this keeps the order they were added in: the upload of an unchanged
+    // frame comes out the same, and the flush() comparison against last frame's can skip it.
+    return a < b;
+}
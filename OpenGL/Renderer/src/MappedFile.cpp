@@ -0,0 +1,147 @@
+#include "Renderer/MappedFile.hpp"
+
+#include <iostream>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    // What data() points at for an empty file opened with allowEmpty.
+    const unsigned char EMPTY_FILE[1] = { 0 };
+}
+
+MappedFile::MappedFile()
+    : mapping(nullptr), length(0)
+#ifdef _WIN32
+    , file(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path, bool allowEmpty)
+{
+    close();
+
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                       FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || (fileSize.QuadPart == 0 && !allowEmpty))
+    {
+        std::cout << "ERROR::MAPPED_FILE::EMPTY " << path << std::endl;
+        close();
+        return false;
+    }
+
+    if(fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        file    = INVALID_HANDLE_VALUE;
+        mapping = EMPTY_FILE;
+        return true;
+    }
+
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mappingHandle)
+        mapping = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+    if(!mapping)
+    {
+        std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+        close();
+        return false;
+    }
+
+    length = (std::size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(mapping && mapping != EMPTY_FILE)
+        UnmapViewOfFile(mapping);
+    if(mappingHandle)
+        CloseHandle(mappingHandle);
+    if(file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+
+    mapping       = nullptr;
+    mappingHandle = nullptr;
+    file          = INVALID_HANDLE_VALUE;
+    length        = 0;
+}
+#else
+bool MappedFile::open(const std::string &path, bool allowEmpty)
+{
+    close();
+
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if(descriptor < 0)
+    {
+        std::cout << "ERROR::MAPPED_FILE::OPEN_FAILED " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(descriptor, &info) != 0 || (info.st_size == 0 && !allowEmpty))
+    {
+        std::cout << "ERROR::MAPPED_FILE::EMPTY " << path << std::endl;
+        ::close(descriptor);
+        return false;
+    }
+
+    if(info.st_size == 0)
+    {
+        ::close(descriptor);
+        mapping = EMPTY_FILE;
+        return true;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    void* view = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+
+    if(view == MAP_FAILED)
+    {
+        std::cout << "ERROR::MAPPED_FILE::MAP_FAILED " << path << std::endl;
+        return false;
+    }
+
+    // Callers read the whole file, front to back.
+    madvise(view, (std::size_t)info.st_size, MADV_WILLNEED);
+
+    mapping = static_cast<const unsigned char*>(view);
+    length  = (std::size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if(mapping && mapping != EMPTY_FILE)
+        munmap(const_cast<unsigned char*>(mapping), length);
+
+    mapping = nullptr;
+    length  = 0;
+}
+#endif
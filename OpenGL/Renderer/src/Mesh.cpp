@@ -0,0 +1,259 @@
+#include "Renderer/Mesh.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+
+#include <cstring>
+#include <iostream>
+
+Mesh::Mesh(const VertexLayout &layout, GLuint vertexCount)
+    : vertexLayout(layout), count(0)
+{
+    resize(vertexCount);
+}
+
+void Mesh::resize(GLuint vertexCount)
+{
+    count = vertexCount;
+    vertexData.resize((std::size_t)vertexCount * vertexLayout.stride());
+}
+
+// ------------------------------------------------------------------------
+void Mesh::set(GLuint location, GLuint vertex, const glm::vec4 &value)
+{
+    const VertexAttribute* attribute = vertexLayout.find(location);
+    if(!attribute || vertex >= count)
+    {
+        std::cout << "ERROR::MESH::INVALID_ATTRIBUTE location " << location << ", vertex " << vertex << std::endl;
+        return;
+    }
+
+    unsigned char* out = &vertexData[(std::size_t)vertex * vertexLayout.stride() + attribute->offset];
+
+    // Every packed value is written as a whole, the sizes match VertexLayout::add.
+    switch(attribute->format)
+    {
+    case VertexFormat::Float1:
+    case VertexFormat::Float2:
+    case VertexFormat::Float3:
+    case VertexFormat::Float4:
+    case VertexFormat::Raw:
+        if(attribute->type != GL_FLOAT)
+            break;
+        std::memcpy(out, &value[0], attribute->components * sizeof(float));
+        return;
+    case VertexFormat::Half2:
+    {
+        glm::uint32 packed = glm::packHalf2x16(glm::vec2(value));
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Half4:
+    {
+        glm::uint64 packed = glm::packHalf4x16(value);
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Snorm16x2:
+    {
+        glm::uint32 packed = glm::packSnorm2x16(glm::vec2(value));
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Snorm16x4:
+    {
+        glm::uint64 packed = glm::packSnorm4x16(value);
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Unorm16x2:
+    {
+        glm::uint32 packed = glm::packUnorm2x16(glm::vec2(value));
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Unorm16x4:
+    {
+        glm::uint64 packed = glm::packUnorm4x16(value);
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Octahedral16:
+    {
+        glm::uint32 packed = glm::packSnorm2x16(encodeOctahedral(glm::vec3(value)));
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Snorm8x4:
+    {
+        glm::uint32 packed = glm::packSnorm4x8(value);
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    case VertexFormat::Unorm8x4:
+    {
+        glm::uint32 packed = glm::packUnorm4x8(value);
+        std::memcpy(out, &packed, sizeof(packed));
+        return;
+    }
+    }
+
+    std::cout << "ERROR::MESH::UNSUPPORTED_FORMAT location " << location << std::endl;
+}
+
+void Mesh::set(GLuint location, const float* values, GLint components, GLsizei stride)
+{
+    if(components < 1 || components > 4)
+    {
+        std::cout << "ERROR::MESH::INVALID_COMPONENTS " << components << std::endl;
+        return;
+    }
+    if(stride == 0)
+        stride = components * sizeof(float);
+
+    const unsigned char* in = (const unsigned char*)values;
+    for(GLuint vertex = 0; vertex < count; ++vertex, in += stride)
+    {
+        glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+        std::memcpy(&value[0], in, components * sizeof(float));
+        set(location, vertex, value);
+    }
+}
+
+glm::vec4 Mesh::get(GLuint location, GLuint vertex) const
+{
+    glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+
+    const VertexAttribute* attribute = vertexLayout.find(location);
+    if(!attribute || vertex >= count)
+        return value;
+
+    const unsigned char* in = &vertexData[(std::size_t)vertex * vertexLayout.stride() + attribute->offset];
+    glm::uint32 packed32 = 0;
+    glm::uint64 packed64 = 0;
+
+    switch(attribute->format)
+    {
+    case VertexFormat::Float1:
+    case VertexFormat::Float2:
+    case VertexFormat::Float3:
+    case VertexFormat::Float4:
+    case VertexFormat::Raw:
+        if(attribute->type == GL_FLOAT)
+            std::memcpy(&value[0], in, attribute->components * sizeof(float));
+        break;
+    case VertexFormat::Half2:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::vec4(glm::unpackHalf2x16(packed32), 0.0f, 1.0f);
+        break;
+    case VertexFormat::Half4:
+        std::memcpy(&packed64, in, sizeof(packed64));
+        value = glm::unpackHalf4x16(packed64);
+        break;
+    case VertexFormat::Snorm16x2:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::vec4(glm::unpackSnorm2x16(packed32), 0.0f, 1.0f);
+        break;
+    case VertexFormat::Snorm16x4:
+        std::memcpy(&packed64, in, sizeof(packed64));
+        value = glm::unpackSnorm4x16(packed64);
+        break;
+    case VertexFormat::Unorm16x2:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::vec4(glm::unpackUnorm2x16(packed32), 0.0f, 1.0f);
+        break;
+    case VertexFormat::Unorm16x4:
+        std::memcpy(&packed64, in, sizeof(packed64));
+        value = glm::unpackUnorm4x16(packed64);
+        break;
+    case VertexFormat::Octahedral16:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::vec4(decodeOctahedral(glm::unpackSnorm2x16(packed32)), 0.0f);
+        break;
+    case VertexFormat::Snorm8x4:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::unpackSnorm4x8(packed32);
+        break;
+    case VertexFormat::Unorm8x4:
+        std::memcpy(&packed32, in, sizeof(packed32));
+        value = glm::unpackUnorm4x8(packed32);
+        break;
+    }
+    return value;
+}
+
+void Mesh::remapVertices(const std::vector<GLuint> &remap, GLuint vertexCount)
+{
+    const std::size_t stride = vertexLayout.stride();
+
+    std::vector<unsigned char> remapped((std::size_t)vertexCount * stride);
+    for(GLuint vertex = 0; vertex < count; ++vertex)
+    {
+        if(remap[vertex] != ~0u)
+            std::memcpy(&remapped[remap[vertex] * stride], &vertexData[vertex * stride], stride);
+    }
+    vertexData.swap(remapped);
+    count = vertexCount;
+
+    for(std::size_t i = 0; i < indexData.size(); ++i)
+        indexData[i] = remap[indexData[i]];
+}
+
+void Mesh::append(const Mesh &other)
+{
+    if(other.vertexLayout != vertexLayout)
+    {
+        std::cout << "ERROR::MESH::LAYOUT_MISMATCH" << std::endl;
+        return;
+    }
+
+    GLuint baseVertex = count;
+    vertexData.insert(vertexData.end(), other.vertexData.begin(), other.vertexData.end());
+    count += other.count;
+
+    indexData.reserve(indexData.size() + other.indexData.size());
+    for(std::size_t i = 0; i < other.indexData.size(); ++i)
+        indexData.push_back(baseVertex + other.indexData[i]);
+}
+
+MeshRange Mesh::upload(GeometryArena &arena) const
+{
+    if(arena.layout() != vertexLayout)
+    {
+        std::cout << "ERROR::MESH::LAYOUT_MISMATCH" << std::endl;
+        MeshRange invalid = { 0, 0, 0, 0 };
+        return invalid;
+    }
+    return arena.add(vertexData.data(), count, indexData.data(), (GLuint)indexData.size());
+}
+
+// ------------------------------------------------------------------------
+glm::vec2 encodeOctahedral(const glm::vec3 &normal)
+{
+    // A zero normal (OBJ files have them) would divide by zero; it becomes +Z.
+    const float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+    if(length == 0.0f)
+        return glm::vec2(0.0f);
+
+    glm::vec3 n = normal / length;
+    glm::vec2 folded(n.x, n.y);
+
+    // The lower hemisphere is folded over the diagonals.
+    if(n.z < 0.0f)
+    {
+        folded.x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        folded.y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return folded;
+}
+
+glm::vec3 decodeOctahedral(const glm::vec2 &encoded)
+{
+    glm::vec3 n(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+    if(n.z < 0.0f)
+    {
+        n.x = (1.0f - glm::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f);
+        n.y = (1.0f - glm::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return glm::normalize(n);
+}
@@ -0,0 +1,210 @@
+#include "Renderer/MeshFile.hpp"
+
+#include "Renderer/Mesh.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    std::uint64_t align(std::uint64_t offset, std::uint64_t alignment)
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    void writePadding(std::ofstream &out, std::uint64_t from, std::uint64_t to)
+    {
+        static const char zeros[MeshFile::BLOB_ALIGNMENT] = {};
+        out.write(zeros, (std::streamsize)(to - from));
+    }
+}
+
+MeshFile::MeshFile()
+    : header(nullptr), lods(nullptr)
+{
+
+}
+
+bool MeshFile::open(const std::string &path)
+{
+    close();
+
+    if(!file.open(path))
+        return false;
+
+    // Checked before anything in the mapping is trusted.
+    const unsigned char* data = file.data();
+    std::size_t          size = file.size();
+
+    const MeshFileHeader* candidate = reinterpret_cast<const MeshFileHeader*>(data);
+    if(size < sizeof(MeshFileHeader) || candidate->magic != MESH_FILE_MAGIC || candidate->version != MESH_FILE_VERSION)
+    {
+        std::cout << "ERROR::MESH_FILE::BAD_HEADER " << path << std::endl;
+        close();
+        return false;
+    }
+
+    std::uint64_t tables = sizeof(MeshFileHeader) + (std::uint64_t)candidate->attributeCount * sizeof(MeshFileAttribute)
+                         + (std::uint64_t)candidate->lodCount * sizeof(MeshFileLod);
+    std::uint64_t vertexBytes = (std::uint64_t)candidate->vertexCount * candidate->stride;
+    std::uint64_t indexBytes  = (std::uint64_t)candidate->indexCount * sizeof(GLuint);
+
+    // Each offset is compared against size minus its blob's length, so huge offsets can't wrap the sum past size.
+    if(tables > size || candidate->vertexOffset < tables || candidate->vertexOffset > size || vertexBytes > size - candidate->vertexOffset
+        || candidate->indexOffset < candidate->vertexOffset + vertexBytes || candidate->indexOffset > size
+        || indexBytes > size - candidate->indexOffset || candidate->indexOffset % sizeof(GLuint) != 0)
+    {
+        std::cout << "ERROR::MESH_FILE::TRUNCATED " << path << std::endl;
+        close();
+        return false;
+    }
+
+    const MeshFileAttribute* attributes = reinterpret_cast<const MeshFileAttribute*>(data + sizeof(MeshFileHeader));
+    for(std::uint32_t i = 0; i < candidate->attributeCount; ++i)
+    {
+        if(attributes[i].format == (std::uint32_t)VertexFormat::Raw || attributes[i].format > (std::uint32_t)VertexFormat::Unorm8x4)
+        {
+            std::cout << "ERROR::MESH_FILE::UNKNOWN_FORMAT " << attributes[i].format << " " << path << std::endl;
+            close();
+            return false;
+        }
+        vertexLayout.add(attributes[i].location, (VertexFormat)attributes[i].format);
+    }
+
+    const MeshFileLod* levels = reinterpret_cast<const MeshFileLod*>(attributes + candidate->attributeCount);
+    for(std::uint32_t i = 0; i < candidate->lodCount; ++i)
+    {
+        if((std::uint64_t)levels[i].firstIndex + levels[i].indexCount > candidate->indexCount)
+        {
+            std::cout << "ERROR::MESH_FILE::BAD_LOD " << i << " " << path << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    if((GLuint)vertexLayout.stride() != candidate->stride)
+    {
+        std::cout << "ERROR::MESH_FILE::STRIDE_MISMATCH " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // An index past the last vertex would have the GPU read outside the mesh's range of the arena.
+    const GLuint* indices = reinterpret_cast<const GLuint*>(data + candidate->indexOffset);
+    GLuint maxIndex = 0;
+    for(std::uint32_t i = 0; i < candidate->indexCount; ++i)
+        maxIndex = std::max(maxIndex, indices[i]);
+
+    if(candidate->indexCount > 0 && maxIndex >= candidate->vertexCount)
+    {
+        std::cout << "ERROR::MESH_FILE::BAD_INDEX " << maxIndex << " " << path << std::endl;
+        close();
+        return false;
+    }
+
+    header = candidate;
+    lods   = levels;
+    return true;
+}
+
+void MeshFile::close()
+{
+    file.close();
+    header       = nullptr;
+    lods         = nullptr;
+    vertexLayout = VertexLayout();
+}
+
+const void* MeshFile::vertices() const
+{
+    return file.data() + header->vertexOffset;
+}
+
+const GLuint* MeshFile::indices() const
+{
+    return reinterpret_cast<const GLuint*>(file.data() + header->indexOffset);
+}
+
+// ------------------------------------------------------------------------
+MeshRange MeshFile::upload(GeometryArena &arena) const
+{
+    if(arena.layout() != vertexLayout)
+    {
+        std::cout << "ERROR::MESH_FILE::LAYOUT_MISMATCH" << std::endl;
+        MeshRange invalid = { 0, 0, 0, 0 };
+        return invalid;
+    }
+    return arena.add(vertices(), header->vertexCount, indices(), header->indexCount);
+}
+
+MeshRange MeshFile::lodRange(const MeshRange &uploaded, GLuint level) const
+{
+    MeshRange range   = uploaded;
+    range.firstIndex += lods[level].firstIndex;
+    range.indexCount  = lods[level].indexCount;
+    return range;
+}
+
+// ------------------------------------------------------------------------
+bool writeMeshFile(const std::string &path, const Mesh &mesh, const std::vector<MeshFileLod> &lods)
+{
+    const std::vector<VertexAttribute> &attributes = mesh.layout().attributes();
+    for(std::size_t i = 0; i < attributes.size(); ++i)
+    {
+        if(attributes[i].format == VertexFormat::Raw)
+        {
+            std::cout << "ERROR::MESH_FILE::RAW_ATTRIBUTE location " << attributes[i].location << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<MeshFileLod> levels(lods);
+    if(levels.empty())
+    {
+        MeshFileLod full = { 0, (std::uint32_t)mesh.indices().size(), 0.0f, 0 };
+        levels.push_back(full);
+    }
+
+    MeshFileHeader header;
+    header.magic          = MESH_FILE_MAGIC;
+    header.version        = MESH_FILE_VERSION;
+    header.vertexCount    = mesh.vertexCount();
+    header.indexCount     = (std::uint32_t)mesh.indices().size();
+    header.stride         = (std::uint32_t)mesh.layout().stride();
+    header.attributeCount = (std::uint32_t)attributes.size();
+    header.lodCount       = (std::uint32_t)levels.size();
+    header.reserved       = 0;
+
+    std::uint64_t tables    = sizeof(MeshFileHeader) + attributes.size() * sizeof(MeshFileAttribute) + levels.size() * sizeof(MeshFileLod);
+    header.vertexOffset     = align(tables, MeshFile::BLOB_ALIGNMENT);
+    std::uint64_t vertexEnd = header.vertexOffset + (std::uint64_t)header.vertexCount * header.stride;
+    header.indexOffset      = align(vertexEnd, MeshFile::BLOB_ALIGNMENT);
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out)
+    {
+        std::cout << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(std::size_t i = 0; i < attributes.size(); ++i)
+    {
+        MeshFileAttribute attribute = { attributes[i].location, (std::uint32_t)attributes[i].format };
+        out.write(reinterpret_cast<const char*>(&attribute), sizeof(attribute));
+    }
+    out.write(reinterpret_cast<const char*>(levels.data()), (std::streamsize)(levels.size() * sizeof(MeshFileLod)));
+
+    writePadding(out, tables, header.vertexOffset);
+    out.write(static_cast<const char*>(mesh.vertices()), (std::streamsize)(vertexEnd - header.vertexOffset));
+    writePadding(out, vertexEnd, header.indexOffset);
+    out.write(reinterpret_cast<const char*>(mesh.indices().data()), (std::streamsize)(header.indexCount * sizeof(GLuint)));
+
+    if(!out)
+    {
+        std::cout << "ERROR::MESH_FILE::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,394 @@
+#include "Renderer/MeshOptimizer.hpp"
+
+#include "Renderer/Mesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // FIFO cache simulated with timestamps: a vertex is cached while fewer than cacheSize
+    // misses happened since it was loaded. Moving 'time' past cacheSize empties the cache.
+    // -------------------------------------------------------------------------------------
+    struct CacheSimulation
+    {
+        std::vector<unsigned int> loaded;
+        unsigned int              time;
+        unsigned int              size;
+
+        CacheSimulation(GLuint vertexCount, unsigned int cacheSize)
+            : loaded(vertexCount, 0), time(cacheSize + 1), size(cacheSize)
+        {
+
+        }
+
+        bool access(GLuint vertex)
+        {
+            if(time - loaded[vertex] <= size)
+                return false;
+            loaded[vertex] = time++;
+            return true;
+        }
+
+        void reset() { time += size + 1; }
+    };
+
+    // Triangles using each vertex, as one flat list with per vertex offsets.
+    // ----------------------------------------------------------------------
+    struct Adjacency
+    {
+        std::vector<GLuint> offsets;
+        std::vector<GLuint> triangles;
+
+        Adjacency(const GLuint* indices, std::size_t indexCount, GLuint vertexCount)
+            : offsets(vertexCount + 1, 0), triangles(indexCount)
+        {
+            for(std::size_t i = 0; i < indexCount; ++i)
+                ++offsets[indices[i] + 1];
+            for(GLuint v = 0; v < vertexCount; ++v)
+                offsets[v + 1] += offsets[v];
+
+            std::vector<GLuint> fill(offsets.begin(), offsets.end() - 1);
+            for(std::size_t i = 0; i < indexCount; ++i)
+                triangles[fill[indices[i]]++] = (GLuint)(i / 3);
+        }
+
+        GLuint count(GLuint vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+    };
+
+    glm::vec3 position(const float* positions, GLsizei stride, GLuint vertex)
+    {
+        const float* p = (const float*)((const unsigned char*)positions + (std::size_t)vertex * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    unsigned int simulateMisses(CacheSimulation &cache, const GLuint* indices, GLuint firstTriangle, GLuint lastTriangle)
+    {
+        unsigned int misses = 0;
+        for(GLuint i = firstTriangle * 3; i < lastTriangle * 3; ++i)
+            misses += cache.access(indices[i]);
+        return misses;
+    }
+}
+
+// ------------------------------------------------------------------------
+VertexCacheStats analyzeVertexCache(const GLuint* indices, std::size_t indexCount, GLuint vertexCount, unsigned int cacheSize)
+{
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    if(indexCount < 3)
+        return stats;
+
+    CacheSimulation cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+
+    unsigned int misses = 0;
+    GLuint       unique = 0;
+    for(std::size_t i = 0; i < indexCount; ++i)
+    {
+        misses += cache.access(indices[i]);
+        if(!referenced[indices[i]])
+        {
+            referenced[indices[i]] = true;
+            ++unique;
+        }
+    }
+
+    stats.acmr = (float)misses / (float)(indexCount / 3);
+    stats.atvr = (float)misses / (float)unique;
+    return stats;
+}
+
+// ------------------------------------------------------------------------
+void optimizeVertexCache(GLuint* destination, const GLuint* indices, std::size_t indexCount, GLuint vertexCount,
+                         unsigned int cacheSize, std::vector<GLuint>* clusters)
+{
+    const GLuint triangleCount = (GLuint)(indexCount / 3);
+    if(clusters)
+        clusters->clear();
+
+    Adjacency adjacency(indices, indexCount, vertexCount);
+
+    std::vector<GLuint> live(vertexCount);
+    for(GLuint v = 0; v < vertexCount; ++v)
+        live[v] = adjacency.count(v);
+
+    std::vector<bool>         emitted(triangleCount, false);
+    std::vector<unsigned int> loaded(vertexCount, 0);
+    std::vector<GLuint>       deadEnd;
+    std::vector<GLuint>       candidates;
+    deadEnd.reserve(indexCount);
+
+    unsigned int time    = cacheSize + 1;
+    GLuint       cursor  = 0;
+    GLuint       written = 0;
+
+    // Next vertex with triangles left: the most recent dead end first, then input order.
+    auto skipDeadEnd = [&]() -> GLuint
+    {
+        while(!deadEnd.empty())
+        {
+            GLuint vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if(live[vertex] > 0)
+                return vertex;
+        }
+        while(cursor < vertexCount)
+        {
+            if(live[cursor] > 0)
+                return cursor;
+            ++cursor;
+        }
+        return ~0u;
+    };
+
+    GLuint fanning = skipDeadEnd();
+    if(clusters && fanning != ~0u)
+        clusters->push_back(0);
+
+    while(fanning != ~0u)
+    {
+        // Emit every triangle left around the fanning vertex.
+        candidates.clear();
+        for(GLuint a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; ++a)
+        {
+            GLuint triangle = adjacency.triangles[a];
+            if(emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+
+            for(int corner = 0; corner < 3; ++corner)
+            {
+                GLuint vertex = indices[triangle * 3 + corner];
+                destination[written++] = vertex;
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                --live[vertex];
+                if(time - loaded[vertex] > cacheSize)
+                    loaded[vertex] = time++;
+            }
+        }
+
+        // Prefer the candidate that stays in the cache after its remaining triangles are emitted,
+        // and among those the one loaded earliest.
+        GLuint next     = ~0u;
+        int    priority = -1;
+        for(std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            GLuint vertex = candidates[i];
+            if(live[vertex] == 0)
+                continue;
+
+            int score = 0;
+            if(time - loaded[vertex] + 2 * live[vertex] <= cacheSize)
+                score = (int)(time - loaded[vertex]);
+            if(score > priority)
+            {
+                priority = score;
+                next     = vertex;
+            }
+        }
+
+        if(next == ~0u)
+        {
+            next = skipDeadEnd();
+            if(clusters && next != ~0u)
+                clusters->push_back(written / 3);
+        }
+        fanning = next;
+    }
+}
+
+// ------------------------------------------------------------------------
+void optimizeOverdraw(GLuint* destination, const GLuint* indices, std::size_t indexCount,
+                      const float* positions, GLsizei positionStride, GLuint vertexCount,
+                      const std::vector<GLuint> &clusters, float threshold, unsigned int cacheSize)
+{
+    const GLuint triangleCount = (GLuint)(indexCount / 3);
+    if(triangleCount == 0)
+        return;
+
+    std::vector<GLuint> bounds(clusters);
+    if(bounds.empty() || bounds.front() != 0)
+        bounds.insert(bounds.begin(), 0);
+    bounds.push_back(triangleCount);
+
+    // Split every cluster wherever its prefix is already within 'threshold' of the whole cluster's ACMR.
+    CacheSimulation     cache(vertexCount, cacheSize);
+    std::vector<GLuint> split;
+    for(std::size_t c = 0; c + 1 < bounds.size(); ++c)
+    {
+        GLuint first = bounds[c];
+        GLuint last  = bounds[c + 1];
+        if(first == last)
+            continue;
+
+        cache.reset();
+        float clusterAcmr = (float)simulateMisses(cache, indices, first, last) / (float)(last - first);
+
+        cache.reset();
+        GLuint       start  = first;
+        unsigned int misses = 0;
+        for(GLuint triangle = first; triangle < last; ++triangle)
+        {
+            misses += simulateMisses(cache, indices, triangle, triangle + 1);
+            if(triangle + 1 < last && (float)misses <= threshold * clusterAcmr * (float)(triangle + 1 - start))
+            {
+                split.push_back(start);
+                start  = triangle + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+        split.push_back(start);
+    }
+    split.push_back(triangleCount);
+
+    // Area weighted centroid and normal of every cluster.
+    const std::size_t   clusterCount = split.size() - 1;
+    std::vector<glm::vec3> centroids(clusterCount);
+    std::vector<glm::vec3> normals(clusterCount);
+    glm::vec3 meshCentroid(0.0f);
+    float     meshArea = 0.0f;
+
+    for(std::size_t c = 0; c < clusterCount; ++c)
+    {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float     area = 0.0f;
+
+        for(GLuint triangle = split[c]; triangle < split[c + 1]; ++triangle)
+        {
+            glm::vec3 p0 = position(positions, positionStride, indices[triangle * 3 + 0]);
+            glm::vec3 p1 = position(positions, positionStride, indices[triangle * 3 + 1]);
+            glm::vec3 p2 = position(positions, positionStride, indices[triangle * 3 + 2]);
+
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float     a = glm::length(n);
+
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal   += n;
+            area     += a;
+        }
+
+        meshCentroid += centroid;
+        meshArea     += area;
+
+        centroids[c] = area > 0.0f ? centroid / area : centroid;
+        float length = glm::length(normal);
+        normals[c]   = length > 0.0f ? normal / length : normal;
+    }
+    if(meshArea > 0.0f)
+        meshCentroid /= meshArea;
+
+    // Clusters facing away from the centre are the ones likely to be in front: draw them first.
+    std::vector<float>  keys(clusterCount);
+    std::vector<GLuint> order(clusterCount);
+    for(std::size_t c = 0; c < clusterCount; ++c)
+    {
+        keys[c]  = glm::dot(centroids[c] - meshCentroid, normals[c]);
+        order[c] = (GLuint)c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](GLuint a, GLuint b) { return keys[a] > keys[b]; });
+
+    GLuint written = 0;
+    for(std::size_t c = 0; c < clusterCount; ++c)
+    {
+        GLuint first = split[order[c]];
+        GLuint last  = split[order[c] + 1];
+        std::memcpy(destination + written, indices + first * 3, (last - first) * 3 * sizeof(GLuint));
+        written += (last - first) * 3;
+    }
+}
+
+// ------------------------------------------------------------------------
+GLuint optimizeVertexFetchRemap(std::vector<GLuint> &remap, const GLuint* indices, std::size_t indexCount, GLuint vertexCount)
+{
+    remap.assign(vertexCount, ~0u);
+
+    GLuint next = 0;
+    for(std::size_t i = 0; i < indexCount; ++i)
+    {
+        if(remap[indices[i]] == ~0u)
+            remap[indices[i]] = next++;
+    }
+    return next;
+}
+
+GLuint weldVerticesRemap(std::vector<GLuint> &remap, const void* vertices, GLuint vertexCount, GLsizei stride)
+{
+    remap.assign(vertexCount, ~0u);
+
+    const unsigned char* data = (const unsigned char*)vertices;
+
+    std::size_t tableSize = 1;
+    while(tableSize < (std::size_t)vertexCount * 2)
+        tableSize *= 2;
+    std::vector<GLuint> table(tableSize, ~0u);  // Open addressing, holds the first vertex of each kind.
+
+    GLuint unique = 0;
+    for(GLuint vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        const unsigned char* bytes = data + (std::size_t)vertex * stride;
+
+        // FNV-1a over the whole vertex.
+        std::uint32_t hash = 2166136261u;
+        for(GLsizei i = 0; i < stride; ++i)
+            hash = (hash ^ bytes[i]) * 16777619u;
+
+        std::size_t slot = hash & (tableSize - 1);
+        while(table[slot] != ~0u && std::memcmp(data + (std::size_t)table[slot] * stride, bytes, stride) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if(table[slot] == ~0u)
+        {
+            table[slot]    = vertex;
+            remap[vertex]  = unique++;
+        }
+        else
+            remap[vertex] = remap[table[slot]];
+    }
+    return unique;
+}
+
+// ------------------------------------------------------------------------
+MeshOptimizerReport optimizeMesh(Mesh &mesh, GLuint positionLocation, unsigned int cacheSize, float overdrawThreshold)
+{
+    MeshOptimizerReport report;
+    report.verticesBefore = mesh.vertexCount();
+    report.before         = analyzeVertexCache(mesh.indices().data(), mesh.indices().size(), mesh.vertexCount(), cacheSize);
+
+    std::vector<GLuint> remap;
+    GLuint unique = weldVerticesRemap(remap, mesh.vertices(), mesh.vertexCount(), mesh.layout().stride());
+    mesh.remapVertices(remap, unique);
+
+    std::vector<GLuint> &indices = mesh.indices();
+    std::vector<GLuint>  cacheOrder(indices.size());
+    std::vector<GLuint>  clusters;
+    optimizeVertexCache(cacheOrder.data(), indices.data(), indices.size(), mesh.vertexCount(), cacheSize, &clusters);
+
+    if(mesh.layout().find(positionLocation))
+    {
+        std::vector<float> positions((std::size_t)mesh.vertexCount() * 3);
+        for(GLuint vertex = 0; vertex < mesh.vertexCount(); ++vertex)
+        {
+            glm::vec4 p = mesh.get(positionLocation, vertex);
+            positions[vertex * 3 + 0] = p.x;
+            positions[vertex * 3 + 1] = p.y;
+            positions[vertex * 3 + 2] = p.z;
+        }
+        optimizeOverdraw(indices.data(), cacheOrder.data(), cacheOrder.size(), positions.data(), 3 * sizeof(float),
+                         mesh.vertexCount(), clusters, overdrawThreshold, cacheSize);
+    }
+    else
+        indices.swap(cacheOrder);
+
+    GLuint used = optimizeVertexFetchRemap(remap, indices.data(), indices.size(), mesh.vertexCount());
+    mesh.remapVertices(remap, used);
+
+    report.verticesAfter = mesh.vertexCount();
+    report.after         = analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount(), cacheSize);
+    return report;
+}
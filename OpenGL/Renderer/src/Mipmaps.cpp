@@ -0,0 +1,53 @@
+#include "Renderer/Mipmaps.hpp"
+#include "Renderer/ImageProcessing.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    void downsampleLinear(const LinearImage &source, LinearImage &result, MipFilter filter)
+    {
+        if(filter == MipFilter::Kaiser)
+            downsampleKaiser(source, result);
+        else
+            downsampleBox(source, result);
+    }
+}
+
+GLsizei mipLevelCount(GLsizei width, GLsizei height)
+{
+    GLsizei levels = 1;
+    for(GLsizei size = std::max(width, height); size > 1; size /= 2)
+        ++levels;
+    return levels;
+}
+
+Image downsample(const Image &source, const MipOptions &options)
+{
+    LinearImage linear, half;
+    toLinear(source, linear, options.srgb);
+    downsampleLinear(linear, half, options.filter);
+
+    Image result;
+    fromLinear(half, result, options.srgb);
+    return result;
+}
+
+void buildMipChain(std::vector<Image> &levels, const MipOptions &options)
+{
+    if(levels.empty())
+        return;
+
+    levels.reserve(mipLevelCount(levels.back().width, levels.back().height) + levels.size() - 1);
+
+    LinearImage current, next;
+    toLinear(levels.back(), current, options.srgb);
+    while(current.width > 1 || current.height > 1)
+    {
+        downsampleLinear(current, next, options.filter);
+        std::swap(current, next);
+
+        levels.push_back(Image());
+        fromLinear(current, levels.back(), options.srgb);
+    }
+}
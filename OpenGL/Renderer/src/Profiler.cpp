@@ -0,0 +1,356 @@
+#include "Renderer/Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const char* FRAME_ZONE = "Frame";
+
+    ProfileStats summarize(const std::vector<float> &samples)
+    {
+        ProfileStats stats = { 0.0, 0.0, 0.0, (unsigned int)samples.size() };
+        if(samples.empty())
+            return stats;
+
+        std::vector<float> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for(std::size_t i = 0; i < sorted.size(); ++i)
+            sum += sorted[i];
+
+        std::size_t p99 = (sorted.size() * 99 + 99) / 100;
+        stats.min     = sorted.front();
+        stats.average = sum / sorted.size();
+        stats.p99     = sorted[std::min(p99, sorted.size()) - 1];
+        return stats;
+    }
+
+    void writeEscaped(std::ofstream &out, const std::string &text)
+    {
+        for(std::size_t i = 0; i < text.size(); ++i)
+        {
+            if(text[i] == '"' || text[i] == '\\')
+                out << '\\';
+            if((unsigned char)text[i] >= 0x20)
+                out << text[i];
+        }
+    }
+}
+
+Profiler::Profiler(unsigned int frameLatency, unsigned int history)
+    : enabledNextFrame(true), active(false), gpuActive(false), timerQueries(GLAD_GL_VERSION_3_3 != 0),
+      history(std::max(history, 1u)), frame(0), dropped(0), epoch(Clock::now()), gpuOffset(0),
+      ring(std::max(frameLatency, 1u)), ringFrames(ring.size(), 0)
+{
+    for(std::size_t i = 0; i < ring.size(); ++i)
+    {
+        ring[i].used    = 0;
+        ring[i].pending = false;
+    }
+
+    if(timerQueries)
+    {
+        GLint64 gpuNow = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+        gpuOffset = (std::int64_t)now() - gpuNow;
+    }
+}
+
+Profiler::~Profiler()
+{
+    for(std::size_t i = 0; i < ring.size(); ++i)
+    {
+        if(!ring[i].queries.empty())
+            glDeleteQueries((GLsizei)ring[i].queries.size(), ring[i].queries.data());
+    }
+}
+
+// ------------------------------------------------------------------------
+void Profiler::beginFrame()
+{
+    active = enabledNextFrame;
+    if(!active)
+        return;
+
+    ++frame;
+    resolveQueries();
+
+    FrameQueries &queries = ring[frame % ring.size()];
+    gpuActive = timerQueries && !queries.pending;
+    if(timerQueries && queries.pending)
+        ++dropped;
+
+    if(gpuActive)
+    {
+        queries.used = 0;
+        queries.ranges.clear();
+        queries.open.clear();
+        ringFrames[frame % ring.size()] = frame;
+    }
+
+    beginCpu(FRAME_ZONE);
+    beginGpu(FRAME_ZONE);
+}
+
+void Profiler::endFrame()
+{
+    if(!active)
+        return;
+
+    // Scopes left open end with the frame; "Frame" is the last of them.
+    FrameQueries &queries = ring[frame % ring.size()];
+    while(gpuActive && !queries.open.empty())
+        endGpu();
+    while(!cpuStack.empty())
+        endCpu();
+
+    if(gpuActive && queries.used > 0)
+        queries.pending = true;
+
+    for(std::size_t i = 0; i < zones.size(); ++i)
+    {
+        Zone &zone = zones[i];
+        if(zone.cpuFrameCalls == 0)
+            continue;
+
+        addSample(zone.cpuSamples, zone.cpuNext, zone.cpuFrameTime);
+        zone.calls        += zone.cpuFrameCalls;
+        zone.framesSeen   += 1;
+        zone.cpuFrameTime  = 0;
+        zone.cpuFrameCalls = 0;
+    }
+
+    while(!trace.empty() && trace.front().frame + history < frame)
+        trace.pop_front();
+
+    active = false;
+}
+
+// ------------------------------------------------------------------------
+void Profiler::beginCpu(const char* name)
+{
+    if(!active)
+        return;
+
+    OpenCpuScope scope = { zoneIndex(name), now() };
+    cpuStack.push_back(scope);
+}
+
+void Profiler::endCpu()
+{
+    if(!active || cpuStack.empty())
+        return;
+
+    OpenCpuScope scope = cpuStack.back();
+    cpuStack.pop_back();
+
+    std::uint64_t duration = now() - scope.start;
+    zones[scope.zone].cpuFrameTime  += duration;
+    zones[scope.zone].cpuFrameCalls += 1;
+
+    TraceEvent event = { scope.zone, false, scope.start, duration, frame };
+    trace.push_back(event);
+}
+
+void Profiler::beginGpu(const char* name)
+{
+    if(!active || !gpuActive)
+        return;
+
+    FrameQueries &queries = ring[frame % ring.size()];
+    if(queries.used == queries.queries.size())
+    {
+        // Grows once to the busiest frame's needs, then every frame reuses the same names.
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        queries.queries.push_back(query);
+    }
+
+    GpuRange range = { zoneIndex(name), queries.used, 0 };
+    glQueryCounter(queries.queries[queries.used++], GL_TIMESTAMP);
+
+    queries.open.push_back((unsigned int)queries.ranges.size());
+    queries.ranges.push_back(range);
+}
+
+void Profiler::endGpu()
+{
+    if(!active || !gpuActive)
+        return;
+
+    FrameQueries &queries = ring[frame % ring.size()];
+    if(queries.open.empty())
+        return;
+
+    if(queries.used == queries.queries.size())
+    {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        queries.queries.push_back(query);
+    }
+
+    queries.ranges[queries.open.back()].end = queries.used;
+    queries.open.pop_back();
+    glQueryCounter(queries.queries[queries.used++], GL_TIMESTAMP);
+}
+
+// ------------------------------------------------------------------------
+void Profiler::resolveQueries()
+{
+    // Oldest first; once one isn't ready, the later ones can't be either.
+    for(;;)
+    {
+        std::size_t   oldest      = ring.size();
+        std::uint64_t oldestFrame = 0;
+        for(std::size_t i = 0; i < ring.size(); ++i)
+        {
+            if(ring[i].pending && (oldest == ring.size() || ringFrames[i] < oldestFrame))
+            {
+                oldest      = i;
+                oldestFrame = ringFrames[i];
+            }
+        }
+        if(oldest == ring.size())
+            return;
+
+        FrameQueries &queries = ring[oldest];
+        GLint available = 0;
+        glGetQueryObjectiv(queries.queries[queries.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available)
+            return;
+
+        resolve(queries, oldestFrame);
+    }
+}
+
+void Profiler::resolve(FrameQueries &queries, std::uint64_t frameNumber)
+{
+    std::vector<GLuint64> times(queries.used);
+    for(unsigned int i = 0; i < queries.used; ++i)
+        glGetQueryObjectui64v(queries.queries[i], GL_QUERY_RESULT, &times[i]);
+
+    for(std::size_t i = 0; i < queries.ranges.size(); ++i)
+    {
+        const GpuRange &range = queries.ranges[i];
+        std::uint64_t duration = times[range.end] > times[range.begin] ? times[range.end] - times[range.begin] : 0;
+
+        Zone &zone = zones[range.zone];
+        zone.gpuFrameTime += duration;
+        zone.gpuTouched    = true;
+
+        std::int64_t start = (std::int64_t)times[range.begin] + gpuOffset;
+        TraceEvent event = { range.zone, true, (std::uint64_t)std::max<std::int64_t>(start, 0), duration, frameNumber };
+        trace.push_back(event);
+    }
+
+    for(std::size_t i = 0; i < zones.size(); ++i)
+    {
+        if(!zones[i].gpuTouched)
+            continue;
+        addSample(zones[i].gpuSamples, zones[i].gpuNext, zones[i].gpuFrameTime);
+        zones[i].gpuFrameTime = 0;
+        zones[i].gpuTouched   = false;
+    }
+
+    queries.pending = false;
+}
+
+// ------------------------------------------------------------------------
+unsigned int Profiler::zoneIndex(const char* name)
+{
+    // The pointer is only a hint: a reused buffer may hold a different name now.
+    std::unordered_map<const char*, unsigned int>::const_iterator cached = zonesByPointer.find(name);
+    if(cached != zonesByPointer.end() && std::strcmp(zones[cached->second].name.c_str(), name) == 0)
+        return cached->second;
+
+    unsigned int index;
+    std::unordered_map<std::string, unsigned int>::const_iterator found = zonesByName.find(name);
+    if(found != zonesByName.end())
+        index = found->second;
+    else
+    {
+        Zone zone;
+        zone.name          = name;
+        zone.cpuNext       = 0;
+        zone.gpuNext       = 0;
+        zone.cpuFrameTime  = 0;
+        zone.gpuFrameTime  = 0;
+        zone.cpuFrameCalls = 0;
+        zone.gpuTouched    = false;
+        zone.calls         = 0;
+        zone.framesSeen    = 0;
+
+        index = (unsigned int)zones.size();
+        zones.push_back(zone);
+        zonesByName[zone.name] = index;
+    }
+
+    zonesByPointer[name] = index;
+    return index;
+}
+
+std::uint64_t Profiler::now() const
+{
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+
+void Profiler::addSample(std::vector<float> &samples, std::size_t &next, std::uint64_t nanoseconds)
+{
+    float milliseconds = (float)(nanoseconds / 1e6);
+    if(samples.size() < history)
+        samples.push_back(milliseconds);
+    else
+        samples[next] = milliseconds;
+    next = (next + 1) % history;
+}
+
+std::vector<ProfileZoneStats> Profiler::stats() const
+{
+    std::vector<ProfileZoneStats> result(zones.size());
+    for(std::size_t i = 0; i < zones.size(); ++i)
+    {
+        result[i].name          = zones[i].name;
+        result[i].cpu           = summarize(zones[i].cpuSamples);
+        result[i].gpu           = summarize(zones[i].gpuSamples);
+        result[i].callsPerFrame = zones[i].framesSeen ? (double)zones[i].calls / zones[i].framesSeen : 0.0;
+    }
+    return result;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path) const
+{
+    std::ofstream out(path.c_str(), std::ios::trunc);
+    if(!out)
+    {
+        std::cout << "ERROR::PROFILER::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    // Microseconds, with the nanoseconds kept as decimals.
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for(std::deque<TraceEvent>::const_iterator event = trace.begin(); event != trace.end(); ++event)
+    {
+        out << ",\n{\"name\":\"";
+        writeEscaped(out, zones[event->zone].name);
+        out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event->gpu ? 2 : 1)
+            << ",\"ts\":" << event->start / 1000.0 << ",\"dur\":" << event->duration / 1000.0
+            << ",\"args\":{\"frame\":" << event->frame << "}}";
+    }
+    out << "\n]}\n";
+
+    if(!out)
+    {
+        std::cout << "ERROR::PROFILER::WRITE_FAILED " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#include "Renderer/RenderTarget.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+
+#include <iostream>
+
+RenderTarget::RenderTarget(GLStateCache &state, GLsizei width, GLsizei height)
+    : state(state), framebuffer(0), color(0), depthStencil(0), targetWidth(width), targetHeight(height), complete(false)
+{
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthStencil);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil);
+
+    complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if(!complete)
+        std::cout << "ERROR::RENDER_TARGET::INCOMPLETE " << width << "x" << height << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTarget::~RenderTarget()
+{
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color);
+    glDeleteRenderbuffers(1, &depthStencil);
+}
+
+// ------------------------------------------------------------------------
+void RenderTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    state.viewport(0, 0, targetWidth, targetHeight);
+}
+
+void RenderTarget::unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::readPixels(Image &image)
+{
+    image = Image(targetWidth, targetHeight);
+
+    // A bound pack buffer would turn the pointer into an offset.
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, targetWidth, targetHeight, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+}
@@ -0,0 +1,145 @@
+#include "Renderer/TextureCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// ------------------------------------------------------------------------
+TextureCache::TextureCache(const std::string &directory)
+    : directory(directory)
+{
+    if(this->directory.empty())
+        this->directory = ".";
+
+    // Failing because it already exists is the common case; a real failure shows up on write.
+#ifdef _WIN32
+    _mkdir(this->directory.c_str());
+#else
+    mkdir(this->directory.c_str(), 0755);
+#endif
+}
+
+std::string TextureCache::path(std::uint64_t key) const
+{
+    std::ostringstream name;
+    name << directory << "/" << std::hex;
+    name.width(16);
+    name.fill('0');
+    name << key << ".lgpt";
+    return name.str();
+}
+
+bool TextureCache::read(std::uint64_t key, BlockFormat &format, std::vector<CompressedImage> &levels) const
+{
+    std::ifstream in(path(key).c_str(), std::ios::binary | std::ios::ate);
+    if(!in)
+        return false;
+
+    // Every level is checked against what is left of the file before anything is allocated for it.
+    std::uint64_t remaining = (std::uint64_t)in.tellg();
+    in.seekg(0);
+
+    TextureCacheHeader header;
+    if(!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != TEXTURE_CACHE_MAGIC
+        || header.version != TEXTURE_CACHE_VERSION || header.key != key || header.format > (std::uint32_t)BlockFormat::BC3
+        || header.levelCount == 0 || header.levelCount > 32)
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::BAD_HEADER " << path(key) << std::endl;
+        return false;
+    }
+
+    std::vector<TextureCacheLevel> sizes(header.levelCount);
+    if(!in.read(reinterpret_cast<char*>(sizes.data()), (std::streamsize)(sizes.size() * sizeof(TextureCacheLevel))))
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::TRUNCATED " << path(key) << std::endl;
+        return false;
+    }
+    remaining -= sizeof(header) + sizes.size() * sizeof(TextureCacheLevel);
+
+    format = (BlockFormat)header.format;
+    levels.resize(header.levelCount);
+    for(std::size_t i = 0; i < levels.size(); ++i)
+    {
+        if(sizes[i].width == 0 || sizes[i].height == 0 || sizes[i].width > MAX_TEXTURE_CACHE_SIZE || sizes[i].height > MAX_TEXTURE_CACHE_SIZE
+            || compressedSize(format, (GLsizei)sizes[i].width, (GLsizei)sizes[i].height) > remaining)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::BAD_LEVEL " << i << " " << path(key) << std::endl;
+            levels.clear();
+            return false;
+        }
+
+        levels[i].width  = (GLsizei)sizes[i].width;
+        levels[i].height = (GLsizei)sizes[i].height;
+        levels[i].data.resize(compressedSize(format, levels[i].width, levels[i].height));
+        remaining -= levels[i].data.size();
+        if(!in.read(reinterpret_cast<char*>(levels[i].data.data()), (std::streamsize)levels[i].data.size()))
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::TRUNCATED " << path(key) << std::endl;
+            levels.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureCache::write(std::uint64_t key, BlockFormat format, const std::vector<CompressedImage> &levels) const
+{
+    const std::string target = path(key);
+
+    // Unique per thread, in case two textures with the same content finish together.
+    std::ostringstream temporary;
+    temporary << target << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+    {
+        std::ofstream out(temporary.str().c_str(), std::ios::binary | std::ios::trunc);
+        if(!out)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::WRITE_FAILED " << target << std::endl;
+            return false;
+        }
+
+        TextureCacheHeader header = { TEXTURE_CACHE_MAGIC, TEXTURE_CACHE_VERSION, (std::uint32_t)format, (std::uint32_t)levels.size(), key };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for(std::size_t i = 0; i < levels.size(); ++i)
+        {
+            TextureCacheLevel level = { (std::uint32_t)levels[i].width, (std::uint32_t)levels[i].height };
+            out.write(reinterpret_cast<const char*>(&level), sizeof(level));
+        }
+        for(std::size_t i = 0; i < levels.size(); ++i)
+            out.write(reinterpret_cast<const char*>(levels[i].data.data()), (std::streamsize)levels[i].data.size());
+
+        if(!out)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::WRITE_FAILED " << target << std::endl;
+            out.close();
+            std::remove(temporary.str().c_str());
+            return false;
+        }
+    }
+
+    // Windows won't rename over an existing file; whoever got there first wrote the same bytes.
+    if(std::rename(temporary.str().c_str(), target.c_str()) != 0)
+        std::remove(temporary.str().c_str());
+    return true;
+}
@@ -0,0 +1,423 @@
+#include "Renderer/TextureManager.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/MappedFile.hpp"
+#include "Renderer/Mipmaps.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    bool hasExtension(const char* name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for(GLint i = 0; i < count; ++i)
+        {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+            if(extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Everything that changes the encoded result besides the source bytes.
+    std::uint64_t cacheKey(const unsigned char* data, std::size_t size, bool mipmaps, bool srgb)
+    {
+        const std::uint32_t settings[] = { TEXTURE_CACHE_VERSION, mipmaps ? 1u : 0u, srgb ? 1u : 0u };
+        return hashBytes(settings, sizeof(settings), hashBytes(data, size));
+    }
+
+    // Runs on a worker: cache lookup, or decode, mipmap and (if asked) compress.
+    void decodeTexture(const std::string &path, bool mipmaps, bool srgb, bool compress, const TextureCache* cache,
+                       GLenum &format, std::vector<Image> &levels, std::vector<CompressedImage> &compressed)
+    {
+        format = 0;
+
+        MappedFile file;
+        if(!file.open(path))
+            return;
+
+        std::uint64_t key = 0;
+        if(compress && cache)
+        {
+            key = cacheKey(file.data(), file.size(), mipmaps, srgb);
+
+            BlockFormat cached;
+            if(cache->read(key, cached, compressed))
+            {
+                format = compressedInternalFormat(cached, srgb);
+                return;
+            }
+        }
+
+        levels.resize(1);
+        if(!decodeImage(file.data(), file.size(), levels[0]))
+        {
+            std::cout << "ERROR::TEXTURE_MANAGER::UNSUPPORTED_FORMAT " << path << std::endl;
+            levels.clear();
+            return;
+        }
+        file.close();
+
+        if(mipmaps)
+            buildMipChain(levels, MipOptions(MipFilter::Box, srgb));
+
+        if(!compress)
+            return;
+
+        BlockFormat blockFormat = chooseBlockFormat(levels[0]);
+        compressed.resize(levels.size());
+        for(std::size_t i = 0; i < levels.size(); ++i)
+            compressImage(levels[i], blockFormat, compressed[i]);
+        levels.clear();
+
+        format = compressedInternalFormat(blockFormat, srgb);
+        if(cache)
+            cache->write(key, blockFormat, compressed);
+    }
+
+    BlockFormat blockFormatOf(GLenum format)
+    {
+        return format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT || format == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT ? BlockFormat::BC1 : BlockFormat::BC3;
+    }
+}
+
+TextureManager::TextureManager(GLStateCache &state, unsigned int threadCount, std::size_t uploadBufferSize, unsigned int uploadBufferCount)
+    : state(state), placeholderTexture(0), lastUploaded(0),
+      ringSize(uploadBufferSize), nextBuffer(0), fences(GLAD_GL_VERSION_3_2 != 0),
+      s3tc(false), s3tcSrgb(false), compress(false), workers(threadCount)
+{
+    s3tc     = hasExtension("GL_EXT_texture_compression_s3tc");
+    s3tcSrgb = s3tc && (hasExtension("GL_EXT_texture_sRGB") || hasExtension("GL_EXT_texture_compression_s3tc_srgb"));
+
+    createPlaceholder();
+
+    ring.resize(std::max(uploadBufferCount, 1u));
+    for(std::size_t i = 0; i < ring.size(); ++i)
+    {
+        glGenBuffers(1, &ring[i].buffer);
+        ring[i].fence = 0;
+
+        state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, ring[i].buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)ringSize, nullptr, GL_STREAM_DRAW);
+    }
+    state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+TextureManager::~TextureManager()
+{
+    for(std::size_t i = 0; i < ring.size(); ++i)
+    {
+        if(ring[i].fence)
+            glDeleteSync(ring[i].fence);
+        glDeleteBuffers(1, &ring[i].buffer);
+        state.bufferDeleted(ring[i].buffer);
+    }
+
+    for(std::size_t i = 0; i < textures.size(); ++i)
+    {
+        if(textures[i].name)
+        {
+            glDeleteTextures(1, &textures[i].name);
+            state.textureDeleted(textures[i].name);
+        }
+    }
+
+    glDeleteTextures(1, &placeholderTexture);
+    state.textureDeleted(placeholderTexture);
+}
+
+// 2x2 magenta / black checker, hard to mistake for real content.
+void TextureManager::createPlaceholder()
+{
+    const unsigned char pixels[] = {
+        255, 0, 255, 255,    0, 0,   0, 255,
+          0, 0,   0, 255,  255, 0, 255, 255
+    };
+
+    glGenTextures(1, &placeholderTexture);
+    state.bindTexture(0, GL_TEXTURE_2D, placeholderTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+// ------------------------------------------------------------------------
+TextureHandle TextureManager::load(const std::string &path, bool mipmaps, bool srgb)
+{
+    const TextureKey key(path, mipmaps, srgb);
+    std::map<TextureKey, TextureHandle>::const_iterator found = handles.find(key);
+    if(found != handles.end())
+        return found->second;
+
+    Texture texture = { path, 0, State::Decoding, srgb, 0 };
+    textures.push_back(texture);
+
+    TextureHandle handle = (TextureHandle)textures.size();
+    handles[key] = handle;
+
+    const bool compressed = compress && (!srgb || s3tcSrgb);
+    std::shared_ptr<const TextureCache> textureCache = cache;
+
+    workers.submit([this, path, handle, mipmaps, srgb, compressed, textureCache]()
+    {
+        Decoded result;
+        result.handle = handle;
+        decodeTexture(path, mipmaps, srgb, compressed, textureCache.get(), result.format, result.levels, result.compressed);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(std::move(result));
+    });
+    return handle;
+}
+
+void TextureManager::setCompression(bool enabled, const std::string &cacheDirectory)
+{
+    if(enabled && !s3tc)
+    {
+        std::cout << "ERROR::TEXTURE_MANAGER::S3TC_NOT_SUPPORTED" << std::endl;
+        enabled = false;
+    }
+
+    compress = enabled;
+    if(enabled && !cacheDirectory.empty())
+        cache = std::make_shared<const TextureCache>(cacheDirectory);
+    else
+        cache.reset();
+}
+
+void TextureManager::update(std::size_t budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while(!decoded.empty())
+        {
+            Decoded &result  = decoded.front();
+            Texture &texture = textures[result.handle - 1];
+
+            if(result.levels.empty() && result.compressed.empty())
+                texture.state = State::Failed;
+            else
+            {
+                Upload upload;
+                upload.handle = result.handle;
+                upload.format = result.format;
+                upload.levels.swap(result.levels);
+                upload.compressed.swap(result.compressed);
+                upload.level  = 0;
+                upload.row    = 0;
+                uploads.push_back(std::move(upload));
+                texture.state = State::Uploading;
+            }
+            decoded.pop_front();
+        }
+    }
+
+    lastUploaded = 0;
+    while(!uploads.empty() && lastUploaded < budget)
+    {
+        Upload  &upload  = uploads.front();
+        Texture &texture = textures[upload.handle - 1];
+
+        if(!texture.name)
+        {
+            // Without glTexStorage2D compressed textures go up whole, so they get a frame of their own.
+            if(!GLAD_GL_VERSION_4_2 && upload.format && lastUploaded > 0)
+                break;
+            allocate(texture, upload);
+        }
+
+        if(upload.level < upload.levelCount() && !uploadRows(upload, budget, lastUploaded))
+            break;
+
+        if(upload.level == upload.levelCount())
+        {
+            texture.state = State::Resident;
+            uploads.pop_front();
+        }
+    }
+
+    // Left bound, the unpack buffer would turn every later glTexImage2D pointer into an offset.
+    state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// ------------------------------------------------------------------------
+void TextureManager::allocate(Texture &texture, Upload &upload)
+{
+    const GLsizei levelCount     = (GLsizei)upload.levelCount();
+    const GLenum  internalFormat = upload.format ? upload.format : texture.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    const GLsizei width          = upload.format ? upload.compressed[0].width  : upload.levels[0].width;
+    const GLsizei height         = upload.format ? upload.compressed[0].height : upload.levels[0].height;
+
+    glGenTextures(1, &texture.name);
+    state.bindTexture(0, GL_TEXTURE_2D, texture.name);
+
+    texture.bytes = 0;
+    for(GLsizei level = 0; level < levelCount; ++level)
+        texture.bytes += upload.format ? upload.compressed[level].data.size() : upload.levels[level].size();
+
+    if(GLAD_GL_VERSION_4_2)
+        glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, width, height);
+    else if(upload.format)
+    {
+        // Compressed levels can't be allocated empty everywhere, so they go up in one go.
+        state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        for(GLsizei level = 0; level < levelCount; ++level)
+        {
+            const CompressedImage &image = upload.compressed[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, image.width, image.height, 0, (GLsizei)image.data.size(), image.data.data());
+        }
+        upload.level  = upload.levelCount();
+        lastUploaded += texture.bytes;
+    }
+    else
+    {
+        state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        for(GLsizei level = 0; level < levelCount; ++level)
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, upload.levels[level].width, upload.levels[level].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+bool TextureManager::uploadRows(Upload &upload, std::size_t budget, std::size_t &uploaded)
+{
+    // A "row" is a row of pixels, or of 4x4 blocks when compressed.
+    GLsizei              width, height, rowHeight;
+    std::size_t          rowSize;
+    const unsigned char* pixels;
+    if(upload.format)
+    {
+        const CompressedImage &image = upload.compressed[upload.level];
+        width     = image.width;
+        height    = image.height;
+        rowHeight = 4;
+        rowSize   = (std::size_t)((width + 3) / 4) * blockSize(blockFormatOf(upload.format));
+        pixels    = image.data.data();
+    }
+    else
+    {
+        const Image &image = upload.levels[upload.level];
+        width     = image.width;
+        height    = image.height;
+        rowHeight = 1;
+        rowSize   = (std::size_t)width * 4;
+        pixels    = image.pixels.data();
+    }
+
+    // update() only calls with budget left. A row that doesn't fit in it waits for the next frame,
+    // unless it is bigger than the whole budget: then it goes up alone, as the frame's first upload.
+    const std::size_t remaining = budget - uploaded;
+    const GLsizei     rowCount  = (height + rowHeight - 1) / rowHeight;
+    GLsizei rows = (GLsizei)std::min<std::size_t>(rowCount - upload.row, std::min(ringSize, remaining) / rowSize);
+    if(rows == 0)
+    {
+        if(uploaded > 0)
+            return false;
+        rows = 1;
+    }
+    const unsigned char* source = pixels + upload.row * rowSize;
+
+    state.bindTexture(0, GL_TEXTURE_2D, textures[upload.handle - 1].name);
+
+    // Client memory, or nullptr for an offset of 0 into the bound ring buffer.
+    const void*   data = source;
+    UploadBuffer* used = nullptr;
+    if(rowSize > ringSize)
+    {
+        // A single row larger than a ring buffer: let the driver copy it from client memory.
+        state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        UploadBuffer &buffer = ring[nextBuffer];
+        if(buffer.fence)
+        {
+            // Zero timeout: a buffer the GPU still reads from ends this frame's uploads.
+            GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+            if(status == GL_TIMEOUT_EXPIRED)
+                return false;
+            glDeleteSync(buffer.fence);
+            buffer.fence = 0;
+        }
+
+        const std::size_t bytes = rows * rowSize;
+        state.bindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.buffer);
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        if(fences)
+            access |= GL_MAP_UNSYNCHRONIZED_BIT;
+        else
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)ringSize, nullptr, GL_STREAM_DRAW);
+
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes, access);
+        if(!mapped)
+        {
+            std::cout << "ERROR::TEXTURE_MANAGER::MAP_FAILED" << std::endl;
+            return false;
+        }
+        std::memcpy(mapped, source, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        data = nullptr;
+        used = &buffer;
+
+        nextBuffer = (nextBuffer + 1) % ring.size();
+    }
+
+    // The last block row may be partial; it ends at the edge of the level, which makes it legal.
+    const GLint   y         = upload.row * rowHeight;
+    const GLsizei pixelRows = std::min(rows * rowHeight, height - y);
+    if(upload.format)
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)upload.level, 0, y, width, pixelRows, upload.format, (GLsizei)(rows * rowSize), data);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, (GLint)upload.level, 0, y, width, pixelRows, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+    if(used && fences)
+        used->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    uploaded   += rows * rowSize;
+    upload.row += rows;
+    if(upload.row == rowCount)
+    {
+        upload.row = 0;
+        ++upload.level;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+GLuint TextureManager::texture(TextureHandle handle) const
+{
+    if(handle == 0 || handle > textures.size() || textures[handle - 1].state != State::Resident)
+        return placeholderTexture;
+    return textures[handle - 1].name;
+}
+
+bool TextureManager::isResident(TextureHandle handle) const
+{
+    return handle != 0 && handle <= textures.size() && textures[handle - 1].state == State::Resident;
+}
+
+TextureManagerStats TextureManager::stats() const
+{
+    TextureManagerStats result = { 0, 0, 0, 0, lastUploaded, 0 };
+    for(std::size_t i = 0; i < textures.size(); ++i)
+    {
+        switch(textures[i].state)
+        {
+        case State::Decoding:  ++result.decoding;  break;
+        case State::Uploading: ++result.uploading; break;
+        case State::Resident:  ++result.resident; result.residentBytes += textures[i].bytes; break;
+        case State::Failed:    ++result.failed;    break;
+        }
+    }
+    return result;
+}
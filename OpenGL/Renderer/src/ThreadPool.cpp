@@ -0,0 +1,71 @@
+#include "Renderer/ThreadPool.hpp"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : running(0), stopping(false)
+{
+    if(threadCount == 0)
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    workers.reserve(threadCount);
+    for(unsigned int i = 0; i < threadCount; ++i)
+        workers.push_back(std::thread(&ThreadPool::run, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+
+    for(std::size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return jobs.empty() && running == 0; });
+}
+
+// ------------------------------------------------------------------------
+void ThreadPool::run()
+{
+    for(;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if(stopping)
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++running;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --running;
+            if(jobs.empty() && running == 0)
+                idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "Renderer/UniformRingBuffer.hpp"
+
+#include "Renderer/GLStateCache.hpp"
+
+#include <iostream>
+
+namespace
+{
+    void bindUniformBuffer(GLuint buffer)
+    {
+        if(GLStateCache* state = GLStateCache::current())
+            state->bindBuffer(GL_UNIFORM_BUFFER, buffer);
+        else
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    }
+}
+
+UniformRingBuffer::UniformRingBuffer(GLsizeiptr segmentSize, unsigned int segmentCount)
+    : buffer(0), segmentSize(segmentSize), alignment(256), persistent(GLAD_GL_VERSION_4_4 != 0),
+      mapped(nullptr), fences(segmentCount, (GLsync)0), segment(0), head(0), flushed(0)
+{
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    // Keep every segment start aligned too.
+    this->segmentSize = (segmentSize + alignment - 1) / alignment * alignment;
+    GLsizeiptr totalSize = this->segmentSize * segmentCount;
+
+    glGenBuffers(1, &buffer);
+    bindUniformBuffer(buffer);
+
+    if(persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+        persistent = mapped != nullptr;
+    }
+
+    if(!persistent)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        staging.resize(totalSize);
+        mapped = staging.data();
+    }
+
+    bindUniformBuffer(0);
+}
+
+UniformRingBuffer::~UniformRingBuffer()
+{
+    for(std::size_t i = 0; i < fences.size(); ++i)
+    {
+        if(fences[i])
+            glDeleteSync(fences[i]);
+    }
+
+    // Deleting the buffer also unmaps it.
+    glDeleteBuffers(1, &buffer);
+    if(GLStateCache* state = GLStateCache::current())
+        state->bufferDeleted(buffer);
+}
+
+// ------------------------------------------------------------------------
+void UniformRingBuffer::beginFrame()
+{
+    GLsync &fence = fences[segment];
+    if(fence)
+    {
+        // Only blocks when the CPU is more than segmentCount frames ahead of the GPU.
+        while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+            ;
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    head    = segmentStart();
+    flushed = head;
+}
+
+UniformAllocation UniformRingBuffer::allocate(GLsizeiptr size)
+{
+    GLintptr offset = (head + alignment - 1) / alignment * alignment;
+
+    if(offset + size > segmentStart() + segmentSize)
+    {
+        std::cout << "ERROR::UNIFORM_RING_BUFFER::OUT_OF_SPACE " << size << " bytes requested, segment size is " << segmentSize << std::endl;
+        UniformAllocation none = { 0, 0, nullptr };
+        return none;
+    }
+
+    head = offset + size;
+
+    UniformAllocation allocation = { offset, size, mapped + offset };
+    return allocation;
+}
+
+// Coherent mappings need no flush; the fallback uploads everything written since the last flush at once.
+void UniformRingBuffer::flush()
+{
+    if(persistent || head == flushed)
+        return;
+
+    bindUniformBuffer(buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, flushed, head - flushed, mapped + flushed);
+
+    flushed = head;
+}
+
+void UniformRingBuffer::endFrame()
+{
+    flush();
+
+    if(persistent)
+        fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    segment = (segment + 1) % fences.size();
+}
+
+// ------------------------------------------------------------------------
+void UniformRingBuffer::bind(GLuint binding, const UniformAllocation &allocation) const
+{
+    if(GLStateCache* state = GLStateCache::current())
+        state->bindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, allocation.offset, allocation.size);
+    else
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, allocation.offset, allocation.size);
+}
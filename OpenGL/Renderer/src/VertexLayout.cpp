@@ -0,0 +1,105 @@
+#include "Renderer/VertexLayout.hpp"
+
+#include <cstdint>
+#include <iostream>
+
+VertexLayout::VertexLayout()
+    : vertexSize(0)
+{
+
+}
+
+VertexLayout& VertexLayout::add(GLuint location, VertexFormat format)
+{
+    switch(format)
+    {
+    case VertexFormat::Float1:       return add(location, 1, GL_FLOAT,          GL_FALSE, format);
+    case VertexFormat::Float2:       return add(location, 2, GL_FLOAT,          GL_FALSE, format);
+    case VertexFormat::Float3:       return add(location, 3, GL_FLOAT,          GL_FALSE, format);
+    case VertexFormat::Float4:       return add(location, 4, GL_FLOAT,          GL_FALSE, format);
+    case VertexFormat::Half2:        return add(location, 2, GL_HALF_FLOAT,     GL_FALSE, format);
+    case VertexFormat::Half4:        return add(location, 4, GL_HALF_FLOAT,     GL_FALSE, format);
+    case VertexFormat::Snorm16x2:    return add(location, 2, GL_SHORT,          GL_TRUE,  format);
+    case VertexFormat::Snorm16x4:    return add(location, 4, GL_SHORT,          GL_TRUE,  format);
+    case VertexFormat::Unorm16x2:    return add(location, 2, GL_UNSIGNED_SHORT, GL_TRUE,  format);
+    case VertexFormat::Unorm16x4:    return add(location, 4, GL_UNSIGNED_SHORT, GL_TRUE,  format);
+    case VertexFormat::Octahedral16: return add(location, 2, GL_SHORT,          GL_TRUE,  format);
+    case VertexFormat::Snorm8x4:     return add(location, 4, GL_BYTE,           GL_TRUE,  format);
+    case VertexFormat::Unorm8x4:     return add(location, 4, GL_UNSIGNED_BYTE,  GL_TRUE,  format);
+    default:
+        std::cout << "ERROR::VERTEX_LAYOUT::UNKNOWN_FORMAT " << (int)format << std::endl;
+        return *this;
+    }
+}
+
+VertexLayout& VertexLayout::add(GLuint location, GLint components, GLenum type, GLboolean normalized)
+{
+    VertexFormat format = VertexFormat::Raw;
+    if(type == GL_FLOAT && components >= 1 && components <= 4)
+        format = (VertexFormat)((int)VertexFormat::Float1 + components - 1);
+    return add(location, components, type, normalized, format);
+}
+
+VertexLayout& VertexLayout::add(GLuint location, GLint components, GLenum type, GLboolean normalized, VertexFormat format)
+{
+    VertexAttribute attribute = { location, components, type, normalized, (GLuint)vertexSize, format };
+    attributeList.push_back(attribute);
+
+    // Keep every attribute 4 byte aligned, some drivers fall off the fast path otherwise.
+    GLsizei size = components * vertexTypeSize(type);
+    vertexSize += (size + 3) & ~3;
+    return *this;
+}
+
+const VertexAttribute* VertexLayout::find(GLuint location) const
+{
+    for(std::size_t i = 0; i < attributeList.size(); ++i)
+        if(attributeList[i].location == location)
+            return &attributeList[i];
+    return nullptr;
+}
+
+void VertexLayout::apply() const
+{
+    for(std::size_t i = 0; i < attributeList.size(); ++i)
+    {
+        const VertexAttribute &attribute = attributeList[i];
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized, vertexSize, (const void*)(std::uintptr_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+bool VertexLayout::operator==(const VertexLayout &other) const
+{
+    if(vertexSize != other.vertexSize || attributeList.size() != other.attributeList.size())
+        return false;
+
+    for(std::size_t i = 0; i < attributeList.size(); ++i)
+    {
+        const VertexAttribute &a = attributeList[i];
+        const VertexAttribute &b = other.attributeList[i];
+        if(a.location != b.location || a.components != b.components || a.type != b.type || a.normalized != b.normalized || a.offset != b.offset || a.format != b.format)
+            return false;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+GLsizei vertexTypeSize(GLenum type)
+{
+    switch(type)
+    {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        return 2;
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+        return 1;  // Four components share one 32-bit word.
+    default:
+        return 4;
+    }
+}
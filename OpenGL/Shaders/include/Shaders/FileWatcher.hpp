@@ -0,0 +1,52 @@
+#ifndef __FILE_WATCHER_HPP_INCLUDED__
+#define __FILE_WATCHER_HPP_INCLUDED__
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Absolute path with "." / ".." / symlinks resolved, so the same file always compares equal.
+std::string canonicalPath(const std::string &path);
+
+// Watches files from a background thread (inotify on Linux, modification times elsewhere)
+// and collects the ones that changed until the render thread asks for them.
+// --------------------------------------------------------------------------------------
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void add(const std::string &path);
+
+    // Canonical paths of the files changed since the last call.
+    std::vector<std::string> changes();
+
+private:
+    void run();
+    void notify(const std::string &path);
+
+private:
+    std::thread       thread;
+    std::atomic<bool> running;
+
+    std::mutex            mutex;
+    std::set<std::string> files;
+    std::set<std::string> changed;
+
+#ifdef __linux__
+    int                        inotify;
+    std::map<int, std::string> directories;
+#else
+    std::map<std::string, long long> modified;
+#endif
+};
+
+#endif // !__FILE_WATCHER_HPP_INCLUDED__
@@ -0,0 +1,52 @@
+#ifndef __PROGRAM_BINARY_CACHE_HPP_INCLUDED__
+#define __PROGRAM_BINARY_CACHE_HPP_INCLUDED__
+
+#include <GLAD/glad.h>
+
+#include "Shaders/ShaderSource.hpp"
+
+#include <cstdint>
+#include <string>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Keys hash the stage sources together with the GL vendor, renderer and version strings,
+// so a driver update or a different GPU simply misses instead of loading a stale binary.
+// -------------------------------------------------------------------------------------
+class ProgramBinaryCache
+{
+public:
+    struct Stats
+    {
+        unsigned int hits;
+        unsigned int misses;
+        unsigned int rejected;  // Found on disk but truncated, corrupt or refused by the driver.
+        unsigned int stored;
+    };
+
+    // Needs a current context; disables itself if the driver exposes no binary formats.
+    explicit ProgramBinaryCache(const std::string &directory);
+
+    bool isEnabled() const { return enabled; }
+
+    // Hashes the stage set and every source chunk in place, without concatenating the text.
+    std::uint64_t key(const ShaderSource &source) const;
+
+    // Loads the binary for key into program. Returns true only if the program linked.
+    bool load(std::uint64_t key, GLuint program);
+    // Call before glLinkProgram on programs that will be stored.
+    void prepare(GLuint program) const;
+    void store(std::uint64_t key, GLuint program);
+
+    const Stats& stats() const { return cacheStats; }
+
+private:
+    std::string path(std::uint64_t key) const;
+
+private:
+    std::string directory;
+    std::string driver;
+    bool        enabled;
+    Stats       cacheStats;
+};
+
+#endif // !__PROGRAM_BINARY_CACHE_HPP_INCLUDED__
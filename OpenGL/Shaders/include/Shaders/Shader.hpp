@@ -4,17 +4,43 @@
 #include <GLAD/glad.h>
 #include <glm/glm.hpp>
 
-#include <iostream>
-#include <fstream>
+#include "Shaders/ProgramBinaryCache.hpp"
+#include "Shaders/ShaderSource.hpp"
+#include "Shaders/UniformTable.hpp"
 
-#include <sstream>
+#include <iostream>
 #include <string>
+#include <vector>
+
+class ShaderBatch;
 
 class Shader
 {
+	friend class ShaderBatch;
+	friend class ShaderRegistry;
+
 public:
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    // With a binaryCache the linked program is loaded from / stored to disk instead of recompiled.
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, ProgramBinaryCache* binaryCache = nullptr);
+    // Single file with "#shader vertex" / "#shader fragment" / ... sections, like res/shaders/basic.shader.
+    // Pass a sourceCache shared between shaders so common #include files are mapped only once.
+    explicit Shader(const char* shaderPath, ProgramBinaryCache* binaryCache = nullptr, ShaderSourceCache* sourceCache = nullptr);
+    // Deletes the program: the context must still be current.
     ~Shader();
+
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+	// False while the driver is still compiling / linking in the background (GL_KHR_parallel_shader_compile).
+	// Without the extension this is always true: the first use simply waits for the driver.
+	bool isReady() const;
+	// Resolves compile / link status; blocks if the program is not ready yet.
+	bool isValid() const;
+
+	unsigned int getID() const { return ID; }
+	// Every file the program was built from, includes too.
+	const std::vector<std::string>& getFiles() const { return source.files(); }
+
 	// Private methods
 
 	void use	  (); 
@@ -33,28 +59,63 @@ public:
     void setMat3  (const std::string &name, const glm::mat3 &mat) const;
     void setMat4  (const std::string &name, const glm::mat4 &mat) const;
 
+	// Handle based API: resolve the name once, then set without any string lookup.
+	UniformHandle getUniform(const std::string &name) const;
+
+	void setBool  (UniformHandle handle, bool  value) const;
+    void setInt   (UniformHandle handle, int   value) const;
+    void setFloat (UniformHandle handle, float value) const;
+
+	void setVec2  (UniformHandle handle, const glm::vec2 &value) const;
+    void setVec2  (UniformHandle handle, float x, float y) const;
+    void setVec3  (UniformHandle handle, const glm::vec3 &value) const;
+    void setVec3  (UniformHandle handle, float x, float y, float z) const;
+    void setVec4  (UniformHandle handle, const glm::vec4 &value) const;
+    void setVec4  (UniformHandle handle, float x, float y, float z, float w) const;
+
+	void setMat2  (UniformHandle handle, const glm::mat2 &mat) const;
+    void setMat3  (UniformHandle handle, const glm::mat3 &mat) const;
+    void setMat4  (UniformHandle handle, const glm::mat4 &mat) const;
+
+	// Points the named std140 block at a uniform buffer binding (see Renderer/UniformBlocks.hpp).
+	void bindUniformBlock(const std::string &name, GLuint binding) const;
+
+	// Uploads issued vs. skipped because the program already held the value.
+	const UniformStats& uniformStats() const { return uniforms.stats(); }
+	void resetUniformStats() { uniforms.resetStats(); }
+
 private:
-	void checkCompileErrors(GLuint shader, std::string type);
+	// Used by ShaderBatch: only sets up state, the build is started with compile() and link().
+	explicit Shader(ProgramBinaryCache* binaryCache);
+
+	bool readSources(const char* vertexPath, const char* fragmentPath, const char* geometryPath, ShaderSourceCache &cache);
+	bool readSources(const char* shaderPath, ShaderSourceCache &cache);
+	void compile();
+	void link();
+	// Status queries are deferred until here, the first time the program is actually needed.
+	void finish() const;
+
+	GLint location(UniformHandle handle) const { return handle.isValid() ? uniforms[handle].location : -1; }
+
+	void checkCompileErrors(GLuint shader, std::string type) const;
 	// Private properties
 private:
 	unsigned int ID;
 
-	std::string vertexCode;
-	std::string	fragmentCode;
-	std::string	geometryCode;
-	
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
-	std::ifstream gShaderFile;
+	// Mutable: the setters are logically const, the shadow copy is a cache of program state.
+	mutable UniformTable uniforms;
 
-	std::stringstream vShaderStream, fShaderStream, gShaderStream;
-	
-	const char* vShaderCode;
-	const char* fShaderCode;
+	// Chunks point into memory mapped files and are released as soon as GL has compiled them.
+	ShaderSource source;
+	mutable std::vector<GLuint> stages;
 
-	unsigned int vertex, fragment;
+	ProgramBinaryCache* binaryCache;
+	std::uint64_t       binaryKey;
+	bool                loadedFromBinary;
 
-	unsigned int geometry;
+	// Resolved lazily on first use.
+	mutable bool finished;
+	mutable bool linked;
 };
 
 #endif // !__SHADER_HPP_INCLUDED__
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef __SHADER_BATCH_HPP_INCLUDED__
+#define __SHADER_BATCH_HPP_INCLUDED__
+
+#include <GLAD/glad.h>
+
+#include "Shaders/Shader.hpp"
+
+#include <memory>
+#include <vector>
+
+// GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile; our GLAD is generated without extensions.
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+    #define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+    #define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// Call once after gladLoadGLLoader with the same loader. Returns whether the extension is available.
+bool loadParallelShaderCompile(GLADloadproc load);
+bool hasParallelShaderCompile();
+
+// Builds many programs at once: every compile and link is submitted up front, and no status is
+// queried until a program is first used, so the driver can overlap the work across programs.
+// --------------------------------------------------------------------------------------------
+class ShaderBatch
+{
+public:
+    explicit ShaderBatch(ProgramBinaryCache* binaryCache = nullptr);
+
+    ShaderBatch(const ShaderBatch&) = delete;
+    ShaderBatch& operator=(const ShaderBatch&) = delete;
+
+    // Reads the sources and starts compiling. The shader stays owned by the batch.
+    Shader* add(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    // Same for a combined "#shader" file.
+    Shader* add(const char* shaderPath);
+    // Links everything added since the last submit.
+    void submit();
+
+    std::size_t size() const { return shaders.size(); }
+    std::size_t readyCount() const;
+    bool isReady() const { return readyCount() == shaders.size(); }
+
+    // Blocks until every program is resolved. Returns false if any failed to build.
+    bool finish();
+
+private:
+    Shader* start(std::unique_ptr<Shader> shader);
+
+private:
+    ProgramBinaryCache*                  binaryCache;
+    // Shared by the whole batch so common #include files are mapped once.
+    ShaderSourceCache                    sourceCache;
+    std::vector<std::unique_ptr<Shader>> shaders;
+    std::size_t                          submitted;
+};
+
+#endif // !__SHADER_BATCH_HPP_INCLUDED__
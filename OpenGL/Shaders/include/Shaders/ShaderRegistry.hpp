@@ -0,0 +1,67 @@
+#ifndef __SHADER_REGISTRY_HPP_INCLUDED__
+#define __SHADER_REGISTRY_HPP_INCLUDED__
+
+#include "Shaders/FileWatcher.hpp"
+#include "Shaders/Shader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Owns shaders and rebuilds them when their files (includes too) change on disk.
+// File watching runs on a background thread; the rebuild itself is submitted with the
+// non-blocking compile path so the render thread never waits on the driver, and the new
+// program only replaces the old one in update() once it linked. A broken edit keeps the
+// previous program running.
+// -----------------------------------------------------------------------------------
+class ShaderRegistry
+{
+public:
+    typedef std::size_t Handle;
+
+    explicit ShaderRegistry(ProgramBinaryCache* binaryCache = nullptr);
+
+    ShaderRegistry(const ShaderRegistry&) = delete;
+    ShaderRegistry& operator=(const ShaderRegistry&) = delete;
+
+    Handle load(const std::string &shaderPath);
+    Handle load(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath = std::string());
+
+    // Valid until the next update(); fetch it again every frame.
+    Shader& get(Handle handle) { return *entries[handle].current; }
+    // Bumped on every swap, uniform handles resolved against an older generation are stale.
+    unsigned int generation(Handle handle) const { return entries[handle].generation; }
+
+    // Call at a frame boundary, before any program is used.
+    void update();
+
+    // Deletes every program while the context is still current; handles are invalid afterwards.
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry
+    {
+        std::string shaderPath;
+        std::string vertexPath;
+        std::string fragmentPath;
+        std::string geometryPath;
+
+        std::vector<std::string> files;  // As read, for invalidating the source cache.
+        std::vector<std::string> watched;  // Canonical, to match watcher events.
+
+        std::unique_ptr<Shader> current;
+        std::unique_ptr<Shader> pending;
+        unsigned int            generation;
+    };
+
+    std::unique_ptr<Shader> build(const Entry &entry);
+    void track(Entry &entry, const Shader &shader);
+
+private:
+    ProgramBinaryCache* binaryCache;
+    ShaderSourceCache   sourceCache;
+    FileWatcher         watcher;
+    std::vector<Entry>  entries;
+};
+
+#endif // !__SHADER_REGISTRY_HPP_INCLUDED__
@@ -0,0 +1,75 @@
+#ifndef __SHADER_SOURCE_HPP_INCLUDED__
+#define __SHADER_SOURCE_HPP_INCLUDED__
+
+#include <GLAD/glad.h>
+
+#include "Renderer/MappedFile.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Every file read while loading shaders, mapped once and shared by all shaders that include it.
+// --------------------------------------------------------------------------------------------
+class ShaderSourceCache
+{
+public:
+    std::shared_ptr<MappedFile> get(const std::string &path);
+
+    // Drop files whose contents changed on disk so the next get() maps them again.
+    void invalidate(const std::string &path) { files.erase(path); }
+    void clear() { files.clear(); }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<MappedFile>> files;
+};
+
+// One stage as pointer / length pairs into the mapped files, ready for glShaderSource.
+struct ShaderStage
+{
+    GLenum                     type;
+    std::vector<const GLchar*> strings;
+    std::vector<GLint>         lengths;
+};
+
+// The GLSL for all stages of a program, without copying any text.
+// A combined file is split on "#shader <stage>" lines; "#include \"file\"" lines are replaced
+// by the chunks of the named file (resolved next to the including file, included once per stage).
+// ----------------------------------------------------------------------------------------------
+class ShaderSource
+{
+public:
+    // One file holding every stage, e.g. res/shaders/basic.shader.
+    bool loadCombined(const std::string &path, ShaderSourceCache &cache);
+    // One file per stage, e.g. 3.3.shader.vs.
+    bool addStage(GLenum type, const std::string &path, ShaderSourceCache &cache);
+
+    const std::vector<ShaderStage>& stages() const { return stageList; }
+    // Every file that contributed, includes too.
+    const std::vector<std::string>& files() const { return paths; }
+
+    // Drops the mappings and chunk pointers once GL has its own copy of the text; files() stays valid.
+    void release();
+
+private:
+    struct View
+    {
+        const char* data;
+        std::size_t length;
+    };
+
+    std::shared_ptr<MappedFile> map(const std::string &path, ShaderSourceCache &cache);
+    bool append(ShaderStage &stage, View text, const std::string &directory, ShaderSourceCache &cache,
+                std::vector<const MappedFile*> &included, int depth);
+
+private:
+    std::vector<ShaderStage>                 stageList;
+    std::vector<std::shared_ptr<MappedFile>> mappings;
+    std::vector<std::string>                 paths;
+};
+
+const char* shaderStageName(GLenum type);
+
+#endif // !__SHADER_SOURCE_HPP_INCLUDED__
@@ -0,0 +1,89 @@
+#ifndef __UNIFORM_TABLE_HPP_INCLUDED__
+#define __UNIFORM_TABLE_HPP_INCLUDED__
+
+#include <GLAD/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// FNV-1a hash of a uniform name. Usable at compile time so callers can precompute keys.
+// ------------------------------------------------------------------------------------
+constexpr std::uint32_t hashUniformName(const char* name, std::uint32_t hash = 2166136261u)
+{
+    return *name ? hashUniformName(name + 1, (hash ^ static_cast<std::uint8_t>(*name)) * 16777619u) : hash;
+}
+
+// Resolved once with Shader::getUniform(), then passed to the set* overloads as often as needed.
+// ---------------------------------------------------------------------------------------------
+struct UniformHandle
+{
+    int index;
+
+    UniformHandle() : index(-1) {}
+    explicit UniformHandle(int index) : index(index) {}
+
+    bool isValid() const { return index >= 0; }
+};
+
+struct UniformInfo
+{
+    std::string   name;
+    std::uint32_t hash;
+    GLint         location;
+    GLenum        type;
+    GLint         count;
+
+    // Byte range of this uniform (and the array elements after it) inside the shadow block.
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct UniformStats
+{
+    std::uint64_t uploadsIssued;
+    std::uint64_t uploadsSkipped;
+};
+
+// Every active default-block uniform of a linked program, reflected once after link.
+// Array uniforms get one entry per element ("lights[2]") plus one for the bare name.
+// The table also keeps a contiguous CPU-side shadow of every uniform's current value,
+// seeded from the program after link, so redundant glUniform* calls can be skipped.
+// ---------------------------------------------------------------------------------
+class UniformTable
+{
+public:
+    UniformTable();
+
+    void build(GLuint program);
+    void clear();
+
+    UniformHandle find(const std::string &name) const;
+    UniformHandle find(const char* name, std::uint32_t hash) const;
+
+    const UniformInfo& operator[](UniformHandle handle) const { return uniforms[handle.index]; }
+    std::size_t size() const { return uniforms.size(); }
+
+    // Copies value into the shadow and returns true if the program needs the upload.
+    bool update(UniformHandle handle, const void* value, std::size_t size);
+
+    const UniformStats& stats() const { return uploadStats; }
+    void resetStats();
+
+private:
+    void add(const std::string &name, GLint location, GLenum type, GLint count, std::uint32_t offset, std::uint32_t size);
+    void readBack(GLuint program, const UniformInfo &info);
+    void rehash();
+
+private:
+    std::vector<UniformInfo> uniforms;
+
+    // Open addressing, linear probing; each slot holds an index into uniforms or -1.
+    std::vector<int> slots;
+    std::uint32_t    mask;
+
+    std::vector<unsigned char> shadow;
+    UniformStats               uploadStats;
+};
+
+#endif // !__UNIFORM_TABLE_HPP_INCLUDED__
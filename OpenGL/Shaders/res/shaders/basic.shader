@@ -1,14 +1,18 @@
 #shader vertex
 #version 330 core
+#include "draw.glsl"
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
 
 out vec3 ourColor;
+flat out vec4 drawColor;
 
 void main()
 {
-    gl_Position = vec4(aPos, 1.0);
+    DrawData draw = currentDraw();
+    gl_Position = draw.model * vec4(aPos, 1.0);
     ourColor = aColor;
+    drawColor = draw.color;
 }
 
 #shader fragment
@@ -16,8 +20,9 @@ void main()
 out vec4 FragColor;
 
 in vec3 ourColor;
+flat in vec4 drawColor;
 
 void main()
 {
-    FragColor = vec4(ourColor, 1.0f);
+    FragColor = vec4(ourColor, 1.0f) * drawColor;
 }
\ No newline at end of file
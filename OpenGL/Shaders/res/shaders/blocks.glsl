@@ -0,0 +1,23 @@
+// std140 blocks shared with Renderer/UniformBlocks.hpp, keep both in sync.
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 position;
+} camera;
+
+// Per-draw data (DrawBlock): DrawQueue gathers the blocks of its packets into arrays of
+// DRAW_BLOCK_CAPACITY elements in draw order, see draw.glsl for finding this draw's element.
+struct DrawData
+{
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 color;
+    vec4 parameters;
+};
+
+layout (std140) uniform Draws
+{
+    DrawData draws[100];
+};
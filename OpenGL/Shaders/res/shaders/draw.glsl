@@ -0,0 +1,17 @@
+// Vertex shaders only, and included first: #extension has to come before any declaration.
+#extension GL_ARB_shader_draw_parameters : enable
+#include "blocks.glsl"
+
+// Set by DrawQueue before every draw; its array is never enabled, so it is the same for all vertices.
+layout (location = 15) in uint drawIndex;
+
+// The element of 'draws' this draw reads. Multi draws set drawIndex to their first element and
+// add gl_DrawIDARB; DrawQueue only multi draws when the extension is there.
+DrawData currentDraw()
+{
+#ifdef GL_ARB_shader_draw_parameters
+    return draws[drawIndex + uint(gl_DrawIDARB)];
+#else
+    return draws[drawIndex];
+#endif
+}
@@ -0,0 +1,31 @@
+#shader vertex
+#version 330 core
+#include "draw.glsl"
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+// Per instance, see Renderer/InstanceBatcher.hpp.
+layout (location = 8) in mat4 instanceModel;
+layout (location = 12) in vec4 instanceColor;
+
+out vec3 ourColor;
+flat out vec4 drawColor;
+
+void main()
+{
+    DrawData draw = currentDraw();
+    gl_Position = draw.model * instanceModel * vec4(aPos, 1.0);
+    ourColor = aColor * instanceColor.rgb;
+    drawColor = draw.color;
+}
+
+#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+flat in vec4 drawColor;
+
+void main()
+{
+    FragColor = vec4(ourColor, 1.0f) * drawColor;
+}
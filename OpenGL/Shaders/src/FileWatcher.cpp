@@ -0,0 +1,152 @@
+#include "Shaders/FileWatcher.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    const int POLL_INTERVAL_MS = 100;
+
+    std::string directoryOf(const std::string &path)
+    {
+        std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+    }
+
+#ifndef __linux__
+    long long modificationTime(const std::string &path)
+    {
+        struct stat status;
+        return stat(path.c_str(), &status) == 0 ? (long long)status.st_mtime : -1;
+    }
+#endif
+}
+
+std::string canonicalPath(const std::string &path)
+{
+#ifdef _WIN32
+    char resolved[_MAX_PATH];
+    return _fullpath(resolved, path.c_str(), _MAX_PATH) ? std::string(resolved) : path;
+#else
+    char resolved[PATH_MAX];
+    return realpath(path.c_str(), resolved) ? std::string(resolved) : path;
+#endif
+}
+
+// ------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+    : running(true)
+{
+#ifdef __linux__
+    inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+    thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    running = false;
+    thread.join();
+
+#ifdef __linux__
+    if(inotify >= 0)
+        close(inotify);
+#endif
+}
+
+void FileWatcher::add(const std::string &path)
+{
+    std::string file = canonicalPath(path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(!files.insert(file).second)
+        return;
+
+#ifdef __linux__
+    // Watch the directory, not the file: most editors save by writing a new file and renaming it over the old one.
+    // Not IN_CREATE: a new file is still empty then, and only complete once it is closed or renamed into place.
+    std::string directory = directoryOf(file);
+    if(inotify >= 0)
+    {
+        int descriptor = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if(descriptor >= 0)
+            directories[descriptor] = directory;
+    }
+#else
+    modified[file] = modificationTime(file);
+#endif
+}
+
+std::vector<std::string> FileWatcher::changes()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> result(changed.begin(), changed.end());
+    changed.clear();
+    return result;
+}
+
+// ------------------------------------------------------------------------
+void FileWatcher::run()
+{
+    while(running)
+    {
+#ifdef __linux__
+        pollfd descriptor = { inotify, POLLIN, 0 };
+        if(inotify < 0 || poll(&descriptor, 1, POLL_INTERVAL_MS) <= 0)
+        {
+            if(inotify < 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+            continue;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while((length = read(inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for(char* position = buffer; position < buffer + length; )
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(position);
+                position += sizeof(inotify_event) + event->len;
+
+                if(event->len == 0)
+                    continue;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                std::map<int, std::string>::const_iterator directory = directories.find(event->wd);
+                if(directory != directories.end())
+                    notify(directory->second + "/" + event->name);
+            }
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for(std::map<std::string, long long>::iterator file = modified.begin(); file != modified.end(); ++file)
+        {
+            long long time = modificationTime(file->first);
+            if(time != file->second)
+            {
+                file->second = time;
+                notify(file->first);
+            }
+        }
+#endif
+    }
+}
+
+// Called with the mutex held.
+void FileWatcher::notify(const std::string &path)
+{
+    if(files.count(path) != 0)
+        changed.insert(path);
+}
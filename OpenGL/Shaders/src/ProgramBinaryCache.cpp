@@ -0,0 +1,187 @@
+#include "Shaders/ProgramBinaryCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #define makeDirectory(path) _mkdir(path)
+#else
+    #include <sys/stat.h>
+    #define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+namespace
+{
+    const std::uint32_t CACHE_MAGIC = 0x42505347; // "GSPB"
+
+    struct CacheHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t format;
+        std::uint32_t length;
+    };
+
+    std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t hash)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(std::size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    std::string glString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string &directory)
+    : directory(directory), enabled(false)
+{
+    cacheStats.hits     = 0;
+    cacheStats.misses   = 0;
+    cacheStats.rejected = 0;
+    cacheStats.stored   = 0;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    enabled = formats > 0;
+
+    if(!enabled)
+    {
+        std::cout << "WARNING::PROGRAM_BINARY_CACHE::NO_BINARY_FORMATS" << std::endl;
+        return;
+    }
+
+    // The NUL separators keep "ab"+"c" and "a"+"bc" from hashing the same.
+    driver  = glString(GL_VENDOR);   driver += '\0';
+    driver += glString(GL_RENDERER); driver += '\0';
+    driver += glString(GL_VERSION);  driver += '\0';
+
+    makeDirectory(directory.c_str());
+}
+
+// ------------------------------------------------------------------------
+std::uint64_t ProgramBinaryCache::key(const ShaderSource &source) const
+{
+    std::uint64_t hash = hashBytes(driver.data(), driver.size(), 14695981039346656037ull);
+
+    const std::vector<ShaderStage> &stages = source.stages();
+    for(std::size_t i = 0; i < stages.size(); ++i)
+    {
+        std::uint32_t type   = stages[i].type;
+        std::uint32_t chunks = (std::uint32_t)stages[i].strings.size();
+        hash = hashBytes(&type, sizeof(type), hash);
+        hash = hashBytes(&chunks, sizeof(chunks), hash);
+
+        for(std::size_t chunk = 0; chunk < stages[i].strings.size(); ++chunk)
+        {
+            std::uint32_t length = (std::uint32_t)stages[i].lengths[chunk];
+            hash = hashBytes(&length, sizeof(length), hash);
+            hash = hashBytes(stages[i].strings[chunk], length, hash);
+        }
+    }
+
+    return hash;
+}
+
+// ------------------------------------------------------------------------
+bool ProgramBinaryCache::load(std::uint64_t key, GLuint program)
+{
+    if(!enabled)
+        return false;
+
+    std::ifstream file(path(key).c_str(), std::ios::binary | std::ios::ate);
+    const std::streamoff fileSize = file ? (std::streamoff)file.tellg() : 0;
+    file.seekg(0);
+    CacheHeader header;
+
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CACHE_MAGIC)
+    {
+        ++cacheStats.misses;
+        return false;
+    }
+
+    // The length is only trusted once the file is known to hold exactly that much, truncated or corrupt entries
+    // would otherwise size the allocation.
+    if((std::streamoff)header.length != fileSize - (std::streamoff)sizeof(header))
+    {
+        ++cacheStats.rejected;
+        return false;
+    }
+
+    std::vector<char> binary(header.length);
+    if(!file.read(binary.data(), binary.size()))
+    {
+        ++cacheStats.misses;
+        return false;
+    }
+
+    glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+    // Drivers are allowed to reject any binary, e.g. after an update that kept the version string.
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if(!success)
+    {
+        ++cacheStats.rejected;
+        return false;
+    }
+
+    ++cacheStats.hits;
+    return true;
+}
+
+void ProgramBinaryCache::prepare(GLuint program) const
+{
+    if(enabled)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramBinaryCache::store(std::uint64_t key, GLuint program)
+{
+    if(!enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+    CacheHeader header;
+    header.magic  = CACHE_MAGIC;
+    header.format = format;
+    header.length = (std::uint32_t)length;
+
+    // Write to a temporary file first so a crash never leaves a truncated entry behind.
+    std::string target    = path(key);
+    std::string temporary = target + ".tmp";
+    {
+        std::ofstream file(temporary.c_str(), std::ios::binary | std::ios::trunc);
+        if(!file.write(reinterpret_cast<const char*>(&header), sizeof(header)) || !file.write(binary.data(), binary.size()))
+        {
+            std::cout << "ERROR::PROGRAM_BINARY_CACHE::WRITE_FAILED " << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::remove(target.c_str());
+    if(std::rename(temporary.c_str(), target.c_str()) == 0)
+        ++cacheStats.stored;
+}
+
+// ------------------------------------------------------------------------
+std::string ProgramBinaryCache::path(std::uint64_t key) const
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return directory + "/" + name + ".bin";
+}
@@ -1,89 +1,168 @@
 #include "Shaders/Shader.hpp"
+#include "Shaders/ShaderBatch.hpp"
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+#include "Renderer/GLStateCache.hpp"
+
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, ProgramBinaryCache* binaryCache)
+    : Shader(binaryCache)
+{
+    ShaderSourceCache sourceCache;
+    readSources(vertexPath, fragmentPath, geometryPath, sourceCache);
+    compile();
+    link();
+    finish();
+}
+
+Shader::Shader(const char* shaderPath, ProgramBinaryCache* binaryCache, ShaderSourceCache* sourceCache)
+    : Shader(binaryCache)
+{
+    ShaderSourceCache localCache;
+    readSources(shaderPath, sourceCache != nullptr ? *sourceCache : localCache);
+    compile();
+    link();
+    finish();
+}
+
+Shader::Shader(ProgramBinaryCache* binaryCache)
+    : ID(0), binaryCache(binaryCache), binaryKey(0), loadedFromBinary(false), finished(false), linked(false)
 {
-    vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
 
-    try {
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
+}
+
+bool Shader::readSources(const char* vertexPath, const char* fragmentPath, const char* geometryPath, ShaderSourceCache &cache)
+{
+    bool read = source.addStage(GL_VERTEX_SHADER, vertexPath, cache) && source.addStage(GL_FRAGMENT_SHADER, fragmentPath, cache);
+    
+    if(read && geometryPath != nullptr)
+        read = source.addStage(GL_GEOMETRY_SHADER, geometryPath, cache);
+
+    return read;
+}
+
+bool Shader::readSources(const char* shaderPath, ShaderSourceCache &cache)
+{
+    return source.loadCombined(shaderPath, cache);
+}
 
-        vShaderFile.close();
-        fShaderFile.close();
+// Issue the stage compiles without asking for their status.
+// ------------------------------------------------------------------------
+void Shader::compile()
+{
+    ID = glCreateProgram();
 
-        vertexCode   = vShaderStream.str();
-        fragmentCode = fShaderStream.str();	
+    if(binaryCache != nullptr)
+    {
+        binaryKey = binaryCache->key(source);
 
-        if(geometryPath != nullptr)
+        loadedFromBinary = binaryCache->load(binaryKey, ID);
+        if(loadedFromBinary)
         {
-            gShaderFile.open(geometryPath);
-            
-            gShaderStream << gShaderFile.rdbuf();
-            
-            gShaderFile.close();
-            
-            geometryCode = gShaderStream.str();
+            source.release();
+            return;
         }
-
-    } catch (std::ifstream::failure e) {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
     }
-
-    vShaderCode = vertexCode.c_str();
-    fShaderCode = fragmentCode.c_str();
-    
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
     
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    
-    // if geometry shader is given, compile geometry shader
-    if(geometryPath != nullptr)
+    // Each stage is handed to GL as the pointer / length chunks of the mapped files.
+    const std::vector<ShaderStage> &sourceStages = source.stages();
+    for(std::size_t i = 0; i < sourceStages.size(); ++i)
     {
-        const char * gShaderCode = geometryCode.c_str();
-        geometry = glCreateShader(GL_GEOMETRY_SHADER);
-        glShaderSource(geometry, 1, &gShaderCode, NULL);
-        glCompileShader(geometry);
-        checkCompileErrors(geometry, "GEOMETRY");
+        GLuint stage = glCreateShader(sourceStages[i].type);
+        glShaderSource(stage, (GLsizei)sourceStages[i].strings.size(), sourceStages[i].strings.data(), sourceStages[i].lengths.data());
+        glCompileShader(stage);
+        stages.push_back(stage);
     }
 
-    // shader Program
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    
-    if(geometryPath != nullptr)
-        glAttachShader(ID, geometry);
-        glLinkProgram(ID);
-    
-    checkCompileErrors(ID, "PROGRAM");
-    // delete the shaders as they're linked into our program now and no longer necessery
-    
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    if(geometryPath != nullptr)
-        glDeleteShader(geometry);
+    // glShaderSource copied the text, the mappings are no longer needed.
+    source.release();
+}
+
+// Issue the link; the driver waits for the stage compiles on its own.
+// ------------------------------------------------------------------------
+void Shader::link()
+{
+    if(loadedFromBinary)
+        return;
+
+    for(std::size_t i = 0; i < stages.size(); ++i)
+        glAttachShader(ID, stages[i]);
+
+    if(binaryCache != nullptr)
+        binaryCache->prepare(ID);
+
+    glLinkProgram(ID);
+}
+
+// ------------------------------------------------------------------------
+bool Shader::isReady() const
+{
+    if(finished || loadedFromBinary || !hasParallelShaderCompile())
+        return true;
 
+    GLint complete = GL_FALSE;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
 }
 
+bool Shader::isValid() const
+{
+    finish();
+    return linked;
+}
+
+void Shader::finish() const
+{
+    if(finished)
+        return;
+
+    finished = true;
+
+    if(loadedFromBinary)
+    {
+        linked = true;
+    }
+    else
+    {
+        for(std::size_t i = 0; i < stages.size(); ++i)
+        {
+            GLint type = GL_NONE;
+            glGetShaderiv(stages[i], GL_SHADER_TYPE, &type);
+            checkCompileErrors(stages[i], shaderStageName(type));
+        }
+        checkCompileErrors(ID, "PROGRAM");
+
+        // delete the shaders as they're linked into our program now and no longer necessery
+        for(std::size_t i = 0; i < stages.size(); ++i)
+            glDeleteShader(stages[i]);
+        stages.clear();
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(ID, GL_LINK_STATUS, &success);
+        linked = success == GL_TRUE;
+
+        if(binaryCache != nullptr && linked)
+            binaryCache->store(binaryKey, ID);
+    }
+
+    // Reflect all active uniforms once so the setters never ask the driver for a location.
+    uniforms.build(ID);
+}
+
+// Deletes the program, and the stages when it was never finished.
+// ------------------------------------------------------------------------
 Shader::~Shader()
 {
+    for(std::size_t i = 0; i < stages.size(); ++i)
+        glDeleteShader(stages[i]);
+
+    if(ID == 0)
+        return;
 
+    glDeleteProgram(ID);
+    if(GLStateCache* state = GLStateCache::current())
+        state->programDeleted(ID);
 }
 
-void Shader::checkCompileErrors(GLuint shader, std::string type)
+void Shader::checkCompileErrors(GLuint shader, std::string type) const
 {
     GLint success;
     GLchar infoLog[1024];
@@ -107,67 +186,152 @@ void Shader::checkCompileErrors(GLuint shader, std::string type)
     }
 }
 
-// activate the shader
+// activate the shader, skipped when it already is the current program
 // ------------------------------------------------------------------------
 void Shader::use() 
 { 
-    glUseProgram(ID); 
+    finish();
+    if(GLStateCache* state = GLStateCache::current())
+        state->useProgram(ID);
+    else
+        glUseProgram(ID); 
 }
 // utility uniform functions
 // ------------------------------------------------------------------------
+UniformHandle Shader::getUniform(const std::string &name) const
+{
+    finish();
+    return uniforms.find(name);
+}
+// ------------------------------------------------------------------------
+void Shader::bindUniformBlock(const std::string &name, GLuint binding) const
+{
+    finish();
+
+    GLuint index = glGetUniformBlockIndex(ID, name.c_str());
+    if(index != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, index, binding);
+}
+// ------------------------------------------------------------------------
 void Shader::setBool(const std::string &name, bool value) const
 {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    setBool(getUniform(name), value); 
 }
 // ------------------------------------------------------------------------
 void Shader::setInt(const std::string &name, int value) const
 { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    setInt(getUniform(name), value); 
 }
 // ------------------------------------------------------------------------
 void Shader::setFloat(const std::string &name, float value) const
 { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    setFloat(getUniform(name), value); 
 }
 // ------------------------------------------------------------------------
 void Shader::setVec2(const std::string &name, const glm::vec2 &value) const
 { 
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    setVec2(getUniform(name), value); 
 }
 void Shader::setVec2(const std::string &name, float x, float y) const
 { 
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+    setVec2(getUniform(name), x, y); 
 }
 // ------------------------------------------------------------------------
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
 { 
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    setVec3(getUniform(name), value); 
 }
 void Shader::setVec3(const std::string &name, float x, float y, float z) const
 { 
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    setVec3(getUniform(name), x, y, z); 
 }
 // ------------------------------------------------------------------------
 void Shader::setVec4(const std::string &name, const glm::vec4 &value) const
 { 
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    setVec4(getUniform(name), value); 
 }
 void Shader::setVec4(const std::string &name, float x, float y, float z, float w) 
 { 
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    setVec4(getUniform(name), x, y, z, w); 
 }
 // ------------------------------------------------------------------------
 void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat2(getUniform(name), mat);
 }
 // ------------------------------------------------------------------------
 void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat3(getUniform(name), mat);
 }
 // ------------------------------------------------------------------------
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat4(getUniform(name), mat);
+}
+// handle uniform functions, each one skips the upload when the shadow already holds the value
+// ------------------------------------------------------------------------
+void Shader::setBool(UniformHandle handle, bool value) const
+{
+    setInt(handle, (int)value);
+}
+// ------------------------------------------------------------------------
+void Shader::setInt(UniformHandle handle, int value) const
+{
+    if(uniforms.update(handle, &value, sizeof(value)))
+        glUniform1i(location(handle), value);
+}
+// ------------------------------------------------------------------------
+void Shader::setFloat(UniformHandle handle, float value) const
+{
+    if(uniforms.update(handle, &value, sizeof(value)))
+        glUniform1f(location(handle), value);
+}
+// ------------------------------------------------------------------------
+void Shader::setVec2(UniformHandle handle, const glm::vec2 &value) const
+{
+    if(uniforms.update(handle, &value[0], sizeof(value)))
+        glUniform2fv(location(handle), 1, &value[0]);
+}
+void Shader::setVec2(UniformHandle handle, float x, float y) const
+{
+    setVec2(handle, glm::vec2(x, y));
+}
+// ------------------------------------------------------------------------
+void Shader::setVec3(UniformHandle handle, const glm::vec3 &value) const
+{
+    if(uniforms.update(handle, &value[0], sizeof(value)))
+        glUniform3fv(location(handle), 1, &value[0]);
+}
+void Shader::setVec3(UniformHandle handle, float x, float y, float z) const
+{
+    setVec3(handle, glm::vec3(x, y, z));
+}
+// ------------------------------------------------------------------------
+void Shader::setVec4(UniformHandle handle, const glm::vec4 &value) const
+{
+    if(uniforms.update(handle, &value[0], sizeof(value)))
+        glUniform4fv(location(handle), 1, &value[0]);
+}
+void Shader::setVec4(UniformHandle handle, float x, float y, float z, float w) const
+{
+    setVec4(handle, glm::vec4(x, y, z, w));
+}
+// ------------------------------------------------------------------------
+void Shader::setMat2(UniformHandle handle, const glm::mat2 &mat) const
+{
+    if(uniforms.update(handle, &mat[0][0], sizeof(mat)))
+        glUniformMatrix2fv(location(handle), 1, GL_FALSE, &mat[0][0]);
+}
+// ------------------------------------------------------------------------
+void Shader::setMat3(UniformHandle handle, const glm::mat3 &mat) const
+{
+    if(uniforms.update(handle, &mat[0][0], sizeof(mat)))
+        glUniformMatrix3fv(location(handle), 1, GL_FALSE, &mat[0][0]);
+}
+// ------------------------------------------------------------------------
+void Shader::setMat4(UniformHandle handle, const glm::mat4 &mat) const
+{
+    if(uniforms.update(handle, &mat[0][0], sizeof(mat)))
+        glUniformMatrix4fv(location(handle), 1, GL_FALSE, &mat[0][0]);
 }
\ No newline at end of file
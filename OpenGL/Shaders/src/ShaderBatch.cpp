@@ -0,0 +1,96 @@
+#include "Shaders/ShaderBatch.hpp"
+
+#include <cstring>
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+static bool parallelShaderCompile = false;
+
+// ------------------------------------------------------------------------
+bool loadParallelShaderCompile(GLADloadproc load)
+{
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+
+    const char* function = nullptr;
+    for(GLint i = 0; i < extensions && function == nullptr; ++i)
+    {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+        if(std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsKHR";
+        else if(std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)
+            function = "glMaxShaderCompilerThreadsARB";
+    }
+
+    parallelShaderCompile = function != nullptr;
+
+    // 0xFFFFFFFF lets the implementation pick the number of compiler threads.
+    PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = parallelShaderCompile ? (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load(function) : nullptr;
+    if(maxShaderCompilerThreads != nullptr)
+        maxShaderCompilerThreads(0xFFFFFFFFu);
+
+    return parallelShaderCompile;
+}
+
+bool hasParallelShaderCompile()
+{
+    return parallelShaderCompile;
+}
+
+// ------------------------------------------------------------------------
+ShaderBatch::ShaderBatch(ProgramBinaryCache* binaryCache)
+    : binaryCache(binaryCache), submitted(0)
+{
+
+}
+
+Shader* ShaderBatch::add(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+{
+    std::unique_ptr<Shader> shader(new Shader(binaryCache));
+    shader->readSources(vertexPath, fragmentPath, geometryPath, sourceCache);
+    return start(std::move(shader));
+}
+
+Shader* ShaderBatch::add(const char* shaderPath)
+{
+    std::unique_ptr<Shader> shader(new Shader(binaryCache));
+    shader->readSources(shaderPath, sourceCache);
+    return start(std::move(shader));
+}
+
+Shader* ShaderBatch::start(std::unique_ptr<Shader> shader)
+{
+    shader->compile();
+
+    shaders.push_back(std::move(shader));
+    return shaders.back().get();
+}
+
+void ShaderBatch::submit()
+{
+    // All compiles were issued in add(), so the links below never wait on a single stage.
+    for(; submitted < shaders.size(); ++submitted)
+        shaders[submitted]->link();
+}
+
+// ------------------------------------------------------------------------
+std::size_t ShaderBatch::readyCount() const
+{
+    std::size_t ready = 0;
+    for(std::size_t i = 0; i < submitted; ++i)
+    {
+        if(shaders[i]->isReady())
+            ++ready;
+    }
+    return ready;
+}
+
+bool ShaderBatch::finish()
+{
+    submit();
+
+    bool valid = true;
+    for(std::size_t i = 0; i < shaders.size(); ++i)
+        valid = shaders[i]->isValid() && valid;
+    return valid;
+}
@@ -0,0 +1,123 @@
+#include "Shaders/ShaderRegistry.hpp"
+
+#include <algorithm>
+
+ShaderRegistry::ShaderRegistry(ProgramBinaryCache* binaryCache)
+    : binaryCache(binaryCache)
+{
+
+}
+
+// ------------------------------------------------------------------------
+ShaderRegistry::Handle ShaderRegistry::load(const std::string &shaderPath)
+{
+    Entry entry;
+    entry.shaderPath = shaderPath;
+    entry.generation = 0;
+    entry.current    = build(entry);
+    track(entry, *entry.current);
+
+    entries.push_back(std::move(entry));
+    return entries.size() - 1;
+}
+
+ShaderRegistry::Handle ShaderRegistry::load(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath)
+{
+    Entry entry;
+    entry.vertexPath   = vertexPath;
+    entry.fragmentPath = fragmentPath;
+    entry.geometryPath = geometryPath;
+    entry.generation   = 0;
+    entry.current      = build(entry);
+    track(entry, *entry.current);
+
+    entries.push_back(std::move(entry));
+    return entries.size() - 1;
+}
+
+// ------------------------------------------------------------------------
+void ShaderRegistry::update()
+{
+    // Start rebuilding every program that depends on a changed file.
+    std::vector<std::string> changes = watcher.changes();
+    if(!changes.empty())
+    {
+        std::vector<bool> dirty(entries.size(), false);
+
+        for(std::size_t change = 0; change < changes.size(); ++change)
+        {
+            for(std::size_t i = 0; i < entries.size(); ++i)
+            {
+                Entry &entry = entries[i];
+                std::vector<std::string>::const_iterator file = std::find(entry.watched.begin(), entry.watched.end(), changes[change]);
+                if(file == entry.watched.end())
+                    continue;
+
+                sourceCache.invalidate(entry.files[file - entry.watched.begin()]);
+                dirty[i] = true;
+            }
+        }
+
+        for(std::size_t i = 0; i < entries.size(); ++i)
+        {
+            if(!dirty[i])
+                continue;
+
+            // A newer edit supersedes a rebuild still in flight.
+            entries[i].pending.reset();
+            entries[i].pending = build(entries[i]);
+        }
+    }
+
+    // Swap in the rebuilds that are done; this is the only place a program changes.
+    for(std::size_t i = 0; i < entries.size(); ++i)
+    {
+        Entry &entry = entries[i];
+        if(!entry.pending || !entry.pending->isReady())
+            continue;
+
+        if(entry.pending->isValid())
+        {
+            entry.current.reset();
+            entry.current = std::move(entry.pending);
+            ++entry.generation;
+
+            // Includes may have been added or removed by the edit.
+            track(entry, *entry.current);
+            std::cout << "SHADER::RELOADED " << (entry.shaderPath.empty() ? entry.vertexPath : entry.shaderPath) << std::endl;
+        }
+        else
+        {
+            entry.pending.reset();
+            std::cout << "ERROR::SHADER::RELOAD_FAILED keeping the previous program for " << (entry.shaderPath.empty() ? entry.vertexPath : entry.shaderPath) << std::endl;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+std::unique_ptr<Shader> ShaderRegistry::build(const Entry &entry)
+{
+    std::unique_ptr<Shader> shader(new Shader(binaryCache));
+
+    if(!entry.shaderPath.empty())
+        shader->readSources(entry.shaderPath.c_str(), sourceCache);
+    else
+        shader->readSources(entry.vertexPath.c_str(), entry.fragmentPath.c_str(), entry.geometryPath.empty() ? nullptr : entry.geometryPath.c_str(), sourceCache);
+
+    shader->compile();
+    shader->link();
+    return shader;
+}
+
+void ShaderRegistry::track(Entry &entry, const Shader &shader)
+{
+    entry.files = shader.getFiles();
+    entry.watched.clear();
+
+    for(std::size_t i = 0; i < entry.files.size(); ++i)
+    {
+        entry.watched.push_back(canonicalPath(entry.files[i]));
+        watcher.add(entry.files[i]);
+    }
+}
+
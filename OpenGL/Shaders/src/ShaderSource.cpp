@@ -0,0 +1,261 @@
+#include "Shaders/ShaderSource.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const int MAX_INCLUDE_DEPTH = 16;
+
+    // GLSL is handed to glShaderSource straight from the mapping.
+    const char* textOf(const MappedFile &file)
+    {
+        return reinterpret_cast<const char*>(file.data());
+    }
+
+    bool startsWith(const char* line, const char* end, const char* token)
+    {
+        std::size_t length = std::strlen(token);
+        return (std::size_t)(end - line) >= length && std::memcmp(line, token, length) == 0;
+    }
+
+    const char* skipSpaces(const char* position, const char* end)
+    {
+        while(position < end && (*position == ' ' || *position == '\t'))
+            ++position;
+        return position;
+    }
+
+    GLenum stageType(const char* name, const char* end)
+    {
+        std::string stage(name, end);
+        if(stage == "vertex")                                       return GL_VERTEX_SHADER;
+        if(stage == "fragment" || stage == "pixel")                 return GL_FRAGMENT_SHADER;
+        if(stage == "geometry")                                     return GL_GEOMETRY_SHADER;
+        if(stage == "tess_control" || stage == "tesscontrol")       return GL_TESS_CONTROL_SHADER;
+        if(stage == "tess_evaluation" || stage == "tessevaluation") return GL_TESS_EVALUATION_SHADER;
+        if(stage == "compute")                                      return GL_COMPUTE_SHADER;
+        return GL_NONE;
+    }
+
+    std::string directoryOf(const std::string &path)
+    {
+        std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+}
+
+// ------------------------------------------------------------------------
+std::shared_ptr<MappedFile> ShaderSourceCache::get(const std::string &path)
+{
+    std::unordered_map<std::string, std::shared_ptr<MappedFile>>::iterator found = files.find(path);
+    if(found != files.end())
+        return found->second;
+
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    if(!file->open(path, true))
+        return std::shared_ptr<MappedFile>();
+
+    files[path] = file;
+    return file;
+}
+
+// ------------------------------------------------------------------------
+bool ShaderSource::loadCombined(const std::string &path, ShaderSourceCache &cache)
+{
+    std::shared_ptr<MappedFile> file = map(path, cache);
+    if(!file)
+        return false;
+
+    const char* position = textOf(*file);
+    const char* end      = position + file->size();
+
+    // Find the "#shader <stage>" markers; each section runs until the next marker.
+    std::vector<std::pair<GLenum, View> > sections;
+    while(position < end)
+    {
+        const char* lineEnd = std::find(position, end, '\n');
+        const char* line    = skipSpaces(position, lineEnd);
+
+        if(startsWith(line, lineEnd, "#shader"))
+        {
+            const char* name    = skipSpaces(line + 7, lineEnd);
+            const char* nameEnd = name;
+            while(nameEnd < lineEnd && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\r')
+                ++nameEnd;
+
+            GLenum type = stageType(name, nameEnd);
+            if(type == GL_NONE)
+            {
+                std::cout << "ERROR::SHADER::UNKNOWN_STAGE " << std::string(name, nameEnd) << " in " << path << std::endl;
+                return false;
+            }
+
+            if(!sections.empty())
+                sections.back().second.length = position - sections.back().second.data;
+
+            View view = { lineEnd < end ? lineEnd + 1 : end, 0 };
+            sections.push_back(std::make_pair(type, view));
+        }
+
+        position = lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    if(sections.empty())
+    {
+        std::cout << "ERROR::SHADER::NO_STAGES_IN " << path << std::endl;
+        return false;
+    }
+    sections.back().second.length = end - sections.back().second.data;
+
+    std::string directory = directoryOf(path);
+    for(std::size_t i = 0; i < sections.size(); ++i)
+    {
+        ShaderStage stage;
+        stage.type = sections[i].first;
+
+        std::vector<const MappedFile*> included(1, file.get());
+        if(!append(stage, sections[i].second, directory, cache, included, 0))
+            return false;
+
+        stageList.push_back(stage);
+    }
+
+    return true;
+}
+
+bool ShaderSource::addStage(GLenum type, const std::string &path, ShaderSourceCache &cache)
+{
+    std::shared_ptr<MappedFile> file = map(path, cache);
+    if(!file)
+        return false;
+
+    ShaderStage stage;
+    stage.type = type;
+
+    View text = { textOf(*file), file->size() };
+    std::vector<const MappedFile*> included(1, file.get());
+    if(!append(stage, text, directoryOf(path), cache, included, 0))
+        return false;
+
+    stageList.push_back(stage);
+    return true;
+}
+
+void ShaderSource::release()
+{
+    stageList.clear();
+    mappings.clear();
+}
+
+// ------------------------------------------------------------------------
+std::shared_ptr<MappedFile> ShaderSource::map(const std::string &path, ShaderSourceCache &cache)
+{
+    std::shared_ptr<MappedFile> file = cache.get(path);
+    if(!file)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return file;
+    }
+
+    if(std::find(mappings.begin(), mappings.end(), file) == mappings.end())
+    {
+        mappings.push_back(file);
+        paths.push_back(path);
+    }
+    return file;
+}
+
+// Adds text to the stage as chunks, expanding #include lines in place.
+// ------------------------------------------------------------------------
+bool ShaderSource::append(ShaderStage &stage, View text, const std::string &directory, ShaderSourceCache &cache,
+                          std::vector<const MappedFile*> &included, int depth)
+{
+    const char* chunk    = text.data;
+    const char* position = text.data;
+    const char* end      = text.data + text.length;
+
+    while(position < end)
+    {
+        const char* lineEnd = std::find(position, end, '\n');
+        const char* line    = skipSpaces(position, lineEnd);
+
+        if(startsWith(line, lineEnd, "#include"))
+        {
+            const char* open  = skipSpaces(line + 8, lineEnd);
+            char        close = *open == '<' ? '>' : '"';
+            const char* name  = open + 1;
+            const char* nameEnd = std::find(name, lineEnd, close);
+
+            if(open == lineEnd || (*open != '"' && *open != '<') || nameEnd == lineEnd)
+            {
+                std::cout << "ERROR::SHADER::MALFORMED_INCLUDE " << std::string(line, lineEnd) << std::endl;
+                return false;
+            }
+
+            if(depth >= MAX_INCLUDE_DEPTH)
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP " << std::string(name, nameEnd) << std::endl;
+                return false;
+            }
+
+            if(position > chunk)
+            {
+                stage.strings.push_back(chunk);
+                stage.lengths.push_back((GLint)(position - chunk));
+            }
+
+            std::string path = directory + std::string(name, nameEnd);
+            std::shared_ptr<MappedFile> file = map(path, cache);
+            if(!file)
+                return false;
+
+            // Every file is included at most once per stage, like #pragma once.
+            if(std::find(included.begin(), included.end(), file.get()) == included.end())
+            {
+                included.push_back(file.get());
+
+                View includedText = { textOf(*file), file->size() };
+                if(!append(stage, includedText, directoryOf(path), cache, included, depth + 1))
+                    return false;
+
+                // Keep the line after the include on a line of its own.
+                if(file->size() > 0 && textOf(*file)[file->size() - 1] != '\n')
+                {
+                    stage.strings.push_back("\n");
+                    stage.lengths.push_back(1);
+                }
+            }
+
+            position = lineEnd < end ? lineEnd + 1 : end;
+            chunk    = position;
+            continue;
+        }
+
+        position = lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    if(end > chunk)
+    {
+        stage.strings.push_back(chunk);
+        stage.lengths.push_back((GLint)(end - chunk));
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------------------
+const char* shaderStageName(GLenum type)
+{
+    switch(type)
+    {
+    case GL_VERTEX_SHADER:          return "VERTEX";
+    case GL_FRAGMENT_SHADER:        return "FRAGMENT";
+    case GL_GEOMETRY_SHADER:        return "GEOMETRY";
+    case GL_TESS_CONTROL_SHADER:    return "TESS_CONTROL";
+    case GL_TESS_EVALUATION_SHADER: return "TESS_EVALUATION";
+    case GL_COMPUTE_SHADER:         return "COMPUTE";
+    default:                        return "UNKNOWN";
+    }
+}
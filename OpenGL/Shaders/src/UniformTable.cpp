@@ -0,0 +1,245 @@
+#include "Shaders/UniformTable.hpp"
+
+#include <cstring>
+
+// Component type and count of a uniform type, used to size its shadow storage.
+// ------------------------------------------------------------------------
+static void uniformComponents(GLenum type, GLenum &component, GLint &components)
+{
+    switch(type)
+    {
+    case GL_FLOAT:             component = GL_FLOAT;        components = 1;  break;
+    case GL_FLOAT_VEC2:        component = GL_FLOAT;        components = 2;  break;
+    case GL_FLOAT_VEC3:        component = GL_FLOAT;        components = 3;  break;
+    case GL_FLOAT_VEC4:        component = GL_FLOAT;        components = 4;  break;
+    case GL_FLOAT_MAT2:        component = GL_FLOAT;        components = 4;  break;
+    case GL_FLOAT_MAT3:        component = GL_FLOAT;        components = 9;  break;
+    case GL_FLOAT_MAT4:        component = GL_FLOAT;        components = 16; break;
+    case GL_FLOAT_MAT2x3:      component = GL_FLOAT;        components = 6;  break;
+    case GL_FLOAT_MAT2x4:      component = GL_FLOAT;        components = 8;  break;
+    case GL_FLOAT_MAT3x2:      component = GL_FLOAT;        components = 6;  break;
+    case GL_FLOAT_MAT3x4:      component = GL_FLOAT;        components = 12; break;
+    case GL_FLOAT_MAT4x2:      component = GL_FLOAT;        components = 8;  break;
+    case GL_FLOAT_MAT4x3:      component = GL_FLOAT;        components = 12; break;
+    case GL_DOUBLE:            component = GL_DOUBLE;       components = 1;  break;
+    case GL_DOUBLE_VEC2:       component = GL_DOUBLE;       components = 2;  break;
+    case GL_DOUBLE_VEC3:       component = GL_DOUBLE;       components = 3;  break;
+    case GL_DOUBLE_VEC4:       component = GL_DOUBLE;       components = 4;  break;
+    case GL_DOUBLE_MAT2:       component = GL_DOUBLE;       components = 4;  break;
+    case GL_DOUBLE_MAT3:       component = GL_DOUBLE;       components = 9;  break;
+    case GL_DOUBLE_MAT4:       component = GL_DOUBLE;       components = 16; break;
+    case GL_DOUBLE_MAT2x3:     component = GL_DOUBLE;       components = 6;  break;
+    case GL_DOUBLE_MAT2x4:     component = GL_DOUBLE;       components = 8;  break;
+    case GL_DOUBLE_MAT3x2:     component = GL_DOUBLE;       components = 6;  break;
+    case GL_DOUBLE_MAT3x4:     component = GL_DOUBLE;       components = 12; break;
+    case GL_DOUBLE_MAT4x2:     component = GL_DOUBLE;       components = 8;  break;
+    case GL_DOUBLE_MAT4x3:     component = GL_DOUBLE;       components = 12; break;
+    case GL_UNSIGNED_INT:      component = GL_UNSIGNED_INT; components = 1;  break;
+    case GL_UNSIGNED_INT_VEC2: component = GL_UNSIGNED_INT; components = 2;  break;
+    case GL_UNSIGNED_INT_VEC3: component = GL_UNSIGNED_INT; components = 3;  break;
+    case GL_UNSIGNED_INT_VEC4: component = GL_UNSIGNED_INT; components = 4;  break;
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2:         component = GL_INT;          components = 2;  break;
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3:         component = GL_INT;          components = 3;  break;
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4:         component = GL_INT;          components = 4;  break;
+    // int, bool, samplers and images are all set through glUniform1i.
+    default:                   component = GL_INT;          components = 1;  break;
+    }
+}
+
+static std::uint32_t uniformElementSize(GLenum type)
+{
+    GLenum component;
+    GLint  components;
+    uniformComponents(type, component, components);
+    return (std::uint32_t)(components * (component == GL_DOUBLE ? sizeof(GLdouble) : sizeof(GLint)));
+}
+
+UniformTable::UniformTable()
+    : mask(0)
+{
+    resetStats();
+}
+
+// Query the driver once for every active uniform and build the lookup table.
+// ------------------------------------------------------------------------
+void UniformTable::build(GLuint program)
+{
+    clear();
+
+    GLint activeUniforms = 0;
+    GLint maxNameLength  = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &activeUniforms);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+    std::uint32_t shadowSize = 0;
+
+    for(GLint i = 0; i < activeUniforms; ++i)
+    {
+        GLsizei length = 0;
+        GLint   size   = 0;
+        GLenum  type   = 0;
+        glGetActiveUniform(program, (GLuint)i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), length);
+        GLint location = glGetUniformLocation(program, name.c_str());
+
+        // Uniforms living in a uniform block have no location.
+        if(location < 0)
+            continue;
+
+        std::uint32_t elementSize = uniformElementSize(type);
+
+        if(size > 1 || (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0))
+        {
+            // Drivers report arrays as "name[0]"; element locations are not guaranteed to be contiguous.
+            std::string base = name.substr(0, name.find('['));
+            add(base, location, type, size, shadowSize, size * elementSize);
+
+            for(GLint element = 0; element < size; ++element)
+            {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                GLint elementLocation = element == 0 ? location : glGetUniformLocation(program, elementName.c_str());
+                if(elementLocation >= 0)
+                    add(elementName, elementLocation, type, size - element, shadowSize + element * elementSize, (size - element) * elementSize);
+            }
+        }
+        else
+        {
+            add(name, location, type, 1, shadowSize, elementSize);
+        }
+
+        shadowSize += size * elementSize;
+    }
+
+    // Seed the shadow with what the program actually holds (zero or the GLSL initializer). glGetUniform reads
+    // one element, so arrays are read through their "name[i]" entries; the bare name shares element 0's slot.
+    shadow.assign(shadowSize, 0);
+    for(std::size_t i = 0; i < uniforms.size(); ++i)
+    {
+        const UniformInfo &info = uniforms[i];
+        if(info.count == 1 || info.name.back() == ']')
+            readBack(program, info);
+    }
+
+    rehash();
+}
+
+void UniformTable::clear()
+{
+    uniforms.clear();
+    slots.clear();
+    shadow.clear();
+    mask = 0;
+}
+
+// ------------------------------------------------------------------------
+UniformHandle UniformTable::find(const std::string &name) const
+{
+    std::uint32_t hash = 2166136261u;
+    for(std::size_t i = 0; i < name.size(); ++i)
+        hash = (hash ^ static_cast<std::uint8_t>(name[i])) * 16777619u;
+
+    return find(name.c_str(), hash);
+}
+
+UniformHandle UniformTable::find(const char* name, std::uint32_t hash) const
+{
+    if(slots.empty())
+        return UniformHandle();
+
+    for(std::uint32_t slot = hash & mask; slots[slot] >= 0; slot = (slot + 1) & mask)
+    {
+        const UniformInfo &info = uniforms[slots[slot]];
+        if(info.hash == hash && std::strcmp(info.name.c_str(), name) == 0)
+            return UniformHandle(slots[slot]);
+    }
+
+    return UniformHandle();
+}
+
+// The shadow assumes uploads go to this program, i.e. it is bound while its setters are called.
+// ------------------------------------------------------------------------
+bool UniformTable::update(UniformHandle handle, const void* value, std::size_t size)
+{
+    if(!handle.isValid())
+        return false;
+
+    const UniformInfo &info = uniforms[handle.index];
+
+    // A size mismatch is a caller error GL will report; don't let it corrupt the shadow.
+    if(size > info.size)
+    {
+        ++uploadStats.uploadsIssued;
+        return true;
+    }
+
+    unsigned char* current = &shadow[info.offset];
+    if(std::memcmp(current, value, size) == 0)
+    {
+        ++uploadStats.uploadsSkipped;
+        return false;
+    }
+
+    std::memcpy(current, value, size);
+    ++uploadStats.uploadsIssued;
+    return true;
+}
+
+void UniformTable::resetStats()
+{
+    uploadStats.uploadsIssued  = 0;
+    uploadStats.uploadsSkipped = 0;
+}
+
+// ------------------------------------------------------------------------
+void UniformTable::add(const std::string &name, GLint location, GLenum type, GLint count, std::uint32_t offset, std::uint32_t size)
+{
+    UniformInfo info;
+    info.name     = name;
+    info.hash     = hashUniformName(name.c_str());
+    info.location = location;
+    info.type     = type;
+    info.count    = count;
+    info.offset   = offset;
+    info.size     = size;
+    uniforms.push_back(info);
+}
+
+void UniformTable::readBack(GLuint program, const UniformInfo &info)
+{
+    GLenum component;
+    GLint  components;
+    uniformComponents(info.type, component, components);
+
+    void* destination = &shadow[info.offset];
+    switch(component)
+    {
+    case GL_FLOAT:        glGetUniformfv (program, info.location, (GLfloat*) destination); break;
+    case GL_DOUBLE:       glGetUniformdv (program, info.location, (GLdouble*)destination); break;
+    case GL_UNSIGNED_INT: glGetUniformuiv(program, info.location, (GLuint*)  destination); break;
+    default:              glGetUniformiv (program, info.location, (GLint*)   destination); break;
+    }
+}
+
+void UniformTable::rehash()
+{
+    // Keep the load factor at or below one half so probe sequences stay short.
+    std::uint32_t capacity = 8;
+    while(capacity < uniforms.size() * 2)
+        capacity <<= 1;
+
+    slots.assign(capacity, -1);
+    mask = capacity - 1;
+
+    for(std::size_t i = 0; i < uniforms.size(); ++i)
+    {
+        std::uint32_t slot = uniforms[i].hash & mask;
+        while(slots[slot] >= 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = (int)i;
+    }
+}
@@ -1,9 +1,30 @@
 #include <GLAD/glad.h>
 #include <GLFW/glfw3.h>
+#include <glm/gtc/matrix_transform.hpp>
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
 
 #include "Shaders/Shader.hpp"
+#include "Shaders/ShaderBatch.hpp"
+#include "Shaders/ShaderRegistry.hpp"
+
+#include "Harness/FrameLoop.hpp"
+#include "Harness/FrameRunner.hpp"
+#include "Harness/GLContext.hpp"
+
+#include "Renderer/DrawQueue.hpp"
+#include "Renderer/GeometryArena.hpp"
+#include "Renderer/GLStateCache.hpp"
+#include "Renderer/Image.hpp"
+#include "Renderer/InstanceBatcher.hpp"
+#include "Renderer/Mesh.hpp"
+#include "Renderer/Profiler.hpp"
+#include "Renderer/RenderTarget.hpp"
+#include "Renderer/UniformBlocks.hpp"
+#include "Renderer/UniformRingBuffer.hpp"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
@@ -13,41 +34,69 @@ void processInput(GLFWwindow *window);
 
 const unsigned int WINDOW_WIDTH = 800;
 const unsigned int WINDOW_HEIGHT = 600;
+const float        SPIN_SPEED    = 0.5f;   // Radians per second of the big triangle.
 
-int main()
+int main(int argc, char** argv)
 {
+    // --headless [--frames N] renders a fixed number of frames offscreen, see RunSettings.
+    // -----------------------------------------------------------------------------------
+    RunSettings run;
+    if(!parseRunSettings(argc, argv, run))
+        return -1;
+
+    ContextSettings contextSettings;
+    contextSettings.width    = WINDOW_WIDTH;
+    contextSettings.height   = WINDOW_HEIGHT;
+    contextSettings.title    = "Shaders";
+    contextSettings.headless = run.headless;
 
-    if(!glfwInit())
+    GLContext context;
+    if(!context.create(contextSettings))
     {
-        std::cout << "Failed to initialize GLFW" << std::endl;
+        std::cout << "Failed to create an OpenGL context" << std::endl;
         return -1;
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-	glfwWindowHint(GLFW_OPENGL_ANY_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if(context.window())
+        glfwSetFramebufferSizeCallback(context.window(), framebuffer_size_callback);
 
+    // Binds and enables go through one state cache, redundant ones never reach the driver.
+    // -------------------------------------------------------------------------------------
+    GLStateCache glState;
+    glState.makeCurrent();
 
-    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Shaders", NULL, NULL);
+    // CPU and GPU time per pass, summarized and written as a Chrome trace on exit.
+    // ----------------------------------------------------------------------------
+    std::unique_ptr<Profiler> profiler(new Profiler());
 
-    if(window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
+    // Lets shader builds run on driver threads when GL_KHR_parallel_shader_compile is exposed.
+    // ----------------------------------------------------------------------------------------
+    loadParallelShaderCompile(context.loader());
 
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    // Linked programs are cached on disk, warm starts skip compile + link entirely.
+    // -----------------------------------------------------------------------------
+    ProgramBinaryCache binaryCache("shader_cache");
 
-    if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
-    }
+    std::chrono::steady_clock::time_point shaderStart = std::chrono::steady_clock::now();
+
+    // Both stages live in one file, split on its "#shader" lines. Saving the file rebuilds the program while running.
+    ShaderRegistry shaders(&binaryCache);
+    ShaderRegistry::Handle ourShader = shaders.load(SHADERS_RES_DIR "shaders/basic.shader");
+    ShaderRegistry::Handle instancedShader = shaders.load(SHADERS_RES_DIR "shaders/instanced.shader");
+    shaders.get(ourShader).isValid();
+    shaders.get(instancedShader).isValid();
 
-    Shader ourShader("D:\\workspace\\LearnGP\\OpenGL\\Shaders\\res\\shaders\\3.3.shader.vs", "D:\\workspace\\LearnGP\\OpenGL\\Shaders\\res\\shaders\\3.3.shader.fs"); // you can name your shader files however you like
+    std::chrono::duration<double, std::milli> shaderTime = std::chrono::steady_clock::now() - shaderStart;
+    std::cout << "Shaders ready in " << shaderTime.count() << " ms (binary cache hits: " << binaryCache.stats().hits << ", misses: " << binaryCache.stats().misses << ", rejected: " << binaryCache.stats().rejected << ")" << std::endl;
     
+    // Per-frame uniform blocks are sub-allocated from one ring buffer instead of set uniform by uniform.
+    // --------------------------------------------------------------------------------------------------
+    std::unique_ptr<UniformRingBuffer> uniformRing(new UniformRingBuffer());
+    std::unique_ptr<DrawQueue> drawQueue(new DrawQueue());
+
+    ShaderRegistry::Handle blockShaders[] = { ourShader, instancedShader };
+    unsigned int boundGenerations[] = { ~0u, ~0u };
+
     // Set up vertex data (and buffer(s)) and configure vertex attributes.
     // -------------------------------------------------------------------
     float vertices[] {
@@ -61,99 +110,229 @@ int main()
 		0, 1 , 2
     };
     
-    unsigned int VAO, VBO, EBO;
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
-    // ----------------------------------------------------------------------------------------------------------------
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// color attribute
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3* sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-    // Note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind.
-    // --------------------------------------------------------------------------------------------------------------------------------------------------------------------
-    glBindBuffer(GL_ARRAY_BUFFER, 0); 
-
-    // Remember: do NOT unbind the EBO while a VAO is active as the bound element buffer object IS stored in the VAO; keep the EBO bound.
-    // ----------------------------------------------------------------------------------------------------------------------------------
-    // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    // -----------------------------------------
-    
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    // ----------------------------------------------------------------------------------------------------------------------------------
-    
-    glBindVertexArray(0); 
+    // The triangle is a range of the shared geometry buffers, drawn through their one VAO.
+    // Half float positions and unorm8 colors make a 12 byte vertex instead of 24.
+    // -------------------------------------------------------------------------------------
+    VertexLayout layout;
+    layout.add(0, VertexFormat::Half4);     // position attribute
+    layout.add(1, VertexFormat::Unorm8x4);  // color attribute
+
+    Mesh triangleData(layout, 3);
+    triangleData.set(0, vertices,     3, 6 * sizeof(float));
+    triangleData.set(1, vertices + 3, 3, 6 * sizeof(float));
+    triangleData.setIndices(indices, 3);
+
+    std::unique_ptr<GeometryArena> geometry(new GeometryArena(glState, layout));
+    MeshRange triangleMesh = triangleData.upload(*geometry);
+
+    // Copies of the triangle drawn with the same program are merged into one instanced draw.
+    // ----------------------------------------------------------------------------------------
+    std::unique_ptr<InstanceBatcher> instances(new InstanceBatcher());
+    instances->attach(glState, geometry->vertexArray());
+    glState.bindVertexArray(0);
 
     // Uncomment this call to draw in wireframe polygons.
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     // ------------------------------------------
 
-    // Render loop.
-    // ------------
-    while(!glfwWindowShouldClose(window))
+    // The big triangle spins: the window loop advances it per update, fixed frame runs per frame
+    // so their images don't depend on timing.
+    // -----------------------------------------------------------------------------------------
+    float previousAngle = 0.0f, currentAngle = 0.0f, spinAngle = 0.0f;
+
+    // One frame, shared by the window loop and fixed frame runs.
+    // -----------------------------------------------------------
+    std::function<void(unsigned int)> renderFrame = [&](unsigned int frame)
     {
-        // Input.
-        // ------
-        processInput(window);
+        (void)frame;
+        profiler->beginFrame();
+        glState.beginFrame();
         // Render.
         // -------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         
-        // Draw triangle.
-        // ------------------------
-        ourShader.use();
-
-        // Seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized.
-        // -------------------------------------------------------------------------------------------------------------------------------
-        // Bind vertex array.
-        // ------------------
-        glBindVertexArray(VAO);
-
-        // Draw elements.
-        // --------------
-        glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, 0);
-
-        // No need to unbind glBindVertexArray(0) every time.
-        // --------------------------------------------------
-
-        // GLFW: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Swap in shaders edited since the last frame.
+        // ---------------------------------------------
+        profiler->beginCpu("Shader reload");
+        shaders.update();
+
+        // A reloaded program starts with default block bindings.
+        // -------------------------------------------------------
+        for(int i = 0; i < 2; ++i)
+        {
+            if(shaders.generation(blockShaders[i]) != boundGenerations[i])
+            {
+                shaders.get(blockShaders[i]).bindUniformBlock("Draws", DRAW_BLOCK_BINDING);
+                boundGenerations[i] = shaders.generation(blockShaders[i]);
+            }
+        }
+        Shader &shader = shaders.get(ourShader);
+        profiler->endCpu();
+
+        // The queue writes every packet's block to the ring when it submits.
+        // --------------------------------------------------------------------
+        profiler->beginCpu("Record");
+        uniformRing->beginFrame();
+
+        DrawBlock block;
+        block.object.model        = glm::rotate(glm::mat4(1.0f), spinAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+        block.object.normalMatrix = block.object.model;
+        block.material.color      = glm::vec4(1.0f);
+        block.material.parameters = glm::vec4(0.0f);
+
+        // Record the triangle, its block is in the Draws array bound when the queue draws it.
+        // -------------------------------------------------------------------------------------
+        if(shader.isValid())
+        {
+            DrawPacket triangle = geometry->packet(triangleMesh);
+            triangle.program    = shader.getID();
+            triangle.block      = block;
+            drawQueue->push(triangle);
+        }
+
+        // A grid of small copies on top, added one by one and drawn as a single instanced draw.
+        // ---------------------------------------------------------------------------------------
+        if(shaders.get(instancedShader).isValid())
+        {
+            DrawPacket copy = geometry->packet(triangleMesh);
+            copy.program    = shaders.get(instancedShader).getID();
+            copy.block      = block;
+            copy.layer      = 1;
+
+            for(int y = 0; y < 8; ++y)
+            {
+                for(int x = 0; x < 8; ++x)
+                {
+                    InstanceData instance;
+                    instance.model = glm::translate(glm::mat4(1.0f), glm::vec3(-0.875f + x * 0.25f, -0.875f + y * 0.25f, 0.0f));
+                    instance.model = glm::scale(instance.model, glm::vec3(0.2f));
+                    instance.color = glm::vec4(x / 7.0f, y / 7.0f, 1.0f, 1.0f);
+                    instances->add(copy, instance);
+                }
+            }
+        }
+        instances->flush(glState, *drawQueue);
+        profiler->endCpu();
+
+        // Sort and draw everything recorded this frame.
+        // ---------------------------------------------
+        {
+            GpuProfileScope scope(*profiler, "Draw queue");
+            drawQueue->submit(glState, uniformRing.get());
+        }
+        drawQueue->clear();
+
+        uniformRing->endFrame();
+        profiler->endFrame();
+    };
+
+    int result = 0;
+    if(run.headless)
+    {
+        // Fixed frame run into an offscreen target, then the last frame is dumped / compared.
+        // -----------------------------------------------------------------------------------
+        std::unique_ptr<RenderTarget> target(new RenderTarget(glState,
+            run.width ? run.width : WINDOW_WIDTH, run.height ? run.height : WINDOW_HEIGHT));
+        target->bind();
+
+        FrameRunner runner(run.frames, run.warmup);
+        FrameTimings timings = runner.run([&](unsigned int frame)
+        {
+            spinAngle = SPIN_SPEED * frame / 60.0f;
+            renderFrame(frame);
+        });
+        std::cout << timings.frames << " frames (" << context.backend() << "): avg " << timings.average << " ms, median "
+                  << timings.median << " ms, p99 " << timings.p99 << " ms, max " << timings.max << " ms" << std::endl;
+        if(!run.reportPath.empty())
+            writeFrameTimings(run.reportPath, timings, context.backend());
+
+        Image lastFrame;
+        target->readPixels(lastFrame);
+        if(!run.dumpPath.empty() && !writeImage(run.dumpPath, lastFrame))
+            result = -1;
+
+        if(!run.comparePath.empty())
+        {
+            Image reference;
+            if(!loadImage(run.comparePath, reference))
+                result = -1;
+            else
+            {
+                ImageDifference difference = compareImages(lastFrame, reference, run.tolerance);
+                std::cout << "Compared against " << run.comparePath << ": " << difference.differingPixels << " pixels differ, max difference "
+                          << difference.maxDifference << ", PSNR " << difference.psnr << " dB" << std::endl;
+                if(!difference.sameSize || difference.differingPixels > 0)
+                    result = 1;
+            }
+        }
+
+        RenderTarget::unbind();
     }
-    
+    else
+    {
+        // Render loop: waits for the GPU, then samples input as late as it can, see FrameLoop.
+        // ------------------------------------------------------------------------------------
+        FrameLoopSettings loopSettings;
+        parsePresentMode(run.presentMode, loopSettings.mode);
+        loopSettings.maxFramesInFlight = run.framesInFlight;
+
+        FrameLoop loop(context, loopSettings);
+        unsigned int frame = 0;
+        loop.onInput([&]() { processInput(context.window()); });
+        loop.onUpdate([&](double seconds)
+        {
+            previousAngle = currentAngle;
+            currentAngle += SPIN_SPEED * (float)seconds;
+        });
+        loop.onRender([&](double alpha)
+        {
+            spinAngle = glm::mix(previousAngle, currentAngle, (float)alpha);
+            renderFrame(frame++);
+        });
+        loop.run();
+
+        FrameLoopStats loopStats = loop.stats();
+        std::cout << "Frame loop (" << presentModeName(loop.mode()) << "): frame avg " << loopStats.frameTimes.average << " ms, p99 "
+                  << loopStats.frameTimes.p99 << " ms; input to present avg " << loopStats.latency.average << " ms, p99 "
+                  << loopStats.latency.p99 << " ms; " << loopStats.throttledFrames << " frames throttled" << std::endl;
+    }
+
+    std::cout << "GL state calls in the last frame: " << glState.lastFrame().issued << " issued, " << glState.lastFrame().filtered << " filtered" << std::endl;
+
+    std::vector<ProfileZoneStats> zones = profiler->stats();
+    for(std::size_t i = 0; i < zones.size(); ++i)
+    {
+        std::cout << zones[i].name << ": CPU avg " << zones[i].cpu.average << " ms, p99 " << zones[i].cpu.p99 << " ms";
+        if(zones[i].gpu.samples)
+            std::cout << "; GPU avg " << zones[i].gpu.average << " ms, p99 " << zones[i].gpu.p99 << " ms";
+        std::cout << std::endl;
+    }
+    profiler->writeChromeTrace("shaders_trace.json");
+
     // Optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-
-    // GLFW: terminate, clearing all previously allocated GLFW resources.
+    geometry.reset();
+    uniformRing.reset();
+    instances.reset();
+    drawQueue.reset();
+    profiler.reset();
+    shaders.clear();
+    GLStateCache::clearCurrent();
+
+    // Terminate, clearing all previously allocated GLFW / EGL resources.
     // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
+    context.destroy();
+    return result;
 }
 
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    if(GLStateCache* state = GLStateCache::current())
+        state->viewport(0, 0, width, height);
+    else
+        glViewport(0, 0, width, height);
 }
 
 void processInput(GLFWwindow *window)
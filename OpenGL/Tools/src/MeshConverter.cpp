@@ -0,0 +1,271 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Renderer/Mesh.hpp"
+#include "Renderer/MeshFile.hpp"
+#include "Renderer/MeshOptimizer.hpp"
+
+// Attribute locations of converted meshes, shared by every shader that draws them.
+// --------------------------------------------------------------------------------
+const GLuint POSITION_LOCATION = 0;
+const GLuint NORMAL_LOCATION   = 1;
+const GLuint UV_LOCATION       = 2;
+
+// One face corner: indices into the OBJ position / uv / normal lists, -1 when absent.
+// -----------------------------------------------------------------------------------
+struct Corner
+{
+    int position;
+    int uv;
+    int normal;
+
+    bool operator==(const Corner &other) const { return position == other.position && uv == other.uv && normal == other.normal; }
+};
+
+struct CornerHash
+{
+    std::size_t operator()(const Corner &corner) const
+    {
+        return (std::size_t)corner.position * 73856093u ^ (std::size_t)corner.uv * 19349663u ^ (std::size_t)corner.normal * 83492791u;
+    }
+};
+
+struct ObjData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<Corner>    corners;   // Three per triangle.
+};
+
+// OBJ indices are 1 based, negative ones count back from the end of the list so far.
+int resolveIndex(long index, std::size_t count)
+{
+    if(index > 0)
+        return (int)(index - 1);
+    if(index < 0)
+        return (int)((long)count + index);
+    return -1;
+}
+
+Corner parseCorner(const char* &cursor, const ObjData &obj)
+{
+    Corner corner = { -1, -1, -1 };
+    char*  end    = nullptr;
+
+    corner.position = resolveIndex(std::strtol(cursor, &end, 10), obj.positions.size());
+    cursor = end;
+    if(*cursor == '/')
+    {
+        ++cursor;
+        if(*cursor != '/')
+        {
+            corner.uv = resolveIndex(std::strtol(cursor, &end, 10), obj.uvs.size());
+            cursor = end;
+        }
+        if(*cursor == '/')
+        {
+            ++cursor;
+            corner.normal = resolveIndex(std::strtol(cursor, &end, 10), obj.normals.size());
+            cursor = end;
+        }
+    }
+    return corner;
+}
+
+bool loadObj(const std::string &path, ObjData &obj)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if(!file)
+    {
+        std::cout << "ERROR::MESH_CONVERTER::OPEN_FAILED " << path << std::endl;
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    std::vector<Corner> polygon;
+    std::size_t lineStart = 0;
+    while(lineStart < text.size())
+    {
+        std::size_t lineEnd = text.find('\n', lineStart);
+        if(lineEnd == std::string::npos)
+            lineEnd = text.size();
+
+        const char* cursor = text.c_str() + lineStart;
+        char*       end    = nullptr;
+
+        if(cursor[0] == 'v' && cursor[1] == ' ')
+        {
+            glm::vec3 p;
+            p.x = std::strtof(cursor + 2, &end);
+            p.y = std::strtof(end, &end);
+            p.z = std::strtof(end, &end);
+            obj.positions.push_back(p);
+        }
+        else if(cursor[0] == 'v' && cursor[1] == 't')
+        {
+            glm::vec2 uv;
+            uv.x = std::strtof(cursor + 2, &end);
+            uv.y = std::strtof(end, &end);
+            obj.uvs.push_back(uv);
+        }
+        else if(cursor[0] == 'v' && cursor[1] == 'n')
+        {
+            glm::vec3 n;
+            n.x = std::strtof(cursor + 2, &end);
+            n.y = std::strtof(end, &end);
+            n.z = std::strtof(end, &end);
+            obj.normals.push_back(n);
+        }
+        else if(cursor[0] == 'f' && cursor[1] == ' ')
+        {
+            // Polygons are triangulated as fans around their first corner.
+            polygon.clear();
+            cursor += 2;
+            const char* lineLimit = text.c_str() + lineEnd;
+            while(cursor < lineLimit)
+            {
+                while(cursor < lineLimit && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+                    ++cursor;
+                if(cursor >= lineLimit)
+                    break;
+
+                Corner corner = parseCorner(cursor, obj);
+                if(corner.position < 0 || corner.position >= (int)obj.positions.size())
+                {
+                    std::cout << "ERROR::MESH_CONVERTER::BAD_FACE " << path << std::endl;
+                    return false;
+                }
+                polygon.push_back(corner);
+
+                while(cursor < lineLimit && *cursor != ' ' && *cursor != '\t')
+                    ++cursor;
+            }
+
+            for(std::size_t i = 2; i < polygon.size(); ++i)
+            {
+                obj.corners.push_back(polygon[0]);
+                obj.corners.push_back(polygon[i - 1]);
+                obj.corners.push_back(polygon[i]);
+            }
+        }
+
+        lineStart = lineEnd + 1;
+    }
+    return true;
+}
+
+// Shared corners become one vertex, encoded straight into 'layout'.
+Mesh buildMesh(const ObjData &obj, const VertexLayout &layout)
+{
+    std::unordered_map<Corner, GLuint, CornerHash> vertices;
+    std::vector<Corner> unique;
+    std::vector<GLuint> indices(obj.corners.size());
+
+    for(std::size_t i = 0; i < obj.corners.size(); ++i)
+    {
+        std::pair<std::unordered_map<Corner, GLuint, CornerHash>::iterator, bool> inserted = vertices.insert(std::make_pair(obj.corners[i], (GLuint)unique.size()));
+        if(inserted.second)
+            unique.push_back(obj.corners[i]);
+        indices[i] = inserted.first->second;
+    }
+
+    Mesh mesh(layout, (GLuint)unique.size());
+    for(GLuint v = 0; v < (GLuint)unique.size(); ++v)
+    {
+        const Corner &corner = unique[v];
+        mesh.set(POSITION_LOCATION, v, obj.positions[corner.position]);
+        if(layout.find(NORMAL_LOCATION))
+        {
+            bool valid = corner.normal >= 0 && corner.normal < (int)obj.normals.size();
+            mesh.set(NORMAL_LOCATION, v, valid ? obj.normals[corner.normal] : glm::vec3(0.0f, 0.0f, 1.0f));
+        }
+        if(layout.find(UV_LOCATION))
+        {
+            bool valid = corner.uv >= 0 && corner.uv < (int)obj.uvs.size();
+            mesh.set(UV_LOCATION, v, valid ? obj.uvs[corner.uv] : glm::vec2(0.0f));
+        }
+    }
+    mesh.setIndices(indices.data(), (GLuint)indices.size());
+    return mesh;
+}
+
+int main(int argc, char* argv[])
+{
+    bool halfPositions = false;
+    bool optimize      = true;
+    std::vector<std::string> paths;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--half-positions") == 0)
+            halfPositions = true;
+        else if(std::strcmp(argv[i], "--no-optimize") == 0)
+            optimize = false;
+        else
+            paths.push_back(argv[i]);
+    }
+
+    if(paths.size() < 2)
+    {
+        std::cout << "Usage: MeshConverter [--half-positions] [--no-optimize] <input.obj> <output.lgpm> [lod1.obj lod2.obj ...]" << std::endl;
+        return -1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> inputs;
+    inputs.push_back(paths[0]);
+    inputs.insert(inputs.end(), paths.begin() + 2, paths.end());
+
+    std::vector<ObjData> objs(inputs.size());
+    for(std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        if(!loadObj(inputs[i], objs[i]))
+            return -1;
+    }
+
+    // The full mesh decides which attributes every LOD carries.
+    // ---------------------------------------------------------
+    VertexLayout layout;
+    layout.add(POSITION_LOCATION, halfPositions ? VertexFormat::Half4 : VertexFormat::Float3);
+    if(!objs[0].normals.empty())
+        layout.add(NORMAL_LOCATION, VertexFormat::Octahedral16);
+    if(!objs[0].uvs.empty())
+        layout.add(UV_LOCATION, VertexFormat::Half2);
+
+    Mesh output(layout);
+    std::vector<MeshFileLod> lods;
+    for(std::size_t i = 0; i < objs.size(); ++i)
+    {
+        Mesh lod = buildMesh(objs[i], layout);
+        if(optimize)
+        {
+            MeshOptimizerReport report = optimizeMesh(lod, POSITION_LOCATION);
+            std::cout << inputs[i] << ": " << report.verticesBefore << " -> " << report.verticesAfter << " vertices, ACMR "
+                      << report.before.acmr << " -> " << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+        }
+
+        MeshFileLod entry = { (std::uint32_t)output.indices().size(), (std::uint32_t)lod.indices().size(), 0.0f, 0 };
+        lods.push_back(entry);
+        output.append(lod);
+    }
+
+    if(!writeMeshFile(paths[1], output, lods))
+        return -1;
+
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    std::cout << paths[1] << ": " << output.indices().size() / 3 << " triangles, " << output.vertexCount() << " vertices of "
+              << layout.stride() << " bytes, " << lods.size() << " LOD(s) in " << time.count() << " ms" << std::endl;
+    return 0;
+}